@@ -0,0 +1,614 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	bench.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Microbenchmark harness for the bench programs
+
+#include "bench.h"
+
+// include glew.h before glfw.h
+#include <GLFW/glfw3.h>
+
+#ifdef BENCH_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <stdexcept>
+#include <thread>
+
+bench_state::bench_state(std::int64_t arg, std::uint64_t iterations, bool gpu_timed)
+    : arg_(arg), iterations_(std::max<std::uint64_t>(iterations, 1))
+{
+    if (gpu_timed) glGenQueries(1, &query_);
+}
+
+bench_state::~bench_state()
+{
+    if (query_) glDeleteQueries(1, &query_);
+}
+
+bool
+bench_state::keep_running()
+{
+    if (skipped_) return false;
+    if (!done_ && !running_) start();
+    if (done_ < iterations_) {
+	done_++;
+	return true;
+    }
+    if (running_) stop();
+    return false;
+}
+
+void
+bench_state::skip(const std::string &reason)
+{
+    skipped_ = true;
+    skip_reason_ = reason;
+}
+
+void
+bench_state::start()
+{
+    // whatever the set up left for the gpu is not ours to time
+    glFinish();
+    running_ = true;
+    if (query_) glBeginQuery(GL_TIME_ELAPSED, query_);
+    cpu_start_ = std::clock();
+    real_start_ = std::chrono::steady_clock::now();
+}
+
+void
+bench_state::stop()
+{
+    if (query_) glEndQuery(GL_TIME_ELAPSED);
+    glFinish();
+    real_seconds_ =
+	std::chrono::duration<double>(std::chrono::steady_clock::now() - real_start_).count();
+    cpu_seconds_ = double(std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+    running_ = false;
+
+    if (query_) {
+	GLuint64 ns = 0;
+	glGetQueryObjectui64v(query_, GL_QUERY_RESULT, &ns);
+	gpu_seconds_ = double(ns) * 1e-9;
+    }
+}
+
+namespace {
+
+// command line options of the bench programs
+struct bench_options {
+    // regular expression the names have to match, empty for all
+    std::string filter;
+    // a run has to take at least this many seconds to count
+    double min_time = 0.5;
+    // runs of each benchmark, more than one adds the mean, median and standard deviation
+    int repetitions = 1;
+    // file for the JSON, empty for stdout
+    std::string out;
+    // print the names and exit
+    bool list = false;
+};
+
+// one run of one benchmark, or an aggregate of its runs, times are per iteration
+struct bench_result {
+    std::string name, run_name, aggregate;
+    int repetition = 0;
+    std::uint64_t iterations = 0;
+    double real_ns = 0.0, cpu_ns = 0.0, gpu_ns = -1.0;
+    double bytes_per_second = 0.0, items_per_second = 0.0;
+    std::map<std::string, double> counters;
+    bool skipped = false, error = false;
+    std::string message;
+};
+
+}  // namespace
+
+static bench_options
+parse_bench_options(int argc, char *argv[])
+{
+    bench_options opts;
+    for (int i = 1; i < argc; i++) {
+	std::string arg = argv[i];
+	if (arg == "--filter" && i + 1 < argc) {
+	    opts.filter = argv[++i];
+	}
+	else if (arg == "--min-time" && i + 1 < argc) {
+	    // seconds
+	    opts.min_time = std::max(std::stod(argv[++i]), 0.0);
+	}
+	else if (arg == "--repetitions" && i + 1 < argc) {
+	    opts.repetitions = std::max(std::stoi(argv[++i]), 1);
+	}
+	else if (arg == "--out" && i + 1 < argc) {
+	    opts.out = argv[++i];
+	}
+	else if (arg == "--list") {
+	    opts.list = true;
+	}
+	else {
+	    throw std::runtime_error("unknown option " + arg + "\nusage: " + argv[0] +
+				     " [--filter <regex>] [--min-time <s>] [--repetitions <n>]"
+				     " [--out <file.json>] [--list]");
+	}
+    }
+    return opts;
+}
+
+// the result of a finished run, per iteration and per second
+static bench_result
+result_of(const bench_state &state, const std::string &name, int repetition)
+{
+    bench_result r;
+    r.name = r.run_name = name;
+    r.repetition = repetition;
+    r.iterations = state.iterations();
+    double n = double(state.iterations());
+    r.real_ns = state.real_seconds() * 1e9 / n;
+    r.cpu_ns = state.cpu_seconds() * 1e9 / n;
+    if (state.gpu_seconds() >= 0.0) r.gpu_ns = state.gpu_seconds() * 1e9 / n;
+    if (state.real_seconds() > 0.0) {
+	r.bytes_per_second = state.bytes_per_iteration() * n / state.real_seconds();
+	r.items_per_second = state.items_per_iteration() * n / state.real_seconds();
+    }
+    r.counters = state.counters();
+    return r;
+}
+
+// mean, median and standard deviation of the runs of a benchmark, value by value
+static void
+add_aggregates(std::vector<bench_result> &results, std::size_t first)
+{
+    std::size_t n = results.size() - first;
+    if (n < 2) return;
+
+    auto aggregate = [&](const char *name, auto statistic) {
+	bench_result a = results[first];
+	a.name = a.run_name + "_" + name;
+	a.aggregate = name;
+	auto apply = [&](auto field) {
+	    std::vector<double> values;
+	    for (std::size_t i = first; i < first + n; i++) values.push_back(field(results[i]));
+	    return statistic(values);
+	};
+	a.real_ns = apply([](const bench_result &r) { return r.real_ns; });
+	a.cpu_ns = apply([](const bench_result &r) { return r.cpu_ns; });
+	if (a.gpu_ns >= 0.0) a.gpu_ns = apply([](const bench_result &r) { return r.gpu_ns; });
+	a.bytes_per_second = apply([](const bench_result &r) { return r.bytes_per_second; });
+	a.items_per_second = apply([](const bench_result &r) { return r.items_per_second; });
+	for (auto &c : a.counters) {
+	    const std::string &key = c.first;
+	    c.second = apply([&key](const bench_result &r) { return r.counters.at(key); });
+	}
+	return a;
+    };
+
+    auto mean = [](std::vector<double> v) {
+	double sum = 0.0;
+	for (double x : v) sum += x;
+	return sum / v.size();
+    };
+    auto median = [](std::vector<double> v) {
+	std::sort(v.begin(), v.end());
+	std::size_t h = v.size() / 2;
+	return v.size() % 2 ? v[h] : 0.5 * (v[h - 1] + v[h]);
+    };
+    auto stddev = [&mean](std::vector<double> v) {
+	double m = mean(v), sum = 0.0;
+	for (double x : v) sum += (x - m) * (x - m);
+	return std::sqrt(sum / (v.size() - 1));
+    };
+
+    results.push_back(aggregate("mean", mean));
+    results.push_back(aggregate("median", median));
+    results.push_back(aggregate("stddev", stddev));
+}
+
+static void
+write_json_string(std::ostream &out, const std::string &s)
+{
+    out << '"';
+    for (char c : s) {
+	if (c == '"' || c == '\\') {
+	    out << '\\' << c;
+	}
+	else if (static_cast<unsigned char>(c) < 0x20) {
+	    char code[8];
+	    std::snprintf(code, sizeof(code), "\\u%04x", c);
+	    out << code;
+	}
+	else {
+	    out << c;
+	}
+    }
+    out << '"';
+}
+
+static std::string
+gl_string(GLenum name)
+{
+    const GLubyte *s = glGetString(name);
+    return s ? reinterpret_cast<const char *>(s) : "";
+}
+
+// the layout of Google Benchmark's --benchmark_format=json, with the context of the gl driver
+static void
+write_json(std::ostream &out, const char *executable, const char *suite,
+	   const bench_options &opts, bool gpu_timed, const std::vector<bench_result> &results)
+{
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+    auto field = [&out](const char *key, const std::string &value) {
+	out << "      ";
+	write_json_string(out, key);
+	out << ": ";
+	write_json_string(out, value);
+    };
+
+    out << std::setprecision(10);
+    out << "{\n  \"context\": {\n";
+    field("date", date);
+    out << ",\n";
+    field("executable", executable);
+    out << ",\n";
+    field("suite", suite);
+    out << ",\n      \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+    field("library_build_type", "release");
+#else
+    field("library_build_type", "debug");
+#endif
+    out << ",\n";
+    field("gl_vendor", gl_string(GL_VENDOR));
+    out << ",\n";
+    field("gl_renderer", gl_string(GL_RENDERER));
+    out << ",\n";
+    field("gl_version", gl_string(GL_VERSION));
+    out << ",\n";
+    field("glsl_version", gl_string(GL_SHADING_LANGUAGE_VERSION));
+    out << ",\n      \"gpu_timer\": " << (gpu_timed ? "true" : "false");
+    out << ",\n      \"min_time\": " << opts.min_time;
+    out << ",\n      \"repetitions\": " << opts.repetitions << "\n  },\n";
+
+    out << "  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results.size(); i++) {
+	const bench_result &r = results[i];
+	out << (i ? ",\n" : "\n") << "    {\n";
+	field("name", r.name);
+	out << ",\n";
+	field("run_name", r.run_name);
+	out << ",\n";
+	field("run_type", r.aggregate.empty() ? "iteration" : "aggregate");
+	if (!r.aggregate.empty()) {
+	    out << ",\n";
+	    field("aggregate_name", r.aggregate);
+	}
+	out << ",\n      \"repetitions\": " << opts.repetitions;
+	out << ",\n      \"repetition_index\": " << r.repetition;
+	if (r.skipped || r.error) {
+	    out << ",\n      \"" << (r.skipped ? "skipped" : "error_occurred") << "\": true,\n";
+	    field(r.skipped ? "skip_message" : "error_message", r.message);
+	    out << "\n    }";
+	    continue;
+	}
+	out << ",\n      \"iterations\": " << r.iterations;
+	out << ",\n      \"real_time\": " << r.real_ns;
+	out << ",\n      \"cpu_time\": " << r.cpu_ns;
+	if (r.gpu_ns >= 0.0) out << ",\n      \"gpu_time\": " << r.gpu_ns;
+	out << ",\n      \"time_unit\": \"ns\"";
+	if (r.bytes_per_second > 0.0)
+	    out << ",\n      \"bytes_per_second\": " << r.bytes_per_second;
+	if (r.items_per_second > 0.0)
+	    out << ",\n      \"items_per_second\": " << r.items_per_second;
+	for (const auto &c : r.counters) {
+	    out << ",\n      ";
+	    write_json_string(out, c.first);
+	    out << ": " << c.second;
+	}
+	out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// drain the errors a benchmark left, they mean its numbers are worthless
+static GLenum
+take_glerror()
+{
+    GLenum first = glGetError(), e = first;
+    while (e != GL_NO_ERROR) e = glGetError();
+    return first;
+}
+
+// run a benchmark once, growing its iterations until the run takes at least min_time, like
+// Google Benchmark aiming 40% past it and growing at most tenfold, then repetitions - 1 more
+// times with that count
+static void
+run_case(const bench_case &c, std::int64_t arg, const std::string &name,
+	 const bench_options &opts, bool gpu_timed, std::vector<bench_result> &results)
+{
+    const std::uint64_t max_iterations = 1000000000;
+    std::size_t first = results.size();
+    std::uint64_t n = 1;
+    for (int rep = 0; rep < opts.repetitions; rep++) {
+	bench_result r;
+	for (;;) {
+	    bench_state state(arg, n, gpu_timed);
+	    try {
+		c.run(state);
+	    }
+	    catch (std::exception &ex) {
+		take_glerror();
+		r.name = r.run_name = name;
+		r.error = true;
+		r.message = ex.what();
+		break;
+	    }
+	    if (GLenum e = take_glerror()) {
+		char code[32];
+		std::snprintf(code, sizeof(code), "gl error 0x%04x", e);
+		r.name = r.run_name = name;
+		r.error = true;
+		r.message = code;
+		break;
+	    }
+	    if (state.skipped()) {
+		r.name = r.run_name = name;
+		r.skipped = true;
+		r.message = state.skip_reason();
+		break;
+	    }
+	    if (!state.finished())
+		throw std::runtime_error("benchmark " + name + " did not run its loop");
+	    if (rep || state.real_seconds() >= opts.min_time || n >= max_iterations) {
+		r = result_of(state, name, rep);
+		break;
+	    }
+	    double grow = state.real_seconds() > 0.0
+			      ? opts.min_time * 1.4 / state.real_seconds()
+			      : 10.0;
+	    n = std::min(std::max(std::uint64_t(double(n) * std::min(grow, 10.0)), n + 1),
+			 max_iterations);
+	}
+
+	r.repetition = rep;
+	results.push_back(r);
+	if (r.skipped || r.error) {
+	    std::cerr << std::left << std::setw(40) << name << " "
+		      << (r.skipped ? "skipped: " : "error: ") << r.message << std::endl;
+	    return;
+	}
+	std::cerr << std::left << std::setw(40) << name << std::right << std::setw(12)
+		  << r.iterations << std::setw(14) << std::fixed << std::setprecision(1)
+		  << r.real_ns << " ns" << std::setw(14) << r.cpu_ns << " ns cpu";
+	if (r.gpu_ns >= 0.0) std::cerr << std::setw(14) << r.gpu_ns << " ns gpu";
+	std::cerr << std::defaultfloat << std::endl;
+    }
+    add_aggregates(results, first);
+}
+
+// The context of the benchmarks, they draw into a framebuffer of their own and never show
+// anything. Built with EGL it is a surfaceless context, on the first EGL device or mesa's
+// surfaceless platform, which needs no window system, so the benchmarks run on headless
+// machines as they are. Without EGL, or if it has no such context, it is a hidden glfw window,
+// which still needs a display connection (use Xvfb on machines without one). Whichever it is
+// goes when the object does, on the way out of an exception too.
+class bench_context {
+   public:
+    explicit bench_context(const char *title)
+    {
+	if (make_egl_context()) return;
+
+	if (!glfwInit()) throw std::runtime_error("Failed to initialize glfw.");
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	win_ = glfwCreateWindow(64, 64, title, nullptr, nullptr);
+	if (!win_) {
+	    glfwTerminate();
+	    throw std::runtime_error("Failed to create glfw window.");
+	}
+	glfwMakeContextCurrent(win_);
+    }
+
+    ~bench_context()
+    {
+	if (win_) {
+	    glfwDestroyWindow(win_);
+	    glfwTerminate();
+	}
+#ifdef BENCH_EGL
+	if (display_ != EGL_NO_DISPLAY) {
+	    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	    if (context_ != EGL_NO_CONTEXT) eglDestroyContext(display_, context_);
+	    eglTerminate(display_);
+	}
+#endif
+    }
+
+    bench_context(const bench_context &) = delete;
+    bench_context &operator=(const bench_context &) = delete;
+
+    // whether the context has no window, and no display behind it
+    bool headless() const { return !win_; }
+
+    // vsync off, a window's swaps would otherwise wait for the display
+    void
+    no_vsync() const
+    {
+	if (win_) glfwSwapInterval(0);
+    }
+
+   private:
+    // a 3.2 core context without a surface, false if EGL has none to give
+    bool
+    make_egl_context()
+    {
+#ifdef BENCH_EGL
+	const char *client = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	auto has = [](const char *extensions, const char *name) {
+	    return extensions && std::strstr(extensions, name);
+	};
+	auto platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+	    eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	auto query_devices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(
+	    eglGetProcAddress("eglQueryDevicesEXT"));
+
+	// the first gpu, as the drivers of headless servers expose it, or mesa's surfaceless
+	// platform, or the default display, which may need a window system after all
+	EGLDeviceEXT device = nullptr;
+	EGLint devices = 0;
+	if (platform_display && query_devices && has(client, "EGL_EXT_platform_device") &&
+	    query_devices(1, &device, &devices) && devices > 0)
+	    display_ = platform_display(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+	if (display_ == EGL_NO_DISPLAY && platform_display &&
+	    has(client, "EGL_MESA_platform_surfaceless"))
+	    display_ = platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+					nullptr);
+	if (display_ == EGL_NO_DISPLAY) display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (display_ == EGL_NO_DISPLAY) return false;
+	if (!eglInitialize(display_, nullptr, nullptr)) {
+	    display_ = EGL_NO_DISPLAY;
+	    return false;
+	}
+
+	const EGLint config_attribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_SURFACE_TYPE,
+					 EGL_DONT_CARE, EGL_NONE};
+	const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+					  3,
+					  EGL_CONTEXT_MINOR_VERSION,
+					  2,
+					  EGL_CONTEXT_OPENGL_PROFILE_MASK,
+					  EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+					  EGL_NONE};
+	EGLConfig config = nullptr;
+	EGLint configs = 0;
+	if (has(eglQueryString(display_, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context") &&
+	    eglBindAPI(EGL_OPENGL_API) &&
+	    eglChooseConfig(display_, config_attribs, &config, 1, &configs) && configs > 0)
+	    context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT, context_attribs);
+	if (context_ == EGL_NO_CONTEXT ||
+	    !eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context_)) {
+	    if (context_ != EGL_NO_CONTEXT) eglDestroyContext(display_, context_);
+	    context_ = EGL_NO_CONTEXT;
+	    eglTerminate(display_);
+	    display_ = EGL_NO_DISPLAY;
+	    return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+    }
+
+#ifdef BENCH_EGL
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLContext context_ = EGL_NO_CONTEXT;
+#endif
+    GLFWwindow *win_ = nullptr;
+};
+
+int
+run_benchmarks(int argc, char *argv[], const char *suite, const std::vector<bench_case> &cases)
+{
+    try {
+	const bench_options opts = parse_bench_options(argc, argv);
+	const std::regex filter(opts.filter);
+
+	// the runs by name, in the order given
+	std::vector<std::pair<const bench_case *, std::int64_t>> runs;
+	std::vector<std::string> names;
+	for (const bench_case &c : cases) {
+	    std::vector<std::int64_t> args = c.args;
+	    if (args.empty()) args.push_back(0);
+	    for (std::int64_t arg : args) {
+		std::string name = c.args.empty() ? c.name : c.name + "/" + std::to_string(arg);
+		if (!std::regex_search(name, filter)) continue;
+		runs.push_back({&c, arg});
+		names.push_back(name);
+	    }
+	}
+	if (opts.list) {
+	    for (const std::string &name : names) std::cout << name << std::endl;
+	    return 0;
+	}
+
+	// A headless context where there is one, a hidden window otherwise, with vsync off,
+	// and a framebuffer of our own to draw into.
+	bench_context context(suite);
+	glewExperimental = GL_TRUE;
+	GLenum glew = glewInit();
+	// a glew built for glx finds no glx display under EGL, the gl functions are loaded by
+	// then
+	bool no_glx = false;
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	no_glx = context.headless() && glew == GLEW_ERROR_NO_GLX_DISPLAY;
+#endif
+	if (glew != GLEW_OK && !no_glx) throw std::runtime_error("Failed to initialize glew.");
+	context.no_vsync();
+	// glew leaves an invalid enum behind on core profiles
+	take_glerror();
+
+	const bool gpu_timed = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+	std::cerr << "Context: " << (context.headless() ? "headless egl" : "hidden window")
+		  << std::endl;
+	std::cerr << "Renderer: " << gl_string(GL_RENDERER) << std::endl;
+	std::cerr << "OpenGL version supported " << gl_string(GL_VERSION) << std::endl;
+
+	GLuint fbo = 0, targets[2] = {};
+	glGenFramebuffers(1, &fbo);
+	glGenRenderbuffers(2, targets);
+	glBindRenderbuffer(GL_RENDERBUFFER, targets[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, bench_target_size, bench_target_size);
+	glBindRenderbuffer(GL_RENDERBUFFER, targets[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, bench_target_size,
+			      bench_target_size);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+				  targets[0]);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+				  targets[1]);
+
+	std::vector<bench_result> results;
+	bool failed = false;
+	for (std::size_t i = 0; i < runs.size(); i++) {
+	    // every benchmark starts from the same state
+	    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	    glViewport(0, 0, bench_target_size, bench_target_size);
+	    run_case(*runs[i].first, runs[i].second, names[i], opts, gpu_timed, results);
+	    failed = failed || results.back().error;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteRenderbuffers(2, targets);
+
+	if (opts.out.empty()) {
+	    write_json(std::cout, argv[0], suite, opts, gpu_timed, results);
+	}
+	else {
+	    std::ofstream out(opts.out);
+	    if (!out) throw std::runtime_error("cannot write " + opts.out);
+	    write_json(out, argv[0], suite, opts, gpu_timed, results);
+	}
+	return failed ? 1 : 0;
+    }
+    catch (std::exception &ex) {
+	std::cerr << ex.what() << std::endl;
+	return 1;
+    }
+}
@@ -0,0 +1,108 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// bench.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Microbenchmark harness for the bench programs : a hidden context, timed loops that grow until
+// they run long enough, and the results as JSON
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// The shape follows Google Benchmark, so its tools can read the output : a benchmark sets up,
+// runs its loop while keep_running() says so, and cleans up. The harness first runs the loop
+// once, then again with more and more iterations until it takes at least the minimum time,
+// and reports the last run. The gpu works behind the cpu, so the clock stops only after a
+// glFinish() at the end of the loop, and the gpu time of the loop comes from a
+// GL_TIME_ELAPSED query around it, when the context has timer queries.
+
+class bench_state {
+   public:
+    bench_state(std::int64_t arg, std::uint64_t iterations, bool gpu_timed);
+    ~bench_state();
+
+    bench_state(const bench_state &) = delete;
+    bench_state &operator=(const bench_state &) = delete;
+
+    // true until the loop has run its iterations, starts the clocks on the first call and
+    // stops them, after a glFinish(), on the last
+    bool keep_running();
+
+    // the argument of this run, 0 for benchmarks without one
+    std::int64_t arg() const { return arg_; }
+    std::uint64_t iterations() const { return iterations_; }
+
+    // per iteration, reported per second
+    void set_bytes_per_iteration(double bytes) { bytes_ = bytes; }
+    void set_items_per_iteration(double items) { items_ = items; }
+
+    // any other number worth keeping, reported as it is
+    void counter(const std::string &name, double value) { counters_[name] = value; }
+
+    // the context cannot run this benchmark, call before the loop, which then does not run
+    void skip(const std::string &reason);
+
+    bool skipped() const { return skipped_; }
+    const std::string &skip_reason() const { return skip_reason_; }
+    bool finished() const { return done_ == iterations_ && !running_; }
+
+    // of the whole loop, in seconds
+    double real_seconds() const { return real_seconds_; }
+    double cpu_seconds() const { return cpu_seconds_; }
+    // negative without timer queries
+    double gpu_seconds() const { return gpu_seconds_; }
+
+    double bytes_per_iteration() const { return bytes_; }
+    double items_per_iteration() const { return items_; }
+    const std::map<std::string, double> &counters() const { return counters_; }
+
+   private:
+    void start();
+    void stop();
+
+    std::int64_t arg_;
+    std::uint64_t iterations_, done_ = 0;
+    bool running_ = false, skipped_ = false;
+    std::string skip_reason_;
+
+    GLuint query_ = 0;
+    std::chrono::steady_clock::time_point real_start_;
+    std::clock_t cpu_start_ = 0;
+    double real_seconds_ = 0.0, cpu_seconds_ = 0.0, gpu_seconds_ = -1.0;
+
+    double bytes_ = 0.0, items_ = 0.0;
+    std::map<std::string, double> counters_;
+};
+
+// a benchmark, run once per argument, or once with 0 if it has none
+struct bench_case {
+    std::string name;
+    std::function<void(bench_state &)> run;
+    std::vector<std::int64_t> args = {};
+};
+
+// the benchmarks draw into a framebuffer of this size, colour and depth, bound before each, the
+// context may have no window, and a hidden one may have no pixels of its own
+constexpr int bench_target_size = 256;
+
+// Parse the options, make a 3.2 core (or later) context, run the benchmarks whose name
+// matches the filter, and write the JSON to stdout or --out, progress goes to stderr. Built
+// with EGL the context is headless, surfaceless on the first EGL device, else on mesa's
+// surfaceless platform, else on the default display, and only without any of those is it a
+// hidden glfw window, which needs a display connection. Returns the exit code of the program,
+// 1 if anything failed.
+//
+// options : --filter <regex> --min-time <s> --repetitions <n> --out <file.json> --list
+int run_benchmarks(int argc, char *argv[], const char *suite,
+		   const std::vector<bench_case> &cases);
+
+#endif	// BENCH_H
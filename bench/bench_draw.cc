@@ -0,0 +1,374 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	bench_draw.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Benchmarks of the draw call overhead : a call per object, instancing, multi-draw, and the
+//	triangle rate of the generated scenes
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "bench.h"
+#include "buffer_heap.h"
+#include "opengl_stuff.h"
+#include "procedural_scene.h"
+
+// objects drawn in each iteration
+static const std::vector<std::int64_t> object_counts = {100, 1000, 10000};
+
+// the offset comes from the uniform, from an attribute per instance, or is already in the
+// position, the unused one stays 0, the colour comes from the generated scenes only
+static const char *draw_vertex_src =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 vPos;\n"
+    "layout (location = 1) in vec4 vCol;\n"
+    "layout (location = 2) in vec2 vOffset;\n"
+    "uniform vec2 offset;\n"
+    "out vec4 fCol;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(vPos.xy + vOffset + offset, vPos.z, 1.0);\n"
+    "   fCol = vCol;\n"
+    "}\n";
+
+static const char *draw_fragment_src =
+    "#version 330 core\n"
+    "in vec4 fCol;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = fCol;\n"
+    "}\n";
+
+// A grid of objects, each a triangle of about a pixel so that the draw calls cost and the
+// pixels do not. The triangle is in a buffer once, with the offsets of the objects in another
+// for instancing, and in a third once per object at its offset for multi-draw.
+class object_grid {
+   public:
+    explicit object_grid(std::size_t objects) : objects_(objects)
+    {
+	program_ = build_program(draw_vertex_src, draw_fragment_src, "draw");
+	offset_loc_ = glGetUniformLocation(program_, "offset");
+
+	const float size = 2.0f / bench_target_size;
+	const float shape[9] = {0.0f, 0.0f, 0.0f, size, 0.0f, 0.0f, 0.0f, size, 0.0f};
+	std::size_t columns = 1;
+	while (columns * columns < objects) columns++;
+	for (std::size_t i = 0; i < objects; i++) {
+	    float x = -1.0f + 2.0f * (i % columns) / columns;
+	    float y = -1.0f + 2.0f * (i / columns) / columns;
+	    offsets_.insert(offsets_.end(), {x, y});
+	    for (int v = 0; v < 3; v++)
+		placed_.insert(placed_.end(), {shape[3 * v] + x, shape[3 * v + 1] + y, 0.0f});
+	}
+
+	glGenVertexArrays(2, vaos_);
+	glGenBuffers(3, buffers_);
+
+	// the triangle, and its offsets per instance
+	glBindVertexArray(vaos_[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers_[0]);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(shape), shape, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers_[1]);
+	glBufferData(GL_ARRAY_BUFFER, offsets_.size() * sizeof(GLfloat), offsets_.data(),
+		     GL_STATIC_DRAW);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+	glVertexAttribDivisor(2, 1);
+
+	// the triangles at their offsets
+	glBindVertexArray(vaos_[1]);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers_[2]);
+	glBufferData(GL_ARRAY_BUFFER, placed_.size() * sizeof(GLfloat), placed_.data(),
+		     GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glUseProgram(program_);
+    }
+    ~object_grid()
+    {
+	glUseProgram(0);
+	glBindVertexArray(0);
+	glDeleteVertexArrays(2, vaos_);
+	glDeleteBuffers(3, buffers_);
+	glDeleteProgram(program_);
+    }
+
+    object_grid(const object_grid &) = delete;
+    object_grid &operator=(const object_grid &) = delete;
+
+    std::size_t objects() const { return objects_; }
+    const std::vector<float> &offsets() const { return offsets_; }
+    GLint offset_location() const { return offset_loc_; }
+
+    // the triangle alone, with the offsets per instance if they are enabled
+    void bind_shape(bool instanced) const
+    {
+	glBindVertexArray(vaos_[0]);
+	if (instanced)
+	    glEnableVertexAttribArray(2);
+	else
+	    glDisableVertexAttribArray(2);
+    }
+    void bind_placed() const { glBindVertexArray(vaos_[1]); }
+
+   private:
+    std::size_t objects_;
+    std::vector<float> offsets_, placed_;
+    GLuint program_ = 0, vaos_[2] = {}, buffers_[3] = {};
+    GLint offset_loc_ = -1;
+};
+
+// a uniform and a draw call per object, the way the grid of final draws without the atlas
+static void
+bench_per_object(bench_state &state)
+{
+    object_grid grid(std::size_t(state.arg()));
+    grid.bind_shape(false);
+    const std::vector<float> &offsets = grid.offsets();
+    while (state.keep_running()) {
+	for (std::size_t i = 0; i < grid.objects(); i++) {
+	    glUniform2f(grid.offset_location(), offsets[2 * i], offsets[2 * i + 1]);
+	    glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+    }
+    state.set_items_per_iteration(double(grid.objects()));
+}
+
+// a draw call per object from the placed triangles, the cost of the call without the uniform
+static void
+bench_per_object_placed(bench_state &state)
+{
+    object_grid grid(std::size_t(state.arg()));
+    grid.bind_placed();
+    while (state.keep_running()) {
+	for (std::size_t i = 0; i < grid.objects(); i++) glDrawArrays(GL_TRIANGLES, GLint(3 * i), 3);
+    }
+    state.set_items_per_iteration(double(grid.objects()));
+}
+
+// one call for all, the offsets per instance
+static void
+bench_instanced(bench_state &state)
+{
+    object_grid grid(std::size_t(state.arg()));
+    grid.bind_shape(true);
+    while (state.keep_running())
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 3, GLsizei(grid.objects()));
+    state.set_items_per_iteration(double(grid.objects()));
+}
+
+// one call for all, a range of the placed triangles per object
+static void
+bench_multi_draw(bench_state &state)
+{
+    object_grid grid(std::size_t(state.arg()));
+    grid.bind_placed();
+    std::vector<GLint> firsts(grid.objects());
+    std::vector<GLsizei> counts(grid.objects(), 3);
+    for (std::size_t i = 0; i < grid.objects(); i++) firsts[i] = GLint(3 * i);
+    while (state.keep_running())
+	glMultiDrawArrays(GL_TRIANGLES, firsts.data(), counts.data(), GLsizei(grid.objects()));
+    state.set_items_per_iteration(double(grid.objects()));
+}
+
+// one call for all, the ranges in a buffer on the gpu
+static void
+bench_multi_draw_indirect(bench_state &state)
+{
+    if (!(GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect)) {
+	state.skip("needs 4.3 or ARB_multi_draw_indirect");
+	return;
+    }
+
+    object_grid grid(std::size_t(state.arg()));
+    grid.bind_placed();
+    // count, instances, first, base instance
+    std::vector<GLuint> commands;
+    for (std::size_t i = 0; i < grid.objects(); i++)
+	commands.insert(commands.end(), {3, 1, GLuint(3 * i), 0});
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(GLuint), commands.data(),
+		 GL_STATIC_DRAW);
+    while (state.keep_running())
+	glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, GLsizei(grid.objects()), 0);
+    state.set_items_per_iteration(double(grid.objects()));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+}
+
+// Meshes all different, each a polygon of 3 to 10 sides fanned around its centre at its place
+// in the grid, in buffers of their own or in ranges of a buffer heap, the vertices and then
+// the indices of a mesh together. Either way a mesh is a draw call, what differs is the
+// vertex array bound for it.
+class mesh_set {
+   public:
+    mesh_set(std::size_t meshes, bool heaped)
+    {
+	program_ = build_program(draw_vertex_src, draw_fragment_src, "draw");
+	glUseProgram(program_);
+	const float radius = 1.0f / bench_target_size;
+	std::size_t columns = 1;
+	while (columns * columns < meshes) columns++;
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	for (std::size_t i = 0; i < meshes; i++) {
+	    float x = -1.0f + 2.0f * (i % columns) / columns;
+	    float y = -1.0f + 2.0f * (i / columns) / columns;
+	    GLuint sides = GLuint(3 + i % 8);
+	    vertices.assign({x, y, 0.0f});
+	    indices.clear();
+	    for (GLuint s = 0; s < sides; s++) {
+		float a = 6.2831853f * s / sides;
+		vertices.insert(vertices.end(),
+				{x + radius * std::cos(a), y + radius * std::sin(a), 0.0f});
+		indices.insert(indices.end(), {0, 1 + s, 1 + (s + 1) % sides});
+	    }
+	    std::size_t vertex_bytes = vertices.size() * sizeof(GLfloat);
+	    std::size_t index_bytes = indices.size() * sizeof(GLuint);
+	    counts_.push_back(GLsizei(indices.size()));
+
+	    if (heaped) {
+		buffer_heap::handle h = heap_.allocate(vertex_bytes + index_bytes, stride);
+		heap_.upload(h, vertices.data(), vertex_bytes);
+		heap_.upload(h, indices.data(), index_bytes, vertex_bytes);
+		ranges_.push_back(h);
+		vertex_bytes_.push_back(vertex_bytes);
+		continue;
+	    }
+	    GLuint buffers[2] = {};
+	    glGenBuffers(2, buffers);
+	    vaos_.push_back(vertex_array(buffers[0], buffers[1]));
+	    glBufferData(GL_ARRAY_BUFFER, vertex_bytes, vertices.data(), GL_STATIC_DRAW);
+	    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_bytes, indices.data(), GL_STATIC_DRAW);
+	    buffers_.insert(buffers_.end(), {buffers[0], buffers[1]});
+	}
+
+	// a vertex array per block of the heap
+	for (std::size_t b = 0; heaped && b < heap_.blocks(); b++)
+	    vaos_.push_back(vertex_array(heap_.block_buffer(b), heap_.block_buffer(b)));
+	glBindVertexArray(0);
+    }
+    ~mesh_set()
+    {
+	glUseProgram(0);
+	glBindVertexArray(0);
+	glDeleteVertexArrays(GLsizei(vaos_.size()), vaos_.data());
+	glDeleteBuffers(GLsizei(buffers_.size()), buffers_.data());
+	glDeleteProgram(program_);
+    }
+
+    mesh_set(const mesh_set &) = delete;
+    mesh_set &operator=(const mesh_set &) = delete;
+
+    // all the meshes, a bind and a draw call each from buffers of their own, from the heap a
+    // bind only when the block changes
+    void draw() const
+    {
+	if (ranges_.empty()) {
+	    for (std::size_t i = 0; i < counts_.size(); i++) {
+		glBindVertexArray(vaos_[i]);
+		glDrawElements(GL_TRIANGLES, counts_[i], GL_UNSIGNED_INT, nullptr);
+	    }
+	    return;
+	}
+	std::size_t bound = std::size_t(-1);
+	for (std::size_t i = 0; i < counts_.size(); i++) {
+	    buffer_heap::handle h = ranges_[i];
+	    if (heap_.block(h) != bound) {
+		bound = heap_.block(h);
+		glBindVertexArray(vaos_[bound]);
+	    }
+	    glDrawElementsBaseVertex(GL_TRIANGLES, counts_[i], GL_UNSIGNED_INT,
+				     (void *)(heap_.offset(h) + vertex_bytes_[i]),
+				     GLint(heap_.offset(h) / stride));
+	}
+    }
+
+    std::size_t meshes() const { return counts_.size(); }
+    std::size_t buffer_objects() const
+    {
+	return ranges_.empty() ? buffers_.size() : heap_.blocks();
+    }
+
+   private:
+    static constexpr std::size_t stride = 3 * sizeof(GLfloat);
+
+    // left bound, with the buffers bound to GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER
+    static GLuint
+    vertex_array(GLuint vertices, GLuint indices)
+    {
+	GLuint vao = 0;
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vertices);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices);
+	return vao;
+    }
+
+    GLuint program_ = 0;
+    std::vector<GLuint> vaos_, buffers_;
+    std::vector<GLsizei> counts_;
+    buffer_heap heap_;
+    std::vector<buffer_heap::handle> ranges_;
+    std::vector<std::size_t> vertex_bytes_;
+};
+
+static void
+bench_meshes(bench_state &state, bool heaped)
+{
+    mesh_set meshes(std::size_t(state.arg()), heaped);
+    while (state.keep_running()) meshes.draw();
+    state.set_items_per_iteration(double(meshes.meshes()));
+    state.counter("buffer_objects", double(meshes.buffer_objects()));
+}
+
+// a generated scene in one call, items are triangles, so this is the triangle rate
+static void
+bench_scene(bench_state &state, scene_kind kind)
+{
+    scene_params params;
+    params.kind = kind;
+    params.triangles = std::uint64_t(state.arg());
+    procedural_scene scene(params);
+    GLuint program = build_program(draw_vertex_src, draw_fragment_src, "draw");
+    glUseProgram(program);
+    glEnable(GL_DEPTH_TEST);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    while (state.keep_running()) scene.draw();
+    glDisable(GL_DEPTH_TEST);
+    state.set_items_per_iteration(double(scene.triangles()));
+    state.counter("generate_ms", scene.generate_ms());
+    glUseProgram(0);
+    glDeleteProgram(program);
+}
+
+int
+main(int argc, char *argv[])
+{
+    std::vector<bench_case> cases = {
+	{"per_object", bench_per_object, object_counts},
+	{"per_object_placed", bench_per_object_placed, object_counts},
+	{"instanced", bench_instanced, object_counts},
+	{"multi_draw", bench_multi_draw, object_counts},
+	{"multi_draw_indirect", bench_multi_draw_indirect, object_counts},
+	{"mesh_buffers", [](bench_state &state) { bench_meshes(state, false); }, object_counts},
+	{"mesh_heap", [](bench_state &state) { bench_meshes(state, true); }, object_counts}};
+    for (int i = 0; i < num_scene_kinds; i++) {
+	scene_kind kind = scene_kind(i);
+	cases.push_back({std::string("scene_") + scene_kind_name(kind),
+			 [kind](bench_state &state) { bench_scene(state, kind); },
+			 {1000000}});
+    }
+    return run_benchmarks(argc, argv, "draw", cases);
+}
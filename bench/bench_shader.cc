@@ -0,0 +1,130 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	bench_shader.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Benchmarks of shader compile and link times, and of loading program binaries
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "opengl_stuff.h"
+
+// statements in the body of the shaders
+static const std::vector<std::int64_t> statement_counts = {1, 64, 512};
+
+// The sources have a salt that changes every iteration, drivers keep caches of compiled
+// shaders keyed by their source, and we want to time the compiler rather than the cache. The
+// salt is 10 digits written in place, so making a new source costs next to nothing.
+class salted_source {
+   public:
+    salted_source(GLenum type, std::int64_t statements)
+    {
+	bool vertex = type == GL_VERTEX_SHADER;
+	src_ = "#version 330 core\n";
+	src_ += vertex ? "layout (location = 0) in vec3 vPos;\nout float v;\n"
+		       : "in float v;\nout vec4 FragColor;\n";
+	src_ += "const float salt = ";
+	salt_at_ = src_.size();
+	src_ += "0000000000.0;\nvoid main()\n{\n";
+	src_ += vertex ? "   float x = vPos.x + salt;\n" : "   float x = v + salt;\n";
+	for (std::int64_t i = 0; i < statements; i++) {
+	    src_ += "   x = fract(sin(x * 1.37 + " + std::to_string(i) + ".0) * 43758.5453);\n";
+	}
+	src_ += vertex ? "   v = x;\n   gl_Position = vec4(vPos, 1.0);\n}\n"
+		       : "   FragColor = vec4(x, x, x, 1.0);\n}\n";
+    }
+
+    // the source with the next salt
+    const char *next()
+    {
+	char digits[11];
+	std::snprintf(digits, sizeof(digits), "%010llu", salt_++ % 10000000000ull);
+	src_.replace(salt_at_, 10, digits);
+	return src_.c_str();
+    }
+
+   private:
+    std::string src_;
+    std::size_t salt_at_;
+    unsigned long long salt_ = 0;
+};
+
+// A vertex shader compiled, the status asked for so that a driver compiling on a thread of its
+// own has to finish. Some drivers only parse here and compile at link time.
+static void
+bench_compile_vertex(bench_state &state)
+{
+    salted_source src(GL_VERTEX_SHADER, state.arg());
+    while (state.keep_running()) glDeleteShader(compile_shader(GL_VERTEX_SHADER, src.next()));
+}
+
+static void
+bench_compile_fragment(bench_state &state)
+{
+    salted_source src(GL_FRAGMENT_SHADER, state.arg());
+    while (state.keep_running())
+	glDeleteShader(compile_shader(GL_FRAGMENT_SHADER, src.next()));
+}
+
+// both compiled and linked, what a shader variant costs the first time it is drawn with
+static void
+bench_build_program(bench_state &state)
+{
+    salted_source vertex(GL_VERTEX_SHADER, state.arg());
+    salted_source fragment(GL_FRAGMENT_SHADER, state.arg());
+    while (state.keep_running()) glDeleteProgram(build_program(vertex.next(), fragment.next()));
+}
+
+// the same program loaded from its binary, what a shader variant costs from the cache
+static void
+bench_program_binary(bench_state &state)
+{
+    if (!(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) {
+	state.skip("needs 4.1 or ARB_get_program_binary");
+	return;
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (!formats) {
+	state.skip("the driver has no program binary formats");
+	return;
+    }
+
+    salted_source vertex(GL_VERTEX_SHADER, state.arg());
+    salted_source fragment(GL_FRAGMENT_SHADER, state.arg());
+    GLuint shaders[2] = {compile_shader(GL_VERTEX_SHADER, vertex.next()),
+			 compile_shader(GL_FRAGMENT_SHADER, fragment.next())};
+    GLuint program = link_program(shaders, 2, "program", true);
+    glDeleteShader(shaders[0]);
+    glDeleteShader(shaders[1]);
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+    glDeleteProgram(program);
+
+    while (state.keep_running()) {
+	GLuint p = glCreateProgram();
+	glProgramBinary(p, format, binary.data(), length);
+	GLint linked = GL_FALSE;
+	glGetProgramiv(p, GL_LINK_STATUS, &linked);
+	glDeleteProgram(p);
+	if (!linked) throw std::runtime_error("program binary rejected");
+    }
+    state.counter("binary_bytes", double(length));
+}
+
+int
+main(int argc, char *argv[])
+{
+    return run_benchmarks(argc, argv, "shader",
+			  {{"compile_vertex", bench_compile_vertex, statement_counts},
+			   {"compile_fragment", bench_compile_fragment, statement_counts},
+			   {"build_program", bench_build_program, statement_counts},
+			   {"program_binary", bench_program_binary, statement_counts}});
+}
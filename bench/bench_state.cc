@@ -0,0 +1,190 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	bench_state.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Benchmarks of the cost of state changes, each change followed by a draw
+
+#include "bench.h"
+#include "opengl_stuff.h"
+
+// a small textured and tinted triangle, the second program differs only by a constant
+static const char *state_vertex_src =
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 vPos;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(vPos, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *state_fragment_src[2] = {
+    "#version 330 core\n"
+    "uniform sampler2D tex;\n"
+    "uniform vec4 tint;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = texture(tex, vec2(0.5)) * tint;\n"
+    "}\n",
+    "#version 330 core\n"
+    "uniform sampler2D tex;\n"
+    "uniform vec4 tint;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = texture(tex, vec2(0.5)) * tint * 0.5;\n"
+    "}\n"};
+
+// Two of everything a change can switch between, the first of each bound. A change only takes
+// effect when something is drawn, so each iteration is a change and a draw of a triangle of
+// a few pixels, and the cost of a change is its time less that of the draw alone.
+class state_scene {
+   public:
+    state_scene()
+    {
+	const float size = 4.0f / bench_target_size;
+	const float shape[6] = {0.0f, 0.0f, size, 0.0f, 0.0f, size};
+	glGenVertexArrays(2, vaos_);
+	glGenBuffers(1, &vbo_);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(shape), shape, GL_STATIC_DRAW);
+	for (GLuint vao : vaos_) {
+	    glBindVertexArray(vao);
+	    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+	    glEnableVertexAttribArray(0);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	const unsigned char texels[2][4] = {{255, 128, 0, 255}, {0, 128, 255, 255}};
+	glGenTextures(2, textures_);
+	for (int i = 0; i < 2; i++) {
+	    glBindTexture(GL_TEXTURE_2D, textures_[i]);
+	    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+			 texels[i]);
+	    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+
+	for (int i = 0; i < 2; i++) {
+	    programs_[i] = build_program(state_vertex_src, state_fragment_src[i], "state");
+	    tint_locs_[i] = glGetUniformLocation(programs_[i], "tint");
+	    glUseProgram(programs_[i]);
+	    glUniform4f(tint_locs_[i], 1.0f, 1.0f, 1.0f, 1.0f);
+	}
+
+	// the other framebuffer is like the one of the harness, without the depth
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, reinterpret_cast<GLint *>(&framebuffers_[0]));
+	glGenFramebuffers(1, &framebuffers_[1]);
+	glGenRenderbuffers(1, &renderbuffer_);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer_);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, bench_target_size, bench_target_size);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_[1]);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+				  renderbuffer_);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_[0]);
+	glUseProgram(programs_[0]);
+	glBindVertexArray(vaos_[0]);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, textures_[0]);
+    }
+    ~state_scene()
+    {
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_[0]);
+	glDisable(GL_BLEND);
+	glDisable(GL_DEPTH_TEST);
+	glUseProgram(0);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDeleteFramebuffers(1, &framebuffers_[1]);
+	glDeleteRenderbuffers(1, &renderbuffer_);
+	glDeleteProgram(programs_[0]);
+	glDeleteProgram(programs_[1]);
+	glDeleteTextures(2, textures_);
+	glDeleteVertexArrays(2, vaos_);
+	glDeleteBuffers(1, &vbo_);
+    }
+
+    state_scene(const state_scene &) = delete;
+    state_scene &operator=(const state_scene &) = delete;
+
+    GLuint program(int i) const { return programs_[i]; }
+    GLint tint_location() const { return tint_locs_[0]; }
+    GLuint vao(int i) const { return vaos_[i]; }
+    GLuint texture(int i) const { return textures_[i]; }
+    GLuint framebuffer(int i) const { return framebuffers_[i]; }
+
+    void draw() const { glDrawArrays(GL_TRIANGLES, 0, 3); }
+
+   private:
+    GLuint programs_[2] = {}, vaos_[2] = {}, vbo_ = 0, textures_[2] = {};
+    GLuint framebuffers_[2] = {}, renderbuffer_ = 0;
+    GLint tint_locs_[2] = {-1, -1};
+};
+
+// change(scene, i) switches to the i-th of two states, alternating every iteration
+template <typename Change>
+static void
+bench_changes(bench_state &state, Change change)
+{
+    state_scene scene;
+    std::uint64_t i = 0;
+    while (state.keep_running()) {
+	change(scene, int(i++ & 1));
+	scene.draw();
+    }
+    state.set_items_per_iteration(1.0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    return run_benchmarks(
+	argc, argv, "state",
+	{{"draw_only",
+	  [](bench_state &state) { bench_changes(state, [](state_scene &, int) {}); }},
+	 {"uniform",
+	  [](bench_state &state) {
+	      bench_changes(state, [](state_scene &s, int i) {
+		  glUniform4f(s.tint_location(), 1.0f, 1.0f, 1.0f - 0.5f * i, 1.0f);
+	      });
+	  }},
+	 {"program",
+	  [](bench_state &state) {
+	      bench_changes(state, [](state_scene &s, int i) { glUseProgram(s.program(i)); });
+	  }},
+	 {"texture",
+	  [](bench_state &state) {
+	      bench_changes(state, [](state_scene &s, int i) {
+		  glBindTexture(GL_TEXTURE_2D, s.texture(i));
+	      });
+	  }},
+	 {"vertex_array",
+	  [](bench_state &state) {
+	      bench_changes(state,
+			    [](state_scene &s, int i) { glBindVertexArray(s.vao(i)); });
+	  }},
+	 {"blend",
+	  [](bench_state &state) {
+	      bench_changes(state, [](state_scene &, int i) {
+		  if (i)
+		      glEnable(GL_BLEND);
+		  else
+		      glDisable(GL_BLEND);
+	      });
+	  }},
+	 {"depth_test",
+	  [](bench_state &state) {
+	      bench_changes(state, [](state_scene &, int i) {
+		  if (i)
+		      glEnable(GL_DEPTH_TEST);
+		  else
+		      glDisable(GL_DEPTH_TEST);
+	      });
+	  }},
+	 {"framebuffer", [](bench_state &state) {
+	      bench_changes(state, [](state_scene &s, int i) {
+		  glBindFramebuffer(GL_FRAMEBUFFER, s.framebuffer(i));
+	      });
+	  }}});
+}
@@ -0,0 +1,276 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	bench_upload.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Benchmarks of the ways to upload a buffer : glBufferData, glBufferSubData and mapping
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "bench.h"
+#include "buffer_heap.h"
+#include "opengl_stuff.h"
+
+// 4 KiB to 16 MiB
+static const std::vector<std::int64_t> upload_sizes = {4096, 65536, 1048576, 16777216};
+
+// ranges live in the heap while it churns
+static const std::vector<std::int64_t> heap_live_counts = {1000, 10000};
+
+// each upload is drawn from, a point with rasterization off, so that it is still in use by the
+// gpu when the next upload comes, as it would be when streaming vertices
+static const char *sink_vertex_src =
+    "#version 330 core\n"
+    "layout (location = 0) in vec4 vPos;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vPos;\n"
+    "}\n";
+
+static const char *sink_fragment_src =
+    "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = vec4(1.0);\n"
+    "}\n";
+
+// the point the gpu reads, 16 bytes
+constexpr GLsizeiptr sink_stride = 4 * sizeof(GLfloat);
+
+class upload_sink {
+   public:
+    explicit upload_sink(GLuint buffer)
+    {
+	program_ = build_program(sink_vertex_src, sink_fragment_src, "upload sink");
+	glGenVertexArrays(1, &vao_);
+	glBindVertexArray(vao_);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sink_stride, nullptr);
+	glEnableVertexAttribArray(0);
+	glUseProgram(program_);
+	glEnable(GL_RASTERIZER_DISCARD);
+    }
+    ~upload_sink()
+    {
+	glDisable(GL_RASTERIZER_DISCARD);
+	glUseProgram(0);
+	glBindVertexArray(0);
+	glDeleteVertexArrays(1, &vao_);
+	glDeleteProgram(program_);
+    }
+
+    upload_sink(const upload_sink &) = delete;
+    upload_sink &operator=(const upload_sink &) = delete;
+
+    // the point at offset bytes into the buffer
+    void draw(GLintptr offset) const
+    {
+	glDrawArrays(GL_POINTS, GLint(offset / sink_stride), 1);
+    }
+
+   private:
+    GLuint program_ = 0, vao_ = 0;
+};
+
+// a new store every time, the driver can hand the old one to the gpu and give us another
+static void
+bench_buffer_data(bench_state &state)
+{
+    std::vector<char> data(state.arg(), 1);
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, data.size(), nullptr, GL_STREAM_DRAW);
+    {
+	upload_sink sink(buffer);
+	while (state.keep_running()) {
+	    glBufferData(GL_ARRAY_BUFFER, data.size(), data.data(), GL_STREAM_DRAW);
+	    sink.draw(0);
+	}
+    }
+    state.set_bytes_per_iteration(double(data.size()));
+    glDeleteBuffers(1, &buffer);
+}
+
+// the same store every time, the driver has to wait for the gpu or copy it aside
+static void
+bench_buffer_sub_data(bench_state &state)
+{
+    std::vector<char> data(state.arg(), 1);
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, data.size(), nullptr, GL_STREAM_DRAW);
+    {
+	upload_sink sink(buffer);
+	while (state.keep_running()) {
+	    glBufferSubData(GL_ARRAY_BUFFER, 0, data.size(), data.data());
+	    sink.draw(0);
+	}
+    }
+    state.set_bytes_per_iteration(double(data.size()));
+    glDeleteBuffers(1, &buffer);
+}
+
+// mapped and invalidated, the orphaning of glBufferData with a pointer in place of a copy
+static void
+bench_map_invalidate(bench_state &state)
+{
+    std::vector<char> data(state.arg(), 1);
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, data.size(), nullptr, GL_STREAM_DRAW);
+    {
+	upload_sink sink(buffer);
+	while (state.keep_running()) {
+	    void *p = glMapBufferRange(GL_ARRAY_BUFFER, 0, data.size(),
+				       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	    if (!p) throw std::runtime_error("glMapBufferRange failed");
+	    std::memcpy(p, data.data(), data.size());
+	    if (!glUnmapBuffer(GL_ARRAY_BUFFER)) throw std::runtime_error("buffer lost on unmap");
+	    sink.draw(0);
+	}
+    }
+    state.set_bytes_per_iteration(double(data.size()));
+    glDeleteBuffers(1, &buffer);
+}
+
+// Unsynchronized into the next free range of a ring four uploads long, the whole ring
+// orphaned when it is full, so the driver never waits and never copies.
+static void
+bench_map_unsynchronized(bench_state &state)
+{
+    std::vector<char> data(state.arg(), 1);
+    GLsizeiptr size = GLsizeiptr(data.size()), capacity = 4 * size, offset = 0;
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    {
+	upload_sink sink(buffer);
+	while (state.keep_running()) {
+	    if (offset + size > capacity) {
+		glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+		offset = 0;
+	    }
+	    void *p = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+				       GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+					   GL_MAP_INVALIDATE_RANGE_BIT);
+	    if (!p) throw std::runtime_error("glMapBufferRange failed");
+	    std::memcpy(p, data.data(), data.size());
+	    if (!glUnmapBuffer(GL_ARRAY_BUFFER)) throw std::runtime_error("buffer lost on unmap");
+	    sink.draw(offset);
+	    offset += size;
+	}
+    }
+    state.set_bytes_per_iteration(double(data.size()));
+    glDeleteBuffers(1, &buffer);
+}
+
+// Mapped once, persistent and coherent, a ring of three ranges each fenced after its draw, so
+// writing a range waits only for the gpu to be done with it three uploads ago.
+static void
+bench_map_persistent(bench_state &state)
+{
+    if (!(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)) {
+	state.skip("needs 4.4 or ARB_buffer_storage");
+	return;
+    }
+
+    const int ranges = 3;
+    std::vector<char> data(state.arg(), 1);
+    GLsizeiptr size = GLsizeiptr(data.size());
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, ranges * size, nullptr, flags);
+    char *ring =
+	static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, ranges * size, flags));
+    if (!ring) {
+	glDeleteBuffers(1, &buffer);
+	throw std::runtime_error("glMapBufferRange failed");
+    }
+
+    GLsync fences[ranges] = {};
+    unsigned long waits = 0;
+    {
+	upload_sink sink(buffer);
+	int next = 0;
+	while (state.keep_running()) {
+	    if (fences[next]) {
+		GLenum r = glClientWaitSync(fences[next], 0, 0);
+		while (r == GL_TIMEOUT_EXPIRED) {
+		    waits++;
+		    r = glClientWaitSync(fences[next], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		}
+		glDeleteSync(fences[next]);
+	    }
+	    std::memcpy(ring + next * size, data.data(), data.size());
+	    sink.draw(next * size);
+	    fences[next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	    next = (next + 1) % ranges;
+	}
+    }
+    for (GLsync f : fences)
+	if (f) glDeleteSync(f);
+    state.set_bytes_per_iteration(double(data.size()));
+    state.counter("fence_waits", double(waits));
+
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glDeleteBuffers(1, &buffer);
+}
+
+// The buffer heap with arg ranges live, each iteration frees one at random and allocates
+// another, of 64 bytes to 64 KiB at the stride of a vertex of 3 to 8 floats, so items per
+// second are the allocations, each with a free. The sizes are drawn before the loop. The
+// fragmentation it ends with is kept, and what is left of it after a defragment().
+static void
+bench_heap_allocate(bench_state &state)
+{
+    std::mt19937 rng(1);
+    std::vector<std::size_t> sizes(4096), strides(4096), victims(4096);
+    for (std::size_t i = 0; i < sizes.size(); i++) {
+	sizes[i] = std::size_t(64) << (rng() % 11);
+	strides[i] = (3 + rng() % 6) * sizeof(GLfloat);
+	victims[i] = rng() % std::size_t(state.arg());
+    }
+
+    buffer_heap heap(std::size_t(16) << 20);
+    std::vector<buffer_heap::handle> live;
+    for (std::int64_t i = 0; i < state.arg(); i++)
+	live.push_back(heap.allocate(sizes[i % sizes.size()], strides[i % strides.size()]));
+    std::size_t next = 0;
+    while (state.keep_running()) {
+	std::size_t k = next++ % sizes.size();
+	heap.free(live[victims[k]]);
+	live[victims[k]] = heap.allocate(sizes[k], strides[k]);
+    }
+    state.set_items_per_iteration(1.0);
+
+    state.counter("blocks", double(heap.blocks()));
+    state.counter("fragmentation", heap.fragmentation());
+    auto start = std::chrono::steady_clock::now();
+    state.counter("defragment_moved_bytes", double(heap.defragment()));
+    glFinish();
+    state.counter("defragment_ms", std::chrono::duration<double, std::milli>(
+					   std::chrono::steady_clock::now() - start)
+					   .count());
+    state.counter("fragmentation_defragmented", heap.fragmentation());
+}
+
+int
+main(int argc, char *argv[])
+{
+    return run_benchmarks(argc, argv, "upload",
+			  {{"buffer_data", bench_buffer_data, upload_sizes},
+			   {"buffer_sub_data", bench_buffer_sub_data, upload_sizes},
+			   {"map_invalidate", bench_map_invalidate, upload_sizes},
+			   {"map_unsynchronized", bench_map_unsynchronized, upload_sizes},
+			   {"map_persistent", bench_map_persistent, upload_sizes},
+			   {"heap_allocate", bench_heap_allocate, heap_live_counts}});
+}
@@ -0,0 +1,36 @@
+#version 330 core
+
+// pass the input from rasterizer to display, the debug views have variants of their own
+
+in vec4 fCol;
+
+#if defined(TEXTURED)
+in vec3 fUV;
+
+#if defined(ATLAS)
+// all the textures in the layers of one
+uniform sampler2DArray tex;
+#else
+uniform sampler2D tex;
+#endif
+#endif
+
+out vec4 FragColor;
+
+void main()
+{
+#if defined(OVERDRAW)
+   // one layer, added up by the ONE/ONE blending of the overdraw heatmap
+   FragColor = vec4(1.0 / 255.0);
+#elif defined(WIREFRAME)
+   // the edges in full brightness, so that thin lines stand out against the background
+   FragColor = vec4(fCol.rgb * 0.5 + 0.5, 1.0);
+#elif defined(TEXTURED) && defined(ATLAS)
+   FragColor = texture(tex, fUV) * (fCol * 0.5 + 0.5);
+#elif defined(TEXTURED)
+   // the texture tinted with the vertex colours, brightened so that it stays visible
+   FragColor = texture(tex, fUV.xy) * (fCol * 0.5 + 0.5);
+#else
+   FragColor = vec4(fCol);
+#endif
+}
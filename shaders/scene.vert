@@ -0,0 +1,42 @@
+#version 330 core
+
+// pass the input from app to rasterizer, rotated by angle around the origin
+
+layout (location = 0) in vec3 vPos;
+layout (location = 1) in vec3 vCol;
+
+#if defined(TEX_COORDS)
+// texture coordinates of the vertex, with the layer of the atlas in the third
+layout (location = 2) in vec3 vUV;
+#endif
+
+uniform float angle;
+
+// where a copy of the mesh goes, the offset and the scale, the pinwheel stays as it is, the
+// depth is left alone so that scaling up never pushes anything out of the depth range
+uniform vec3 placement = vec3(0.0, 0.0, 1.0);
+
+// the depth pre-pass draws with the plain variant and the colour pass with another, the
+// positions have to come out the same in every variant for GL_LEQUAL to pass
+invariant gl_Position;
+
+out vec4 fCol;
+
+#if defined(TEXTURED)
+// without coordinates of its own the texture is stretched over the unrotated square, t goes
+// down the image
+out vec3 fUV;
+#endif
+
+void main()
+{
+   float c = cos(angle), s = sin(angle);
+   vec2 p = vec2(c * vPos.x - s * vPos.y, s * vPos.x + c * vPos.y);
+   gl_Position = vec4(p * placement.z + placement.xy, vPos.z, 1.0);
+   fCol = vec4(vCol.r, vCol.g, vCol.b, 1.0);
+#if defined(TEXTURED) && defined(TEX_COORDS)
+   fUV = vUV;
+#elif defined(TEXTURED)
+   fUV = vec3(vPos.x * 0.5 + 0.5, 0.5 - vPos.y * 0.5, 0.0);
+#endif
+}
@@ -0,0 +1,210 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	antialiasing.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Selectable anti-aliasing
+
+#include "antialiasing.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "opengl_stuff.h"
+
+// full screen triangle, no vertex data, the vertex id is enough
+static const char *fxaa_vertex_src =
+    "#version 330 core\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+    "   gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+// FXAA in its simple form : find the local edge direction from the luma of the four diagonal
+// neighbours, blur along it, and fall back to the narrower blur if the wide one overshoots the
+// local luma range. The window and the scene target share the lower left origin, so the
+// fragment coordinate times the inverse target size is the texture coordinate.
+static const char *fxaa_fragment_src =
+    "#version 330 core\n"
+    "uniform sampler2D scene;\n"
+    "uniform vec2 inv_size;\n"
+    "out vec4 FragColor;\n"
+    "const float reduce_min = 1.0 / 128.0;\n"
+    "const float reduce_mul = 1.0 / 8.0;\n"
+    "const float span_max = 8.0;\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 uv = gl_FragCoord.xy * inv_size;\n"
+    "   vec3 luma = vec3(0.299, 0.587, 0.114);\n"
+    "   float nw = dot(texture(scene, uv + vec2(-1.0, -1.0) * inv_size).rgb, luma);\n"
+    "   float ne = dot(texture(scene, uv + vec2(1.0, -1.0) * inv_size).rgb, luma);\n"
+    "   float sw = dot(texture(scene, uv + vec2(-1.0, 1.0) * inv_size).rgb, luma);\n"
+    "   float se = dot(texture(scene, uv + vec2(1.0, 1.0) * inv_size).rgb, luma);\n"
+    "   vec4 centre = texture(scene, uv);\n"
+    "   float m = dot(centre.rgb, luma);\n"
+    "   float luma_min = min(m, min(min(nw, ne), min(sw, se)));\n"
+    "   float luma_max = max(m, max(max(nw, ne), max(sw, se)));\n"
+    "   vec2 dir = vec2(-((nw + ne) - (sw + se)), (nw + sw) - (ne + se));\n"
+    "   float reduce = max((nw + ne + sw + se) * 0.25 * reduce_mul, reduce_min);\n"
+    "   float rcp_min = 1.0 / (min(abs(dir.x), abs(dir.y)) + reduce);\n"
+    "   dir = clamp(dir * rcp_min, vec2(-span_max), vec2(span_max)) * inv_size;\n"
+    "   vec3 a = 0.5 * (texture(scene, uv + dir * (1.0 / 3.0 - 0.5)).rgb +\n"
+    "                   texture(scene, uv + dir * (2.0 / 3.0 - 0.5)).rgb);\n"
+    "   vec3 b = a * 0.5 + 0.25 * (texture(scene, uv - dir * 0.5).rgb +\n"
+    "                              texture(scene, uv + dir * 0.5).rgb);\n"
+    "   float luma_b = dot(b, luma);\n"
+    "   FragColor = vec4((luma_b < luma_min || luma_b > luma_max) ? a : b, centre.a);\n"
+    "}\n";
+
+const char *
+aa_mode_name(aa_mode mode)
+{
+    switch (mode) {
+	case aa_mode::off:
+	    return "off";
+	case aa_mode::msaa2:
+	    return "msaa2";
+	case aa_mode::msaa4:
+	    return "msaa4";
+	case aa_mode::msaa8:
+	    return "msaa8";
+	case aa_mode::fxaa:
+	    return "fxaa";
+    }
+    return "unknown";
+}
+
+aa_mode
+parse_aa_mode(const std::string &name)
+{
+    for (int i = 0; i < num_aa_modes; i++) {
+	if (name == aa_mode_name(aa_mode(i))) return aa_mode(i);
+    }
+    throw std::runtime_error("unknown anti-aliasing mode " + name +
+			     ", use off, msaa2, msaa4, msaa8 or fxaa");
+}
+
+antialiaser::antialiaser(aa_mode mode) : mode_(mode)
+{
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples_);
+
+    // a multisample resolve blit needs identical formats on both sides
+    GLint r = 0, g = 0, b = 0, a = 0;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_BACK_LEFT,
+					  GL_FRAMEBUFFER_ATTACHMENT_RED_SIZE, &r);
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_BACK_LEFT,
+					  GL_FRAMEBUFFER_ATTACHMENT_GREEN_SIZE, &g);
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_BACK_LEFT,
+					  GL_FRAMEBUFFER_ATTACHMENT_BLUE_SIZE, &b);
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_BACK_LEFT,
+					  GL_FRAMEBUFFER_ATTACHMENT_ALPHA_SIZE, &a);
+    direct_resolve_ = r == 8 && g == 8 && b == 8 && a == 8;
+
+    fxaa_program_ = build_program(fxaa_vertex_src, fxaa_fragment_src, "fxaa");
+    inv_size_loc_ = glGetUniformLocation(fxaa_program_, "inv_size");
+    glUseProgram(fxaa_program_);
+    glUniform1i(glGetUniformLocation(fxaa_program_, "scene"), 0);
+    glUseProgram(0);
+
+    glGenVertexArrays(1, &empty_vao_);
+}
+
+antialiaser::~antialiaser()
+{
+    glDeleteVertexArrays(1, &empty_vao_);
+    glDeleteProgram(fxaa_program_);
+}
+
+int
+antialiaser::samples() const
+{
+    int wanted = 1;
+    switch (mode_) {
+	case aa_mode::msaa2:
+	    wanted = 2;
+	    break;
+	case aa_mode::msaa4:
+	    wanted = 4;
+	    break;
+	case aa_mode::msaa8:
+	    wanted = 8;
+	    break;
+	default:
+	    break;
+    }
+    return std::max(1, std::min(wanted, max_samples_));
+}
+
+render_target_desc
+antialiaser::scene_desc(int width, int height) const
+{
+    render_target_desc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.samples = samples();
+    desc.depth_format = depth_format_;
+    desc.name = desc.samples > 1 ? "scene_msaa" : "scene";
+    return desc;
+}
+
+render_target_desc
+antialiaser::resolve_desc(int width, int height) const
+{
+    render_target_desc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.name = "scene_resolved";
+    return desc;
+}
+
+void
+antialiaser::resolve(const render_target &scene, const render_target &to)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, scene.fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, to.fbo);
+    glBlitFramebuffer(0, 0, scene.width, scene.height, 0, 0, scene.width, scene.height,
+		      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void
+antialiaser::present(const render_target &scene)
+{
+    // a multisampled scene is resolved by the blit itself
+    if (mode_ == aa_mode::fxaa)
+	fxaa_to_window(scene);
+    else
+	blit_to_window(scene.fbo, scene.width, scene.height);
+}
+
+void
+antialiaser::blit_to_window(GLuint fbo, int width, int height)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT,
+		      GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void
+antialiaser::fxaa_to_window(const render_target &rt)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // a full screen pass must not be depth tested
+    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+
+    glUseProgram(fxaa_program_);
+    glUniform2f(inv_size_loc_, 1.0f / rt.alloc_width, 1.0f / rt.alloc_height);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, rt.color_tex);
+    glBindVertexArray(empty_vao_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (depth_test) glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,83 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// antialiasing.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Selectable anti-aliasing : off, MSAA 2x/4x/8x with blit resolve, or an FXAA post-process pass
+
+#ifndef ANTIALIASING_H
+#define ANTIALIASING_H
+
+#include <GL/glew.h>
+
+#include <string>
+
+#include "render_target_pool.h"
+
+enum class aa_mode { off, msaa2, msaa4, msaa8, fxaa };
+constexpr int num_aa_modes = 5;
+
+const char *aa_mode_name(aa_mode mode);
+aa_mode parse_aa_mode(const std::string &name);
+
+// The default framebuffer stays single sampled, anti-aliasing happens offscreen. With MSAA the
+// scene goes into a multisampled target, with FXAA into a texture that a full screen pass then
+// filters into the window. The targets belong to the frame graph, the antialiaser only says
+// what they look like and fills them. The resolve blit goes straight to the default
+// framebuffer if the formats allow, only a format mismatch costs an extra single sampled
+// target, and so does anybody else wanting to sample the image.
+
+class antialiaser {
+   public:
+    // needs the context to be current
+    explicit antialiaser(aa_mode mode = aa_mode::off);
+    ~antialiaser();
+
+    antialiaser(const antialiaser &) = delete;
+    antialiaser &operator=(const antialiaser &) = delete;
+
+    void set_mode(aa_mode mode) { mode_ = mode; }
+    aa_mode mode() const { return mode_; }
+
+    // depth buffer of the offscreen targets, 0 for none
+    void set_depth_format(GLenum format) { depth_format_ = format; }
+    GLenum depth_format() const { return depth_format_; }
+
+    // samples the current mode really uses, msaa is clamped to GL_MAX_SAMPLES
+    int samples() const;
+
+    // whether the scene needs a target rather than the window, offscreen asks for one even
+    // when anti-aliasing is off
+    bool wants_target(bool offscreen) const { return mode_ != aa_mode::off || offscreen; }
+
+    // the target to draw the scene into
+    render_target_desc scene_desc(int width, int height) const;
+
+    // whether the window cannot take the scene target as it is, and needs a single sampled
+    // copy first, and what the copy looks like
+    bool needs_resolve() const { return samples() > 1 && !direct_resolve_; }
+    render_target_desc resolve_desc(int width, int height) const;
+
+    // resolve a multisampled scene into a single sampled target
+    void resolve(const render_target &scene, const render_target &to);
+
+    // put the scene, or its resolved copy, into the window, filtering as the mode wants
+    void present(const render_target &scene);
+
+   private:
+    void blit_to_window(GLuint fbo, int width, int height);
+    void fxaa_to_window(const render_target &rt);
+
+    aa_mode mode_;
+    // the window has a depth buffer too, glfw asks for 24 bits unless told otherwise
+    GLenum depth_format_ = GL_DEPTH_COMPONENT24;
+    int max_samples_ = 1;
+    // default framebuffer is RGBA8, so msaa can be resolved straight into it
+    bool direct_resolve_ = false;
+
+    // full screen fxaa pass, core profile needs a vao even without attributes
+    GLuint fxaa_program_ = 0;
+    GLuint empty_vao_ = 0;
+    GLint inv_size_loc_ = -1;
+};
+
+#endif	// ANTIALIASING_H
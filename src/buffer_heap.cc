@@ -0,0 +1,410 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	buffer_heap.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Ranges of a few big buffer objects handed out by a TLSF allocator
+
+#include "buffer_heap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <ostream>
+
+// every size and offset is a multiple of this
+static const std::size_t granularity = 16;
+
+static std::size_t
+round_up(std::size_t n, std::size_t multiple)
+{
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+// index of the highest bit set, n is not 0
+static int
+top_bit(std::uint64_t n)
+{
+    return 63 - __builtin_clzll(n);
+}
+
+static double
+ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	.count();
+}
+
+buffer_heap::buffer_heap(std::size_t block_size, gpu_category category, const char *tag)
+    : block_size_(round_up(std::max(block_size, granularity), granularity)),
+      category_(category),
+      tag_(tag)
+{
+    for (auto &lists : free_lists_) std::fill(std::begin(lists), std::end(lists), no_handle);
+}
+
+buffer_heap::~buffer_heap()
+{
+    for (const heap_block &b : blocks_) tracked_delete_buffers(1, &b.buffer);
+}
+
+void
+buffer_heap::mapping_insert(std::size_t size, int &fl, int &sl)
+{
+    if (size < (std::size_t(1) << small_bits)) {
+	fl = 0;
+	sl = int(size / granularity);
+	return;
+    }
+    int top = top_bit(size);
+    fl = top - small_bits + 1;
+    sl = int(size >> (top - sl_bits)) - sl_count;
+}
+
+void
+buffer_heap::mapping_search(std::size_t size, int &fl, int &sl)
+{
+    // up to the next list, whose chunks are all at least size; the lists of the small sizes
+    // hold a single size each
+    if (size >= (std::size_t(1) << small_bits))
+	size += (std::size_t(1) << (top_bit(size) - sl_bits)) - 1;
+    mapping_insert(size, fl, sl);
+}
+
+buffer_heap::handle
+buffer_heap::new_chunk()
+{
+    handle h;
+    if (!spare_.empty()) {
+	h = spare_.back();
+	spare_.pop_back();
+    }
+    else {
+	h = handle(chunks_.size());
+	chunks_.emplace_back();
+    }
+    chunks_[h] = chunk();
+    chunks_[h].live = true;
+    return h;
+}
+
+void
+buffer_heap::insert_free(handle h)
+{
+    chunk &c = chunks_[h];
+    int fl, sl;
+    mapping_insert(c.size, fl, sl);
+    c.free = true;
+    c.prev_free = no_handle;
+    c.next_free = free_lists_[fl][sl];
+    if (c.next_free != no_handle) chunks_[c.next_free].prev_free = h;
+    free_lists_[fl][sl] = h;
+    fl_bitmap_ |= std::uint64_t(1) << fl;
+    sl_bitmap_[fl] |= 1u << sl;
+}
+
+void
+buffer_heap::remove_free(handle h)
+{
+    chunk &c = chunks_[h];
+    int fl, sl;
+    mapping_insert(c.size, fl, sl);
+    if (c.prev_free != no_handle)
+	chunks_[c.prev_free].next_free = c.next_free;
+    else
+	free_lists_[fl][sl] = c.next_free;
+    if (c.next_free != no_handle) chunks_[c.next_free].prev_free = c.prev_free;
+    if (free_lists_[fl][sl] == no_handle) {
+	sl_bitmap_[fl] &= ~(1u << sl);
+	if (!sl_bitmap_[fl]) fl_bitmap_ &= ~(std::uint64_t(1) << fl);
+    }
+    c.free = false;
+    c.prev_free = c.next_free = no_handle;
+}
+
+buffer_heap::handle
+buffer_heap::find_free(std::size_t size)
+{
+    int fl, sl;
+    mapping_search(size, fl, sl);
+    if (fl >= fl_count) return no_handle;
+    std::uint32_t sl_map = sl_bitmap_[fl] & (~0u << sl);
+    if (!sl_map) {
+	std::uint64_t fl_map = fl + 1 < 64 ? fl_bitmap_ & (~std::uint64_t(0) << (fl + 1)) : 0;
+	if (!fl_map) return no_handle;
+	fl = __builtin_ctzll(fl_map);
+	sl_map = sl_bitmap_[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+    return free_lists_[fl][sl];
+}
+
+buffer_heap::handle
+buffer_heap::split(handle h, std::size_t at)
+{
+    handle t = new_chunk();
+    chunk &c = chunks_[h], &tail = chunks_[t];
+    tail.block = c.block;
+    tail.offset = at;
+    tail.size = c.offset + c.size - at;
+    tail.prev = h;
+    tail.next = c.next;
+    if (c.next != no_handle) chunks_[c.next].prev = t;
+    c.next = t;
+    c.size = at - c.offset;
+    return t;
+}
+
+void
+buffer_heap::merge_free(handle h)
+{
+    handle next = chunks_[h].next;
+    if (next != no_handle && chunks_[next].free) {
+	remove_free(next);
+	chunk &c = chunks_[h], &n = chunks_[next];
+	c.size += n.size;
+	c.next = n.next;
+	if (n.next != no_handle) chunks_[n.next].prev = h;
+	n.live = false;
+	spare_.push_back(next);
+    }
+    handle prev = chunks_[h].prev;
+    if (prev != no_handle && chunks_[prev].free) {
+	remove_free(prev);
+	chunk &c = chunks_[h], &p = chunks_[prev];
+	p.size += c.size;
+	p.next = c.next;
+	if (c.next != no_handle) chunks_[c.next].prev = prev;
+	c.live = false;
+	spare_.push_back(h);
+	h = prev;
+    }
+    insert_free(h);
+}
+
+buffer_heap::handle
+buffer_heap::add_block(std::size_t size)
+{
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    tracked_buffer_data(GL_COPY_WRITE_BUFFER, buffer, GLsizeiptr(size), nullptr, GL_STATIC_DRAW,
+			category_, tag_);
+    handle h = new_chunk();
+    chunk &c = chunks_[h];
+    c.block = blocks_.size();
+    c.offset = 0;
+    c.size = size;
+    blocks_.push_back({buffer, size, h});
+    capacity_ += size;
+    insert_free(h);
+    return h;
+}
+
+buffer_heap::handle
+buffer_heap::allocate(std::size_t size, std::size_t alignment)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t align = std::lcm(std::max(alignment, std::size_t(1)), granularity);
+    size = round_up(std::max(size, std::size_t(1)), granularity);
+
+    // room for the size wherever the chunk starts, a fresh block starts aligned
+    std::size_t need = size + align - granularity;
+    handle h = find_free(need);
+    if (h == no_handle) h = add_block(std::max(block_size_, size));
+    remove_free(h);
+
+    // the padding in front, and the rest behind, go back to the free lists, their neighbours
+    // on the other side are in use, or a free chunk would have been merged with h
+    std::size_t at = round_up(chunks_[h].offset, align);
+    if (at != chunks_[h].offset) {
+	handle tail = split(h, at);
+	insert_free(h);
+	h = tail;
+    }
+    if (chunks_[h].size > size) insert_free(split(h, at + size));
+
+    chunk &c = chunks_[h];
+    c.alignment = align;
+    used_ += c.size;
+    peak_used_ = std::max(peak_used_, used_);
+    live_++;
+    allocations_++;
+    allocate_ms_ += ms_since(start);
+    return h;
+}
+
+void
+buffer_heap::free(handle h)
+{
+    if (h == no_handle) return;
+    auto start = std::chrono::steady_clock::now();
+    used_ -= chunks_[h].size;
+    live_--;
+    frees_++;
+    merge_free(h);
+    free_ms_ += ms_since(start);
+}
+
+void
+buffer_heap::upload(handle h, const void *data, std::size_t size, std::size_t offset)
+{
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer(h));
+    glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(chunks_[h].offset + offset),
+		    GLsizeiptr(size), data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+std::size_t
+buffer_heap::defragment()
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t moved = 0;
+    std::vector<handle> used;
+    std::vector<std::size_t> offsets;
+    for (std::size_t b = 0; b < blocks_.size(); b++) {
+	heap_block &block = blocks_[b];
+
+	// the chunks in use in the order of their offsets, and where they go, packed from the
+	// start of the block as tightly as their alignments allow; the free ones are dropped
+	used.clear();
+	offsets.clear();
+	std::size_t end = 0, first_moved = 0;
+	bool moves = false;
+	for (handle h = block.first; h != no_handle;) {
+	    handle next = chunks_[h].next;
+	    const chunk &c = chunks_[h];
+	    if (c.free) {
+		remove_free(h);
+		chunks_[h].live = false;
+		spare_.push_back(h);
+	    }
+	    else {
+		std::size_t to = round_up(end, c.alignment);
+		if (to != c.offset && !moves) {
+		    moves = true;
+		    first_moved = to;
+		}
+		if (to != c.offset) moved += c.size;
+		used.push_back(h);
+		offsets.push_back(to);
+		end = to + c.size;
+	    }
+	    h = next;
+	}
+
+	// The ranges only ever move down, but a range can move onto itself, which
+	// glCopyBufferSubData does not allow within a buffer. So the ranges from the first that
+	// moves go to a scratch buffer at their new places, and from there back in one copy.
+	if (moves) {
+	    GLuint scratch = 0;
+	    glGenBuffers(1, &scratch);
+	    tracked_buffer_data(GL_COPY_WRITE_BUFFER, scratch, GLsizeiptr(end - first_moved),
+				nullptr, GL_STREAM_COPY, gpu_category::staging, tag_);
+	    glBindBuffer(GL_COPY_READ_BUFFER, block.buffer);
+	    for (std::size_t i = 0; i < used.size(); i++) {
+		if (offsets[i] < first_moved) continue;
+		const chunk &c = chunks_[used[i]];
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+				    GLintptr(c.offset), GLintptr(offsets[i] - first_moved),
+				    GLsizeiptr(c.size));
+	    }
+	    glBindBuffer(GL_COPY_READ_BUFFER, scratch);
+	    glBindBuffer(GL_COPY_WRITE_BUFFER, block.buffer);
+	    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+				GLintptr(first_moved), GLsizeiptr(end - first_moved));
+	    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	    tracked_delete_buffers(1, &scratch);
+	}
+
+	// link the chunks again, with free chunks for the gaps of the alignments, and for the
+	// rest of the block at the end
+	handle prev = no_handle;
+	auto append = [&](handle h) {
+	    chunks_[h].prev = prev;
+	    chunks_[h].next = no_handle;
+	    if (prev != no_handle)
+		chunks_[prev].next = h;
+	    else
+		block.first = h;
+	    prev = h;
+	};
+	auto append_free = [&](std::size_t offset, std::size_t size) {
+	    handle h = new_chunk();
+	    chunks_[h].block = b;
+	    chunks_[h].offset = offset;
+	    chunks_[h].size = size;
+	    append(h);
+	    insert_free(h);
+	};
+	std::size_t at = 0;
+	for (std::size_t i = 0; i < used.size(); i++) {
+	    if (offsets[i] > at) append_free(at, offsets[i] - at);
+	    chunks_[used[i]].offset = offsets[i];
+	    append(used[i]);
+	    at = offsets[i] + chunks_[used[i]].size;
+	}
+	if (at < block.size) append_free(at, block.size - at);
+    }
+
+    defragmentations_++;
+    moved_bytes_ += moved;
+    defragment_ms_ += ms_since(start);
+    return moved;
+}
+
+std::size_t
+buffer_heap::largest_free() const
+{
+    // in the highest list that has chunks, which holds a range of sizes
+    if (!fl_bitmap_) return 0;
+    int fl = top_bit(fl_bitmap_);
+    int sl = top_bit(sl_bitmap_[fl]);
+    std::size_t largest = 0;
+    for (handle h = free_lists_[fl][sl]; h != no_handle; h = chunks_[h].next_free)
+	largest = std::max(largest, chunks_[h].size);
+    return largest;
+}
+
+double
+buffer_heap::fragmentation() const
+{
+    // block by block, a range never spans two of them, so the free space of a block is in
+    // one piece at best
+    std::size_t free_bytes = 0, scattered = 0;
+    for (const heap_block &block : blocks_) {
+	std::size_t block_free = 0, block_largest = 0;
+	for (handle h = block.first; h != no_handle; h = chunks_[h].next) {
+	    if (!chunks_[h].free) continue;
+	    block_free += chunks_[h].size;
+	    block_largest = std::max(block_largest, chunks_[h].size);
+	}
+	free_bytes += block_free;
+	scattered += block_free - block_largest;
+    }
+    return free_bytes ? double(scattered) / free_bytes : 0.0;
+}
+
+void
+buffer_heap::report(std::ostream &out) const
+{
+    out << "buffer_heap: " << tag_ << std::endl;
+    out << "buffer_heap_blocks: " << blocks_.size() << std::endl;
+    out << "buffer_heap_capacity_bytes: " << capacity_ << std::endl;
+    out << "buffer_heap_used_bytes: " << used_ << std::endl;
+    out << "buffer_heap_peak_used_bytes: " << peak_used_ << std::endl;
+    out << "buffer_heap_largest_free_bytes: " << largest_free() << std::endl;
+    out << "buffer_heap_fragmentation: " << fragmentation() << std::endl;
+    out << "buffer_heap_live_allocations: " << live_ << std::endl;
+    out << "buffer_heap_allocations: " << allocations_ << std::endl;
+    out << "buffer_heap_frees: " << frees_ << std::endl;
+    if (allocations_) {
+	out << "buffer_heap_allocate_us: " << 1000.0 * allocate_ms_ / allocations_ << std::endl;
+	if (allocate_ms_ > 0.0)
+	    out << "buffer_heap_allocations_per_second: "
+		<< 1000.0 * allocations_ / allocate_ms_ << std::endl;
+    }
+    if (frees_) out << "buffer_heap_free_us: " << 1000.0 * free_ms_ / frees_ << std::endl;
+    out << "buffer_heap_defragmentations: " << defragmentations_ << std::endl;
+    out << "buffer_heap_moved_bytes: " << moved_bytes_ << std::endl;
+    out << "buffer_heap_defragment_ms: " << defragment_ms_ << std::endl;
+}
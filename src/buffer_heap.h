@@ -0,0 +1,155 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// buffer_heap.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Ranges of a few big buffer objects handed out by a TLSF allocator, in place of a buffer
+// object per mesh
+
+#ifndef BUFFER_HEAP_H
+#define BUFFER_HEAP_H
+
+#include "gpu_memory.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// A mesh in a buffer of its own costs a buffer object, and a vertex array and a bind per draw.
+// The heap puts the meshes side by side in blocks, buffer objects of block_size bytes (or of
+// one allocation, if it is bigger), so that the meshes of a block are drawn with one vertex
+// array bound, each at its own offset, the vertices through the base vertex of
+// glDrawElementsBaseVertex. A range can hold the vertices and indices of a mesh together, the
+// buffer is bound as both.
+//
+// The free ranges are kept by a two level segregated fit (TLSF) allocator : the first level
+// is the power of two of the size, the second splits each power of two into 16 lists, and a
+// bitmap per level says which lists have ranges. Finding a free range that fits is two bit
+// scans, whatever the number of ranges, and a freed range is merged with the free neighbours
+// in its block at once. Sizes are rounded up to 16 bytes, so a range wastes less than 16 bytes
+// and a sixteenth of its size.
+//
+// Ranges that are freed and allocated again leave holes. defragment() slides the ranges of each
+// block down to its start, through a scratch buffer, so that the free space is in one piece at
+// the end. The buffer objects stay the same, their vertex arrays stay valid, but the offsets
+// change, so the owner asks for them again after it.
+//
+// It needs the context to be current, and all its buffers are recorded with the gpu memory
+// tracker.
+
+class buffer_heap {
+   public:
+    // names an allocation, it stays the same when defragment() moves the range
+    using handle = std::uint32_t;
+    static constexpr handle no_handle = ~handle(0);
+
+    // block_size : bytes of a block, category and tag : what the blocks are recorded as
+    explicit buffer_heap(std::size_t block_size = std::size_t(64) << 20,
+			 gpu_category category = gpu_category::vertices,
+			 const char *tag = "buffer_heap");
+    ~buffer_heap();
+
+    buffer_heap(const buffer_heap &) = delete;
+    buffer_heap &operator=(const buffer_heap &) = delete;
+
+    // a range of at least size bytes, its offset a multiple of alignment (which need not be
+    // a power of two, a vertex stride of 24 is fine), in a new block if none has room
+    handle allocate(std::size_t size, std::size_t alignment = 16);
+
+    // give the range back, a no_handle is skipped
+    void free(handle h);
+
+    // copy size bytes of data to offset bytes into the range, through GL_COPY_WRITE_BUFFER so
+    // that the element array binding of the bound vertex array is not touched
+    void upload(handle h, const void *data, std::size_t size, std::size_t offset = 0);
+
+    // where the range is : its block, the buffer object of the block, and its offset
+    std::size_t block(handle h) const { return chunks_[h].block; }
+    GLuint buffer(handle h) const { return blocks_[chunks_[h].block].buffer; }
+    std::size_t offset(handle h) const { return chunks_[h].offset; }
+    std::size_t size(handle h) const { return chunks_[h].size; }
+
+    // blocks are only ever added, a block index stays valid as long as the heap
+    std::size_t blocks() const { return blocks_.size(); }
+    GLuint block_buffer(std::size_t block) const { return blocks_[block].buffer; }
+
+    // slide the ranges of every block down to its start, returns the bytes moved
+    std::size_t defragment();
+
+    // bytes of the blocks, of the ranges handed out, and of the largest free range
+    std::size_t capacity() const { return capacity_; }
+    std::size_t used_bytes() const { return used_; }
+    std::size_t largest_free() const;
+
+    // the share of the free bytes outside the largest free range of their block, 0 when the
+    // free space of every block is in one piece
+    double fragmentation() const;
+
+    // print the sizes, the fragmentation, the allocation rate and the defragmentations, one
+    // stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    // every byte of a block is in one chunk, used or free, the chunks of a block are linked
+    // in the order of their offsets, the free ones also in the list of their size
+    struct chunk {
+	std::size_t block, offset, size;
+	// the alignment asked for, kept by defragment()
+	std::size_t alignment;
+	handle prev = no_handle, next = no_handle;
+	handle prev_free = no_handle, next_free = no_handle;
+	bool free = false, live = false;
+    };
+
+    struct heap_block {
+	GLuint buffer;
+	std::size_t size;
+	handle first;
+    };
+
+    static constexpr int sl_bits = 4;
+    static constexpr int sl_count = 1 << sl_bits;
+    // sizes below 2^small_bits go into the lists of the first level by 16 bytes
+    static constexpr int small_bits = sl_bits + 4;
+    static constexpr int fl_count = 64 - small_bits + 1;
+
+    // the lists a free chunk of size goes into, and the first lists whose chunks all fit size
+    static void mapping_insert(std::size_t size, int &fl, int &sl);
+    static void mapping_search(std::size_t size, int &fl, int &sl);
+
+    handle new_chunk();
+    void insert_free(handle h);
+    void remove_free(handle h);
+    // a free chunk of at least size bytes, no_handle if there is none
+    handle find_free(std::size_t size);
+    // cut h at offset at, returns the tail, which is in no free list yet
+    handle split(handle h, std::size_t at);
+    // merge the free chunk h with its free neighbours and put it in its free list
+    void merge_free(handle h);
+    // a new block, returns its one free chunk
+    handle add_block(std::size_t size);
+
+    std::size_t block_size_;
+    gpu_category category_;
+    const char *tag_;
+
+    std::vector<heap_block> blocks_;
+    std::vector<chunk> chunks_;
+    // chunks to reuse
+    std::vector<handle> spare_;
+
+    std::uint64_t fl_bitmap_ = 0;
+    std::uint32_t sl_bitmap_[fl_count] = {};
+    handle free_lists_[fl_count][sl_count];
+
+    std::size_t capacity_ = 0, used_ = 0, peak_used_ = 0;
+    unsigned long live_ = 0, allocations_ = 0, frees_ = 0;
+    double allocate_ms_ = 0.0, free_ms_ = 0.0;
+    unsigned long defragmentations_ = 0;
+    std::size_t moved_bytes_ = 0;
+    double defragment_ms_ = 0.0;
+};
+
+#endif	// BUFFER_HEAP_H
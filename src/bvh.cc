@@ -0,0 +1,323 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	bvh.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Bounding volume hierarchy over the boxes of scene objects, for culling and picking
+
+#include "bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+void
+aabb::grow(const aabb &b)
+{
+    for (int i = 0; i < 3; i++) {
+	lo[i] = std::min(lo[i], b.lo[i]);
+	hi[i] = std::max(hi[i], b.hi[i]);
+    }
+}
+
+float
+aabb::area() const
+{
+    float x = hi[0] - lo[0], y = hi[1] - lo[1], z = hi[2] - lo[2];
+    return x * y + y * z + z * x;
+}
+
+frustum
+frustum::from_matrix(const float m[16])
+{
+    // rows of the matrix, clip w plus or minus clip x, y, z has to be positive
+    frustum f;
+    for (int p = 0; p < 6; p++) {
+	int row = p / 2;
+	float sign = p % 2 ? -1.0f : 1.0f;
+	for (int i = 0; i < 4; i++) f.planes[p][i] = m[4 * i + 3] + sign * m[4 * i + row];
+    }
+    return f;
+}
+
+bool
+frustum::intersects(const aabb &b) const
+{
+    for (const float *pl : planes) {
+	float outer = pl[3];
+	for (int k = 0; k < 3; k++) outer += pl[k] * (pl[k] > 0.0f ? b.hi[k] : b.lo[k]);
+	if (outer < 0.0f) return false;
+    }
+    return true;
+}
+
+// splits further down than this go through the middle, so that the traversal stacks are
+// never deeper than this plus the log of the object count
+static const int max_sah_level = 48;
+static const int num_bins = 16;
+static const int max_stack = 128;
+
+void
+bvh::build(const std::vector<aabb> &boxes, int max_leaf)
+{
+    for (auto *v : {&lo_x_, &lo_y_, &lo_z_, &hi_x_, &hi_y_, &hi_z_}) v->clear();
+    first_.clear();
+    count_.clear();
+    depth_ = 0;
+
+    order_.resize(boxes.size());
+    std::iota(order_.begin(), order_.end(), 0u);
+    if (boxes.empty()) return;
+
+    std::vector<float> centres(boxes.size() * 3);
+    for (std::size_t i = 0; i < boxes.size(); i++)
+	for (int k = 0; k < 3; k++)
+	    centres[3 * i + k] = (boxes[i].lo[k] + boxes[i].hi[k]) * 0.5f;
+
+    build_node(boxes, centres, 0, unsigned(boxes.size()), std::max(max_leaf, 1), 1);
+    refit(boxes);
+}
+
+unsigned
+bvh::build_node(const std::vector<aabb> &boxes, const std::vector<float> &centres,
+		unsigned first, unsigned count, int max_leaf, int level)
+{
+    unsigned node = unsigned(first_.size());
+    for (auto *v : {&lo_x_, &lo_y_, &lo_z_, &hi_x_, &hi_y_, &hi_z_}) v->push_back(0.0f);
+    first_.push_back(first);
+    count_.push_back(count);
+    depth_ = std::max(depth_, level);
+    if (count <= unsigned(max_leaf)) return node;
+
+    // split along the longest axis of the centres
+    float lo[3] = {1e30f, 1e30f, 1e30f}, hi[3] = {-1e30f, -1e30f, -1e30f};
+    for (unsigned i = first; i < first + count; i++) {
+	for (int k = 0; k < 3; k++) {
+	    lo[k] = std::min(lo[k], centres[3 * order_[i] + k]);
+	    hi[k] = std::max(hi[k], centres[3 * order_[i] + k]);
+	}
+    }
+    int axis = 0;
+    for (int k = 1; k < 3; k++)
+	if (hi[k] - lo[k] > hi[axis] - lo[axis]) axis = k;
+    float extent = hi[axis] - lo[axis];
+
+    auto bin_of = [&](unsigned object) {
+	int b = int((centres[3 * object + axis] - lo[axis]) / extent * num_bins);
+	return std::min(std::max(b, 0), num_bins - 1);
+    };
+
+    unsigned *begin = &order_[first], *end = begin + count, *mid = begin;
+    if (extent > 0.0f && level < max_sah_level) {
+	aabb bin_boxes[num_bins];
+	unsigned bin_counts[num_bins] = {};
+	for (unsigned *o = begin; o != end; o++) {
+	    int b = bin_of(*o);
+	    bin_boxes[b].grow(boxes[*o]);
+	    bin_counts[b]++;
+	}
+
+	// cost of splitting before bin k, the areas of the two sides times their counts
+	float right_area[num_bins] = {};
+	unsigned right_count[num_bins] = {};
+	aabb right;
+	unsigned n = 0;
+	for (int k = num_bins - 1; k > 0; k--) {
+	    right.grow(bin_boxes[k]);
+	    n += bin_counts[k];
+	    right_area[k] = n ? right.area() : 0.0f;
+	    right_count[k] = n;
+	}
+
+	aabb left;
+	unsigned left_count = 0;
+	int best = 0;
+	float best_cost = 1e30f;
+	for (int k = 1; k < num_bins; k++) {
+	    left.grow(bin_boxes[k - 1]);
+	    left_count += bin_counts[k - 1];
+	    if (!left_count || !right_count[k]) continue;
+	    float cost = left.area() * left_count + right_area[k] * right_count[k];
+	    if (cost < best_cost) {
+		best_cost = cost;
+		best = k;
+	    }
+	}
+	if (best)
+	    mid = std::partition(begin, end, [&](unsigned o) { return bin_of(o) < best; });
+    }
+
+    // all centres in one place, or too deep, halve the objects
+    if (mid == begin || mid == end) {
+	mid = begin + count / 2;
+	std::nth_element(begin, mid, end, [&](unsigned a, unsigned b) {
+	    return centres[3 * a + axis] < centres[3 * b + axis];
+	});
+    }
+
+    unsigned left_count = unsigned(mid - begin);
+    build_node(boxes, centres, first, left_count, max_leaf, level + 1);
+    unsigned right = build_node(boxes, centres, first + left_count, count - left_count,
+				max_leaf, level + 1);
+    first_[node] = right;
+    count_[node] = 0;
+    return node;
+}
+
+void
+bvh::refit(const std::vector<aabb> &boxes)
+{
+    boxes_.resize(order_.size());
+
+    // children come after their parents, so backwards every child is done before its parent
+    for (std::size_t i = first_.size(); i-- > 0;) {
+	aabb box;
+	if (count_[i]) {
+	    for (unsigned o = first_[i]; o < first_[i] + count_[i]; o++) {
+		boxes_[o] = boxes[order_[o]];
+		box.grow(boxes_[o]);
+	    }
+	}
+	else {
+	    for (std::size_t child : {i + 1, std::size_t(first_[i])}) {
+		box.grow({{lo_x_[child], lo_y_[child], lo_z_[child]},
+			  {hi_x_[child], hi_y_[child], hi_z_[child]}});
+	    }
+	}
+	lo_x_[i] = box.lo[0];
+	lo_y_[i] = box.lo[1];
+	lo_z_[i] = box.lo[2];
+	hi_x_[i] = box.hi[0];
+	hi_y_[i] = box.hi[1];
+	hi_z_[i] = box.hi[2];
+    }
+}
+
+/*
+ * clip_planes() : test a box against the planes in the mask, false if it is outside one of
+ * them, the planes it is inside of are cleared from the mask
+ *
+ * f, planes : the frustum and the planes to test
+ * lo, hi : corners of the box
+ */
+
+static bool
+clip_planes(const frustum &f, unsigned &planes, const float lo[3], const float hi[3])
+{
+    for (int p = 0; p < 6; p++) {
+	if (!(planes & (1u << p))) continue;
+	const float *pl = f.planes[p];
+
+	// the corners furthest along and furthest against the normal
+	float outer = pl[3], inner = pl[3];
+	for (int k = 0; k < 3; k++) {
+	    outer += pl[k] * (pl[k] > 0.0f ? hi[k] : lo[k]);
+	    inner += pl[k] * (pl[k] > 0.0f ? lo[k] : hi[k]);
+	}
+	if (outer < 0.0f) return false;
+	if (inner >= 0.0f) planes &= ~(1u << p);
+    }
+    return true;
+}
+
+/*
+ * enter_box() : where a ray enters a box, 1e30 if it misses
+ *
+ * origin, inv : the ray, with the reciprocals of its direction, infinite for a zero component
+ * lo, hi : corners of the box
+ */
+
+static float
+enter_box(const float origin[3], const float inv[3], const float lo[3], const float hi[3])
+{
+    float t_in = 0.0f, t_out = 1e30f;
+    for (int k = 0; k < 3; k++) {
+	float t0 = (lo[k] - origin[k]) * inv[k], t1 = (hi[k] - origin[k]) * inv[k];
+
+	// parallel to the slab, inside it or never, the products above are nan or infinite
+	if (std::isinf(inv[k])) {
+	    if (origin[k] < lo[k] || origin[k] > hi[k]) return 1e30f;
+	    continue;
+	}
+	t_in = std::max(t_in, std::min(t0, t1));
+	t_out = std::min(t_out, std::max(t0, t1));
+    }
+    return t_in <= t_out ? t_in : 1e30f;
+}
+
+void
+bvh::cull(const frustum &f, std::vector<unsigned> &visible) const
+{
+    if (first_.empty()) return;
+
+    // planes that still need testing, inside all of them the whole subtree is visible
+    struct entry {
+	unsigned node, planes;
+    };
+    entry stack[max_stack];
+    int top = 0;
+    stack[top++] = {0, (1u << 6) - 1};
+
+    while (top) {
+	entry e = stack[--top];
+	unsigned n = e.node;
+	float lo[3] = {lo_x_[n], lo_y_[n], lo_z_[n]}, hi[3] = {hi_x_[n], hi_y_[n], hi_z_[n]};
+	if (e.planes && !clip_planes(f, e.planes, lo, hi)) continue;
+
+	if (count_[n]) {
+	    for (unsigned o = first_[n]; o < first_[n] + count_[n]; o++) {
+		unsigned planes = e.planes;
+		if (!planes || clip_planes(f, planes, boxes_[o].lo, boxes_[o].hi))
+		    visible.push_back(order_[o]);
+	    }
+	}
+	else {
+	    stack[top++] = {first_[n], e.planes};
+	    stack[top++] = {n + 1, e.planes};
+	}
+    }
+}
+
+long
+bvh::pick(const float origin[3], const float direction[3], float &t) const
+{
+    t = 1e30f;
+    if (first_.empty()) return -1;
+
+    float inv[3];
+    for (int k = 0; k < 3; k++) inv[k] = 1.0f / direction[k];
+    auto enter = [&](unsigned n) {
+	float lo[3] = {lo_x_[n], lo_y_[n], lo_z_[n]}, hi[3] = {hi_x_[n], hi_y_[n], hi_z_[n]};
+	return enter_box(origin, inv, lo, hi);
+    };
+
+    long best = -1;
+    unsigned stack[max_stack];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+	unsigned n = stack[--top];
+	if (enter(n) >= t) continue;
+
+	if (count_[n]) {
+	    for (unsigned o = first_[n]; o < first_[n] + count_[n]; o++) {
+		float at = enter_box(origin, inv, boxes_[o].lo, boxes_[o].hi);
+		if (at < t) {
+		    t = at;
+		    best = long(order_[o]);
+		}
+	    }
+	    continue;
+	}
+
+	// the nearer child goes on top of the stack, the further one is often skipped then
+	unsigned a = n + 1, b = first_[n];
+	float ta = enter(a), tb = enter(b);
+	if (ta > tb) {
+	    std::swap(a, b);
+	    std::swap(ta, tb);
+	}
+	if (tb < t) stack[top++] = b;
+	if (ta < t) stack[top++] = a;
+    }
+    return best;
+}
@@ -0,0 +1,72 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// bvh.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Bounding volume hierarchy over the boxes of scene objects, for culling and picking
+
+#ifndef BVH_H
+#define BVH_H
+
+#include <cstddef>
+#include <vector>
+
+// axis aligned box
+struct aabb {
+    float lo[3] = {1e30f, 1e30f, 1e30f}, hi[3] = {-1e30f, -1e30f, -1e30f};
+
+    void grow(const aabb &b);
+    float area() const;	 // half the surface area, all the surface area heuristic needs
+};
+
+// The six planes of a view volume, a point is inside when a x + b y + c z + d >= 0 for all
+// of them.
+struct frustum {
+    float planes[6][4];
+
+    // from a column major clip matrix, the planes come out in the space the matrix maps from,
+    // after Gribb and Hartmann
+    static frustum from_matrix(const float m[16]);
+
+    // true if the box is at least partly inside
+    bool intersects(const aabb &b) const;
+};
+
+// A flattened bvh. The nodes are in depth first order, the left child of an inner node right
+// after it, so only the right child needs an index, and the boxes are kept as a structure of
+// arrays, one array for each bound, which keeps a traversal on a few cache lines. The build
+// splits the nodes where the surface area heuristic says, among the boundaries of 16 bins of
+// the box centres along the longest axis, and refit() only recomputes the boxes, bottom up,
+// for objects that moved a little.
+
+class bvh {
+   public:
+    // build over boxes, leaves with at most max_leaf objects unless they cannot be split
+    void build(const std::vector<aabb> &boxes, int max_leaf = 4);
+
+    // the same objects, moved, the tree stays as it was built
+    void refit(const std::vector<aabb> &boxes);
+
+    // append the objects whose boxes are at least partly inside f
+    void cull(const frustum &f, std::vector<unsigned> &visible) const;
+
+    // the object whose box the ray enters first, -1 if it hits none, t is where it enters
+    long pick(const float origin[3], const float direction[3], float &t) const;
+
+    std::size_t nodes() const { return first_.size(); }
+    int depth() const { return depth_; }
+
+   private:
+    unsigned build_node(const std::vector<aabb> &boxes, const std::vector<float> &centres,
+			unsigned first, unsigned count, int max_leaf, int level);
+
+    // leaf: objects order_[first_, first_ + count_), inner node: count_ 0, right child first_
+    std::vector<float> lo_x_, lo_y_, lo_z_, hi_x_, hi_y_, hi_z_;
+    std::vector<unsigned> first_, count_;
+
+    // the objects in the order of the leaves, and their boxes in the same order
+    std::vector<unsigned> order_;
+    std::vector<aabb> boxes_;
+    int depth_ = 0;
+};
+
+#endif	// BVH_H
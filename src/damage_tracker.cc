@@ -0,0 +1,33 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	damage_tracker.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Scene damage tracking
+
+#include "damage_tracker.h"
+
+bool
+damage_tracker::begin_frame()
+{
+    // take all pending reasons at once, anything marked after this lands in the next frame
+    unsigned pending = pending_.exchange(0, std::memory_order_acquire);
+
+    if (!pending) {
+	skipped_++;
+	return false;
+    }
+
+    rendered_++;
+    for (int i = 0; i < num_reasons; i++) {
+	if (pending & (1u << i)) reason_counts_[i]++;
+    }
+    return true;
+}
+
+const char *
+damage_tracker::reason_name(int i)
+{
+    static const char *names[num_reasons] = {"resize", "expose", "input", "animation",
+					     "forced", "shaders", "textures"};
+    return (i >= 0 && i < num_reasons) ? names[i] : "unknown";
+}
@@ -0,0 +1,55 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// damage_tracker.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Scene damage tracking, so that the render loop draws only when something has changed
+
+#ifndef DAMAGE_TRACKER_H
+#define DAMAGE_TRACKER_H
+
+#include <atomic>
+
+// Anything that changes what is on the screen marks the tracker dirty with a reason, the render
+// loop asks the tracker at every wakeup whether it has to draw a frame. Marking is lock free,
+// so it is safe to mark from callbacks and other threads.
+
+class damage_tracker {
+   public:
+    // reasons for redrawing, they are bits so that several can be pending at once
+    enum reason : unsigned {
+	resize = 1u << 0,     // framebuffer size changed
+	expose = 1u << 1,     // window contents were lost, e.g. uncovered by another window
+	input = 1u << 2,      // input that changed the scene state
+	animation = 1u << 3,  // animation tick
+	forced = 1u << 4,     // unconditional redraw, e.g. benchmarking
+	shaders = 1u << 5,    // a shader program was rebuilt
+	textures = 1u << 6,   // a streamed texture got another mip level
+    };
+    static constexpr int num_reasons = 7;
+
+    // starts dirty, the first frame always has to be drawn
+    damage_tracker() : pending_(expose) {}
+
+    // mark the scene as needing a redraw
+    void mark_dirty(reason r) { pending_.fetch_or(r, std::memory_order_release); }
+
+    // called at every wakeup of the render loop, returns true if a frame has to be drawn and
+    // clears the pending reasons
+    bool begin_frame();
+
+    // counters
+    unsigned long rendered_frames() const { return rendered_; }
+    unsigned long skipped_frames() const { return skipped_; }
+    // number of rendered frames that had reason i pending, i is the bit index of the reason
+    unsigned long frames_for_reason(int i) const { return reason_counts_[i]; }
+
+    static const char *reason_name(int i);
+
+   private:
+    std::atomic<unsigned> pending_;
+    unsigned long rendered_ = 0;
+    unsigned long skipped_ = 0;
+    unsigned long reason_counts_[num_reasons] = {};
+};
+
+#endif	// DAMAGE_TRACKER_H
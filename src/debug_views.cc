@@ -0,0 +1,268 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	debug_views.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Debug visualization
+
+#include "debug_views.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "gpu_memory.h"
+#include "opengl_stuff.h"
+
+const char *
+debug_view_name(debug_view view)
+{
+    switch (view) {
+	case debug_view::normal:
+	    return "normal";
+	case debug_view::wireframe:
+	    return "wireframe";
+	case debug_view::overdraw:
+	    return "overdraw";
+    }
+    return "unknown";
+}
+
+//
+// overdraw heatmap
+//
+
+// full screen triangle, no vertex data
+static const char *fullscreen_vertex_src =
+    "#version 330 core\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+    "   gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *heatmap_fragment_src =
+    "#version 330 core\n"
+    "uniform sampler2D counts;\n"
+    "out vec4 FragColor;\n"
+    "const vec3 ramp[6] = vec3[6](vec3(0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0),\n"
+    "                             vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0), vec3(1.0));\n"
+    "void main()\n"
+    "{\n"
+    "   float n = texelFetch(counts, ivec2(gl_FragCoord.xy), 0).r * 255.0;\n"
+    "   float t = clamp(n * 5.0 / 8.0, 0.0, 5.0);\n"
+    "   int i = min(int(t), 4);\n"
+    "   FragColor = vec4(mix(ramp[i], ramp[i + 1], t - float(i)), 1.0);\n"
+    "}\n";
+
+overdraw_heatmap::overdraw_heatmap()
+{
+    program_ = build_program(fullscreen_vertex_src, heatmap_fragment_src, "overdraw heatmap");
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "counts"), 0);
+    glUseProgram(0);
+
+    glGenVertexArrays(1, &empty_vao_);
+}
+
+overdraw_heatmap::~overdraw_heatmap()
+{
+    glDeleteVertexArrays(1, &empty_vao_);
+    glDeleteProgram(program_);
+}
+
+void
+overdraw_heatmap::begin(const render_target &counts)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, counts.fbo);
+
+    GLfloat clear_colour[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_colour);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(clear_colour[0], clear_colour[1], clear_colour[2], clear_colour[3]);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+}
+
+void
+overdraw_heatmap::resolve(const render_target &counts)
+{
+    glDisable(GL_BLEND);
+
+    glUseProgram(program_);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, counts.color_tex);
+    glBindVertexArray(empty_vao_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+//
+// text overlay
+//
+
+// 5x7 font, one byte per row from the top, bit 4 is the leftmost pixel
+struct glyph {
+    char c;
+    unsigned char rows[7];
+};
+
+// clang-format off
+static const glyph font[] = {
+    {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+    {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+    {'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+    {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+    {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+    {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+    {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+    {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+    {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+    {'A', {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}},
+    {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+    {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+    {'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+    {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+    {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+    {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+    {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+    {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+    {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+    {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},
+    {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+    {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+    {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+    {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+    {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+    {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+    {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+    {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+    {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+    {'Y', {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}},
+    {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+    {':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},
+    {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}},
+    {'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+    {'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+    {'%', {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}},
+    {'_', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}},
+};
+// clang-format on
+
+static const glyph *
+find_glyph(char c)
+{
+    c = char(std::toupper((unsigned char)c));
+    for (const glyph &g : font) {
+	if (g.c == c) return &g;
+    }
+    return nullptr;
+}
+
+// positions are in pixels from the top left corner
+static const char *overlay_vertex_src =
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 vPos;\n"
+    "uniform vec2 size;\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 p = vPos / size * 2.0 - 1.0;\n"
+    "   gl_Position = vec4(p.x, -p.y, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *overlay_fragment_src =
+    "#version 330 core\n"
+    "uniform vec4 colour;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = colour;\n"
+    "}\n";
+
+debug_overlay::debug_overlay(int scale) : scale_(scale)
+{
+    program_ = build_program(overlay_vertex_src, overlay_fragment_src, "debug overlay");
+    size_loc_ = glGetUniformLocation(program_, "size");
+    colour_loc_ = glGetUniformLocation(program_, "colour");
+
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (void *)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+debug_overlay::~debug_overlay()
+{
+    tracked_delete_buffers(1, &vbo_);
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteProgram(program_);
+}
+
+void
+debug_overlay::add_rect(float x, float y, float w, float h)
+{
+    const GLfloat v[12] = {x, y, x + w, y, x, y + h, x, y + h, x + w, y, x + w, y + h};
+    vertices_.insert(vertices_.end(), v, v + 12);
+}
+
+void
+debug_overlay::draw(const std::vector<std::string> &lines, int width, int height)
+{
+    // character cell is 6x9 font pixels, glyph plus spacing
+    const float px = float(scale_), cell_w = 6 * px, cell_h = 9 * px, margin = 4 * px;
+
+    size_t columns = 0;
+    for (const std::string &line : lines) columns = std::max(columns, line.size());
+
+    // the box behind the text comes first, so that the text is drawn over it
+    vertices_.clear();
+    add_rect(0.0f, 0.0f, columns * cell_w + 2 * margin, lines.size() * cell_h + 2 * margin);
+    size_t box_vertices = vertices_.size() / 2;
+
+    for (size_t l = 0; l < lines.size(); l++) {
+	for (size_t c = 0; c < lines[l].size(); c++) {
+	    const glyph *g = find_glyph(lines[l][c]);
+	    if (!g) continue;
+	    float x0 = margin + c * cell_w, y0 = margin + l * cell_h;
+	    for (int row = 0; row < 7; row++) {
+		for (int col = 0; col < 5; col++) {
+		    if (g->rows[row] & (0x10 >> col))
+			add_rect(x0 + col * px, y0 + row * px, px, px);
+		}
+	    }
+	}
+    }
+
+    tracked_buffer_data(GL_ARRAY_BUFFER, vbo_, vertices_.size() * sizeof(GLfloat),
+			vertices_.data(), GL_STREAM_DRAW, gpu_category::vertices, "overlay");
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(program_);
+    glUniform2f(size_loc_, float(width), float(height));
+    glBindVertexArray(vao_);
+
+    glUniform4f(colour_loc_, 0.0f, 0.0f, 0.0f, 0.6f);
+    glDrawArrays(GL_TRIANGLES, 0, GLsizei(box_vertices));
+    glUniform4f(colour_loc_, 0.9f, 0.9f, 0.9f, 1.0f);
+    glDrawArrays(GL_TRIANGLES, GLsizei(box_vertices),
+		 GLsizei(vertices_.size() / 2 - box_vertices));
+
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+    if (depth_test) glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,73 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// debug_views.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Debug visualization : wireframe, overdraw heatmap and a text overlay for statistics
+
+#ifndef DEBUG_VIEWS_H
+#define DEBUG_VIEWS_H
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+#include "render_target_pool.h"
+
+// how the scene is drawn
+enum class debug_view { normal, wireframe, overdraw };
+
+const char *debug_view_name(debug_view view);
+
+// Overdraw : the scene is drawn with a fragment shader that adds 1/255 with additive blending
+// into a cleared target, so that every texel counts how many fragments landed on it. The
+// heatmap pass then maps the counts to colours, black for none, blue, green, yellow, red and
+// finally white for 8 or more layers.
+
+class overdraw_heatmap {
+   public:
+    // needs the context to be current
+    overdraw_heatmap();
+    ~overdraw_heatmap();
+
+    overdraw_heatmap(const overdraw_heatmap &) = delete;
+    overdraw_heatmap &operator=(const overdraw_heatmap &) = delete;
+
+    // set up the counting target for drawing, blending stays on until resolve()
+    void begin(const render_target &counts);
+
+    // draw the colour mapped counts into the bound framebuffer
+    void resolve(const render_target &counts);
+
+   private:
+    GLuint program_ = 0;
+    GLuint empty_vao_ = 0;
+};
+
+// Text in a built in 5x7 pixel font, drawn as one quad per lit font pixel over a dark box in
+// the top left corner of the window. Lower case is drawn as upper case, unknown characters as
+// blanks. Meant for a handful of lines, the vertices are rebuilt every call.
+
+class debug_overlay {
+   public:
+    // needs the context to be current
+    explicit debug_overlay(int scale = 2);
+    ~debug_overlay();
+
+    debug_overlay(const debug_overlay &) = delete;
+    debug_overlay &operator=(const debug_overlay &) = delete;
+
+    // draw the lines into the bound framebuffer of the given size
+    void draw(const std::vector<std::string> &lines, int width, int height);
+
+   private:
+    void add_rect(float x, float y, float w, float h);
+
+    int scale_;
+    GLuint program_ = 0;
+    GLuint vao_ = 0, vbo_ = 0;
+    GLint size_loc_ = -1, colour_loc_ = -1;
+    std::vector<GLfloat> vertices_;
+};
+
+#endif	// DEBUG_VIEWS_H
@@ -0,0 +1,216 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	depth_buffer.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Depth buffer formats, draw ordering and a fill rate test
+
+#include "depth_buffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "frame_arena.h"
+#include "opengl_stuff.h"
+
+// a full window quad per instance, a 4 vertex strip from the bits of the vertex id, the
+// instances spread over the depth range from first by step
+static const char *fill_vertex_src =
+    "#version 330 core\n"
+    "uniform float first, step;\n"
+    "flat out int layer;\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 p = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;\n"
+    "   layer = gl_InstanceID;\n"
+    "   gl_Position = vec4(p, first + step * float(gl_InstanceID), 1.0);\n"
+    "}\n";
+
+// a hash iterated over and over, so that shading, not blending or bandwidth, is the cost
+static const char *fill_fragment_src =
+    "#version 330 core\n"
+    "uniform int iterations;\n"
+    "flat in int layer;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   float v = float(layer) * 0.1;\n"
+    "   float d = dot(gl_FragCoord.xy * 0.01, vec2(12.9898, 78.233));\n"
+    "   for (int i = 0; i < iterations; i++)\n"
+    "      v = fract(sin(v + d) * 43758.5453);\n"
+    "   FragColor = vec4(v, 0.5 * v, float(layer & 7) / 7.0, 1.0);\n"
+    "}\n";
+
+const char *
+depth_format_name(depth_format format)
+{
+    switch (format) {
+	case depth_format::off:
+	    return "off";
+	case depth_format::d16:
+	    return "16";
+	case depth_format::d24:
+	    return "24";
+	case depth_format::d32f:
+	    return "32f";
+	case depth_format::d24s8:
+	    return "24s8";
+	case depth_format::d32fs8:
+	    return "32fs8";
+    }
+    return "unknown";
+}
+
+depth_format
+parse_depth_format(const std::string &name)
+{
+    for (int i = 0; i < num_depth_formats; i++) {
+	if (name == depth_format_name(depth_format(i))) return depth_format(i);
+    }
+    throw std::runtime_error("unknown depth format " + name +
+			     ", use off, 16, 24, 32f, 24s8 or 32fs8");
+}
+
+GLenum
+depth_internal_format(depth_format format)
+{
+    switch (format) {
+	case depth_format::off:
+	    return 0;
+	case depth_format::d16:
+	    return GL_DEPTH_COMPONENT16;
+	case depth_format::d24:
+	    return GL_DEPTH_COMPONENT24;
+	case depth_format::d32f:
+	    return GL_DEPTH_COMPONENT32F;
+	case depth_format::d24s8:
+	    return GL_DEPTH24_STENCIL8;
+	case depth_format::d32fs8:
+	    return GL_DEPTH32F_STENCIL8;
+    }
+    return 0;
+}
+
+int
+window_depth_bits(depth_format format)
+{
+    switch (format) {
+	case depth_format::off:
+	    return 0;
+	case depth_format::d16:
+	    return 16;
+	default:
+	    return 24;
+    }
+}
+
+int
+window_stencil_bits(depth_format format)
+{
+    return format == depth_format::d24s8 || format == depth_format::d32fs8 ? 8 : 0;
+}
+
+bool
+depth_is_float(depth_format format)
+{
+    return format == depth_format::d32f || format == depth_format::d32fs8;
+}
+
+const char *
+draw_order_name(draw_order order)
+{
+    switch (order) {
+	case draw_order::none:
+	    return "none";
+	case draw_order::front_to_back:
+	    return "front";
+	case draw_order::back_to_front:
+	    return "back";
+    }
+    return "unknown";
+}
+
+draw_order
+parse_draw_order(const std::string &name)
+{
+    if (name == "none") return draw_order::none;
+    if (name == "front") return draw_order::front_to_back;
+    if (name == "back") return draw_order::back_to_front;
+    throw std::runtime_error("unknown draw order " + name + ", use none, front or back");
+}
+
+void
+sort_draws(std::vector<unsigned> &objects, const std::vector<aabb> &boxes,
+	   const float matrix[16], draw_order order)
+{
+    if (order == draw_order::none) {
+	std::sort(objects.begin(), objects.end());
+	return;
+    }
+
+    // the keys once per object, not once per comparison, back to front sorts the negated
+    // depth, and a centre behind the eye goes last either way, the keys are in the frame arena
+    float sign = order == draw_order::front_to_back ? 1.0f : -1.0f;
+    frame_vector<std::pair<float, unsigned>> keys;
+    keys.reserve(objects.size());
+    for (unsigned i : objects) {
+	const aabb &b = boxes[i];
+	float x = 0.5f * (b.lo[0] + b.hi[0]), y = 0.5f * (b.lo[1] + b.hi[1]);
+	float z = 0.5f * (b.lo[2] + b.hi[2]);
+	float cz = matrix[2] * x + matrix[6] * y + matrix[10] * z + matrix[14];
+	float cw = matrix[3] * x + matrix[7] * y + matrix[11] * z + matrix[15];
+	keys.push_back({cw > 0.0f ? sign * cz / cw : 1e30f, i});
+    }
+    std::sort(keys.begin(), keys.end());
+    for (std::size_t k = 0; k < keys.size(); k++) objects[k] = keys[k].second;
+}
+
+fill_test::fill_test(int layers, int iterations)
+    : layers_(std::max(layers, 1)), iterations_(std::max(iterations, 0))
+{
+    program_ = build_program(fill_vertex_src, fill_fragment_src, "fill test");
+    first_loc_ = glGetUniformLocation(program_, "first");
+    step_loc_ = glGetUniformLocation(program_, "step");
+    iterations_loc_ = glGetUniformLocation(program_, "iterations");
+
+    glGenVertexArrays(1, &empty_vao_);
+}
+
+fill_test::~fill_test()
+{
+    glDeleteVertexArrays(1, &empty_vao_);
+    glDeleteProgram(program_);
+}
+
+void
+fill_test::draw(draw_order order, bool prepass)
+{
+    // inside the depth range, nearest at -0.9 and farthest at 0.9 in normalized device
+    // coordinates
+    float step = 1.8f / layers_;
+    bool front_first = order == draw_order::front_to_back;
+
+    glUseProgram(program_);
+    glBindVertexArray(empty_vao_);
+    glUniform1f(first_loc_, front_first ? -0.9f : 0.9f);
+    glUniform1f(step_loc_, front_first ? step : -step);
+
+    // The same program and uniforms in both passes give the same depth, the invariance rules
+    // promise that much, so GL_LEQUAL passes exactly the nearest layer.
+    if (prepass) {
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glUniform1i(iterations_loc_, 0);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, layers_);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_FALSE);
+	glDepthFunc(GL_LEQUAL);
+    }
+
+    glUniform1i(iterations_loc_, iterations_);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, layers_);
+
+    if (prepass) {
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+    }
+}
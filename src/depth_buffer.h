@@ -0,0 +1,80 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// depth_buffer.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Depth buffer formats, front to back ordering of opaque draws, and a fill rate test
+
+#ifndef DEPTH_BUFFER_H
+#define DEPTH_BUFFER_H
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+#include "bvh.h"
+
+// off, 16 and 24 bit fixed point, 32 bit float, and the two with 8 bits of stencil
+enum class depth_format { off, d16, d24, d32f, d24s8, d32fs8 };
+constexpr int num_depth_formats = 6;
+
+const char *depth_format_name(depth_format format);
+depth_format parse_depth_format(const std::string &name);
+
+// internal format of a depth renderbuffer, 0 for off
+GLenum depth_internal_format(depth_format format);
+
+// bits to ask the window system for, a window cannot have float depth, the nearest is 24
+int window_depth_bits(depth_format format);
+int window_stencil_bits(depth_format format);
+
+// float depth only exists offscreen
+bool depth_is_float(depth_format format);
+
+// Opaque draws front to back let the depth test reject the hidden fragments before they are
+// shaded (early z), back to front shades every one of them, as painting without a depth buffer
+// would need, and is here for comparison.
+enum class draw_order { none, front_to_back, back_to_front };
+
+const char *draw_order_name(draw_order order);
+draw_order parse_draw_order(const std::string &name);
+
+// Sort objects by the window depth of the centre of their box, boxes indexed by object, matrix
+// column major to clip space. Ties, and none, go by object index, so that neighbours stay
+// neighbours for multi draws.
+void sort_draws(std::vector<unsigned> &objects, const std::vector<aabb> &boxes,
+		const float matrix[16], draw_order order);
+
+// Full window quads one behind the other, instanced in one draw call, with a fragment shader
+// that is deliberately expensive and does nothing to defeat early z, no discard and no depth
+// writes of its own. Back to front every layer is shaded, front to back only the first one
+// passes the depth test, and with the pre-pass the depth of all of them is laid down first
+// with colour writes off and the cheapest shading, then the colour pass shades each pixel once
+// with depth writes off and GL_LEQUAL. Without a depth buffer every layer is shaded whatever
+// the order.
+
+class fill_test {
+   public:
+    // needs the context to be current, iterations of the shader loop per fragment
+    explicit fill_test(int layers, int iterations = 64);
+    ~fill_test();
+
+    fill_test(const fill_test &) = delete;
+    fill_test &operator=(const fill_test &) = delete;
+
+    // draw into the bound framebuffer, none is the order they were made in, back to front,
+    // depth testing has to be on for the order to matter, the program and vertex array
+    // bindings are changed
+    void draw(draw_order order, bool prepass);
+
+    int layers() const { return layers_; }
+    int iterations() const { return iterations_; }
+
+   private:
+    int layers_, iterations_;
+    GLuint program_ = 0;
+    GLuint empty_vao_ = 0;
+    GLint first_loc_ = -1, step_loc_ = -1, iterations_loc_ = -1;
+};
+
+#endif	// DEPTH_BUFFER_H
@@ -16,14 +16,53 @@
 #include <GL/glew.h>
 // clang-format on
 
+#include "antialiasing.h"
+#include "buffer_heap.h"
+#include "bvh.h"
+#include "damage_tracker.h"
+#include "debug_views.h"
+#include "depth_buffer.h"
+#include "embedded_shaders.h"
+#include "frame_arena.h"
+#include "frame_graph.h"
+#include "frame_pacer.h"
+#include "gpu_culler.h"
+#include "gpu_memory.h"
+#include "gpu_timer.h"
+#include "mesh.h"
+#include "occlusion_culler.h"
 #include "opengl_stuff.h"
+#include "particle_system.h"
+#include "pipeline_stats.h"
+#include "procedural_scene.h"
+#include "render_target_pool.h"
+#include "shader_reload.h"
+#include "shader_variants.h"
+#include "software_culler.h"
+#include "spsc_queue.h"
+#include "texture.h"
+#include "texture_atlas.h"
 
 // graphics library framework : for window functions
 #include <GLFW/glfw3.h>
 // C++ standard headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 // Forward declarations, to be defined later, but used before. It is generally good practise to
 // declare all static functions that a file defines, just before the function they are needed,
@@ -33,9 +72,167 @@
 // callback function, will be set to be called whenever window is resized
 static void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
+// callback function, called when the window contents are lost and have to be redrawn
+static void window_refresh_callback(GLFWwindow *window);
+
+// callback function, called on key presses and releases
+static void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
+
+// callback function, called on mouse button presses and releases
+static void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
+
+// time refits and picks of the bvh of the grid, and print the rates
+static void bvh_benchmark(bvh &tree, const std::vector<aabb> &boxes, std::ostream &out);
+
+// time the software culler rasterizing with and without simd, and testing all the boxes
+static void software_culler_benchmark(software_culler &culler, const std::vector<aabb> &boxes,
+				      std::ostream &out);
+
+// where the glsl files are, cmake points it at the source tree so that edits show up at once
+#ifndef SHADER_DIR
+#define SHADER_DIR "shaders"
+#endif
+
+// where compiled shader variants are kept between runs
+#ifndef SHADER_CACHE_DIR
+#define SHADER_CACHE_DIR "shader-cache"
+#endif
+
+// command line options of the program
+struct app_options {
+    // number of frames to render in the headless benchmark mode, 0 for the interactive mode
+    unsigned long benchmark_frames = 0;
+    // target frame rate while animating, 0 for uncapped
+    double target_fps = 60.0;
+    // vsync mode, adaptive lets late frames tear instead of waiting for the next refresh
+    frame_pacer::vsync_mode vsync = frame_pacer::vsync_mode::adaptive;
+    // draw into an offscreen render target and blit it to the window
+    bool offscreen = false;
+    // anti-aliasing mode, cycled with a at runtime
+    aa_mode aa = aa_mode::off;
+    // benchmark every anti-aliasing mode in turn, benchmark_frames each
+    bool aa_sweep = false;
+    // depth buffer format, off for none, float formats render offscreen
+    depth_format depth = depth_format::d24;
+    // order of the opaque draws, cycled with f at runtime
+    draw_order order = draw_order::front_to_back;
+    // start with a depth pre-pass for the grid and the fill test, toggled with z
+    bool depth_prepass = false;
+    // draw this many full window layers instead of the scene, to measure the fill rate, the
+    // benchmark goes through back to front, front to back and the pre-pass, 0 for the scene
+    int fill_layers = 0;
+    // directory of the glsl files, watched for changes
+    std::string shader_dir = SHADER_DIR;
+    // start with the minified shaders embedded at build time rather than the files
+    bool embedded_shaders = true;
+    // directory of the program binaries of the shader variants, empty for none
+    std::string shader_cache_dir = SHADER_CACHE_DIR;
+    // texture for the pinwheel, a .ppm, .pgm or .ktx2 file or checker, empty for none
+    std::string texture_path;
+    // stream the texture this many KiB a frame, 0 to upload it at once
+    unsigned long texture_stream_kib = 0;
+    // gpu memory budget in MiB, over it the least recently drawn grid textures are evicted,
+    // 0 for none
+    unsigned long gpu_budget_mib = 0;
+    // draw a grid of this many pinwheels, each with a texture of its own, 0 for just the one
+    unsigned long objects = 0;
+    // layers of the grid, one behind the other, the ones behind smaller, so that they hide
+    // behind the first
+    unsigned long layers = 1;
+    // start with occlusion queries culling the hidden pinwheels, toggled with q
+    bool occlusion = false;
+    // start with the cpu culling the hidden pinwheels, toggled with c
+    bool soft_occlusion = false;
+    // start with a compute shader culling the grid and writing its draws, toggled with i
+    bool gpu_culling = false;
+    // start drawing the grid with its textures packed into an atlas, toggled with g
+    bool atlas = false;
+    // magnification of the grid, the pinwheels outside the window are culled, + and - at
+    // runtime
+    float zoom = 1.0f;
+    // cull the grid with its bvh rather than box by box, toggled with b
+    bool bvh = true;
+    // mesh to draw instead of the pinwheel, an .obj file or sphere, empty for none
+    std::string mesh_path;
+    // copies of the mesh, each smaller than the one before, as if further away
+    unsigned long mesh_copies = 16;
+    // pick the coarsest level of detail of the mesh that strays at most this many pixels
+    double lod_error_px = 1.0;
+    // start with the levels of detail on, toggled with l
+    bool lod = true;
+    // generate a scene of this kind to draw instead of the pinwheel, empty for none
+    std::string scene_kind;
+    // its triangles, seed and generating threads, 0 threads for one per core
+    std::uint64_t scene_triangles = 1000000;
+    std::uint32_t scene_seed = 1;
+    int scene_threads = 0;
+    // particles simulated and drawn on the gpu over the scene, 0 for none
+    unsigned long particles = 0;
+    // update them with transform feedback even if there are compute shaders
+    bool particle_feedback = false;
+};
+
+// parse the command line into options, throws on unknown options
+static app_options parse_options(int argc, char *argv[]);
+
+// input events and resize notifications, sent from the main thread to the render thread
+struct app_event {
+    enum event_type { resize, refresh, key, click } type;
+    // resize : width and height, key : key and action, click : cursor position in framebuffer
+    // pixels from the top left
+    int x, y;
+    // when the event arrived, for measuring latency
+    frame_pacer::clock::time_point time;
+};
+
+// state shared between the main thread, with its callbacks, and the render thread, reached
+// through the window user pointer in the callbacks
+struct app_state {
+    // events from the main thread to the render thread
+    spsc_queue<app_event, 1024> events;
+    std::atomic<unsigned long> events_dropped{0};
+
+    // the render thread sleeps on this when it has nothing to draw
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+
+    // set by the main thread to stop the render thread
+    std::atomic<bool> quit{false};
+
+    // set by the shader watcher thread when shader files changed
+    std::atomic<bool> shaders_changed{false};
+
+    // exception that ended the render thread, if any
+    std::exception_ptr render_error;
+};
+
+// the render thread, owner of the opengl context
+static void render_thread_main(GLFWwindow *win, const app_options &opts, app_state &state);
+
+// queue an event for the render thread, called from the callbacks
+static void post_event(app_state &state, const app_event &ev);
+
+// wake the render thread up, after posting an event or asking it to quit
+static void wake_render_thread(app_state &state);
+
+// sleep in the render thread until there are events, timeout in seconds, negative for none
+static void wait_for_events(app_state &state, double timeout);
+
+// lines of the statistics overlay
+static std::vector<std::string> stats_lines(const frame_counters &counters, bool extended,
+					    double cpu_ms, double gpu_ms, debug_view view,
+					    aa_mode aa);
+
+// copies of the pinwheel in layers of grids, texture coordinates in the atlas if there is one,
+// and the boxes of the copies if asked for
+static std::vector<GLfloat> object_grid(const GLfloat *vertices, int count,
+					unsigned long objects, unsigned long layers,
+					const texture_atlas *atlas, std::vector<aabb> *boxes);
+
 /*
  * main() : This is a beginner's snippet, so in order to highlight important parts of the code,
- * we write everything in one behemoth main function.
+ * we write everything in two behemoth functions, main() for the window and its events, and
+ * render_thread_main() for the opengl parts.
  */
 
 int
@@ -61,6 +258,8 @@ main(int argc, char *argv[])
     const int minor_version = 2;
 
     try {
+	const app_options opts = parse_options(argc, argv);
+
 	//
 	// I. glfw stuff
 	//
@@ -91,8 +290,18 @@ main(int argc, char *argv[])
 	// newer versions
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 
-	// require multisampling anti-aliasing (MSAA) 4x, otherwise we have jagged edges
-	// glfwWindowHint(GLFW_SAMPLES, 4);
+	// We do not ask for a multisampled window (GLFW_SAMPLES), the anti-aliasing modes
+	// render offscreen and resolve into the single sampled window, so they can be switched
+	// at runtime and their cost measured.
+
+	// the depth buffer of the window, when we draw into it, offscreen targets get theirs
+	// from the antialiaser
+	glfwWindowHint(GLFW_DEPTH_BITS, window_depth_bits(opts.depth));
+	glfwWindowHint(GLFW_STENCIL_BITS, window_stencil_bits(opts.depth));
+
+	// the benchmark renders into a hidden window, we still need a display connection for
+	// the context though (use Xvfb on machines without one)
+	if (opts.benchmark_frames) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
 	// glfw window creation
 	GLFWwindow *win = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
@@ -102,6 +311,64 @@ main(int argc, char *argv[])
 	    throw std::runtime_error("Failed to create glfw window.");
 	}
 
+	// callbacks run on this (the main) thread and post events to the render thread through
+	// the state
+	app_state state;
+	glfwSetWindowUserPointer(win, &state);
+	glfwSetFramebufferSizeCallback(win, framebuffer_size_callback);
+	glfwSetWindowRefreshCallback(win, window_refresh_callback);
+	glfwSetKeyCallback(win, key_callback);
+	glfwSetMouseButtonCallback(win, mouse_button_callback);
+
+	// the render thread does not know the size of the window, so it gets a resize first
+	int fb_width = 0, fb_height = 0;
+	glfwGetFramebufferSize(win, &fb_width, &fb_height);
+	post_event(state, {app_event::resize, fb_width, fb_height, frame_pacer::clock::now()});
+
+	// The render thread takes over the context and does all the drawing, this thread only
+	// processes window system events, so the window stays responsive however long a frame
+	// takes.
+	std::thread render_thread(render_thread_main, win, std::cref(opts), std::ref(state));
+
+	// event loop, we are not doing realtime here, so we wait for events
+	while (!glfwWindowShouldClose(win)) {
+	    glfwWaitEvents();
+	}
+
+	// stop the render thread and wait for it to release the context
+	state.quit = true;
+	wake_render_thread(state);
+	render_thread.join();
+
+	std::cout << "events_dropped: " << state.events_dropped << std::endl;
+
+	// terminate glfw, clearing all previously allocated GLFW resources
+	glfwTerminate();
+
+	// errors of the render thread are reported like ours
+	if (state.render_error) std::rethrow_exception(state.render_error);
+	return 0;
+    }
+    catch (std::exception &ex) {
+	std::cerr << ex.what() << std::endl;
+	return 1;
+    }
+}
+
+/*
+ * render_thread_main() : the render thread, it owns the opengl context and does everything that
+ * needs it, from initializing glew to deleting the objects at the end. It hears about input and
+ * resizes only through the event queue, so a slow frame never stalls the window system.
+ *
+ * win : window whose context we render into
+ * opts : command line options
+ * state : state shared with the main thread
+ */
+
+static void
+render_thread_main(GLFWwindow *win, const app_options &opts, app_state &state)
+{
+    try {
 	//
 	// II. glew stuff
 	//
@@ -109,13 +376,13 @@ main(int argc, char *argv[])
 	// glew is literal glue between opengl (glvnd and mesa) and glfw (glx and xcb), so the
 	// others need to be initialized before glew is initialized.
 
-	// all opengl functions need a context, glew needs to understand the context
+	// All opengl functions need a context, glew needs to understand the context. The
+	// context belongs to this thread from now on, the main thread never touches it.
 	glfwMakeContextCurrent(win);
 
 	// initialize glew
 	glewExperimental = GL_TRUE;
 	if (glewInit() != GLEW_OK) {
-	    glfwTerminate();
 	    // throw error
 	    throw std::runtime_error("Failed to initialize glew.");
 	}
@@ -129,9 +396,8 @@ main(int argc, char *argv[])
 	// and the opengl version that it provides
 	std::cout << "OpenGL version supported " << version << std::endl;
 
-	// callback uses glViewport, so it can only by set after the context has
-	// been created
-	glfwSetFramebufferSizeCallback(win, framebuffer_size_callback);
+	// every buffer, texture and renderbuffer is recorded with the tracker from here on
+	gpu_memory::get().set_budget(std::size_t(opts.gpu_budget_mib) << 20);
 
 	//
 	// III. shader stuff
@@ -148,124 +414,72 @@ main(int argc, char *argv[])
 	// to specify to draw the triangles. The fragment shader then takes the colour that it
 	// gets from the rasterizer and passes it on to the display hardware.
 
-	// glsl language program for vertex shader
-
-	// pass the input from app to rasterizer
-	const char *vertex_shader_src =
-	    "#version 330 core\n"
-	    "layout (location = 0) in vec3 vPos;\n"
-	    "layout (location = 1) in vec3 vCol;\n"
-	    "out vec4 fCol;\n"
-	    "void main()\n"
-	    "{\n"
-	    "   gl_Position = vec4(vPos.x, vPos.y, vPos.z, 1.0);\n"
-	    "   fCol = vec4(vCol.r, vCol.g, vCol.b, 1.0);\n"
-	    "}\0";
-
-	// glsl language program for fragment shader
-
-	// pass the input from rasterizer to display
-	const char *fragment_shader_src =
-	    "#version 330 core\n"
-	    "in vec4 fCol;\n"
-	    "out vec4 FragColor;\n"
-	    "void main()\n"
-	    "{\n"
-	    "   FragColor = vec4(fCol);\n"
-	    "}\n\0";
-
-	// result of various compilaltion steps
-	GLint result = 1;
-
-	// vertex shader compilation
-	int vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-
-	// check if shader object is created
-	if (!vertex_shader) {
-	    // throw error
-	    throw std::runtime_error("creation of vertex shader object failed.");
-	}
-
-	// specify the shader source and compile
-	glShaderSource(vertex_shader, 1, &vertex_shader_src, nullptr);
-	glCompileShader(vertex_shader);
-
-	// check for shader compile errors
-	glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &result);
-	if (result == GL_FALSE) {
-	    // get compile log length
-	    GLsizei log_sz = 0;
-	    glGetShaderiv(vertex_shader, GL_INFO_LOG_LENGTH, &log_sz);
-
-	    // get compile log
-	    char *info_log = new char[log_sz + 1];
-	    glGetShaderInfoLog(vertex_shader, log_sz, &log_sz, info_log);
-	    std::cerr << "shader compiler :\n" << info_log << std::endl;
-
-	    // throw error
-	    throw std::runtime_error("vertex shader compilation failed.");
-	}
-
-	// fragment shader
-	int fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-	if (!fragment_shader) {
-	    // throw error
-	    throw std::runtime_error("creation of fragment shader object failed.");
-	}
-	glShaderSource(fragment_shader, 1, &fragment_shader_src, nullptr);
-	glCompileShader(fragment_shader);
-
-	// check for shader compile errors
-
-	glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &result);
-	if (result == GL_FALSE) {
-	    // get compile log length
-	    GLsizei log_sz = 0;
-	    glGetShaderiv(fragment_shader, GL_INFO_LOG_LENGTH, &log_sz);
-
-	    // get compile log
-	    char *info_log = new char[log_sz + 1];
-	    glGetShaderInfoLog(fragment_shader, log_sz, &log_sz, info_log);
-	    std::cerr << "shader compiler :\n" << info_log << std::endl;
-
-	    // throw error
-	    throw std::runtime_error("fragment shader compilation failed.");
-	}
-
-	// link shaders
-	int shader_program = glCreateProgram();
-	if (!shader_program) {
-	    // throw error
-	    throw std::runtime_error("creation  of shader program object failed");
-	}
-
-	// specify the shader objects
-	glAttachShader(shader_program, vertex_shader);
-	glAttachShader(shader_program, fragment_shader);
-
-	// link the shader objects
-	glLinkProgram(shader_program);
-
-	// detach and delete shader objects
-	glDetachShader(shader_program, vertex_shader);
-	glDetachShader(shader_program, fragment_shader);
-	glDeleteShader(vertex_shader);
-	glDeleteShader(fragment_shader);
-
-	// check for linking errors
-	glGetProgramiv(shader_program, GL_LINK_STATUS, &result);
-	if (result == GL_FALSE) {
-	    // get link log length
-	    GLsizei log_sz = 0;
-	    glGetProgramiv(shader_program, GL_INFO_LOG_LENGTH, &log_sz);
-
-	    // get link log
-	    char *info_log = new char[log_sz + 1];
-	    glGetShaderInfoLog(shader_program, log_sz, &log_sz, info_log);
-	    std::cerr << "shader compiler :\n" << info_log << std::endl;
-
-	    // throw error
-	    throw std::runtime_error("shader program linking failed.");
+	// The glsl sources live in files, scene.vert and scene.frag in the shader directory, so
+	// that they can be edited while the program runs. A watcher thread notices when they
+	// are saved, and we rebuild the programs between frames, keeping the old ones if the
+	// new sources do not compile. The build validates the files with glslang and embeds a
+	// minified copy, which is what we compile at startup, unless --shaders points us at
+	// another directory.
+	const char *vertex_text =
+	    opts.embedded_shaders ? find_embedded_shader("scene.vert") : nullptr;
+	const char *fragment_text =
+	    opts.embedded_shaders ? find_embedded_shader("scene.frag") : nullptr;
+
+	// The debug views need slightly different shaders, so the files are compiled into
+	// variants, one for every combination of the feature flags that we use, on first use.
+	// The uniforms are the rotation of the pinwheel in radians, and where a copy of the
+	// mesh goes.
+	shader_variants scene(
+	    "scene",
+	    {{GL_VERTEX_SHADER, opts.shader_dir + "/scene.vert", vertex_text},
+	     {GL_FRAGMENT_SHADER, opts.shader_dir + "/scene.frag", fragment_text}},
+	    {"OVERDRAW", "WIREFRAME", "TEXTURED", "TEX_COORDS", "ATLAS"},
+	    {"angle", "placement"}, opts.shader_cache_dir);
+	enum scene_feature : unsigned {
+	    overdraw_feature = 1u << 0,
+	    wireframe_feature = 1u << 1,
+	    textured_feature = 1u << 2,
+	    tex_coords_feature = 1u << 3,
+	    atlas_feature = 1u << 4,
+	};
+	enum scene_uniform { angle_uniform, placement_uniform };
+
+	// the plain variant is needed right away, and if it does not compile nothing will
+	scene.get(0);
+
+	// tells us when shader files change, from a thread of its own
+	shader_watcher watcher(opts.shader_dir, [&state] {
+	    state.shaders_changed = true;
+	    wake_render_thread(state);
+	});
+
+	// The texture, if we have one, is either uploaded right away, timed up to the moment
+	// the gpu has it, or streamed a few mip levels a frame, coarsest first. Either way its
+	// storage is allocated up front, so the memory it costs is known at once.
+	std::unique_ptr<texture> tex;
+	std::unique_ptr<texture_streamer> streamer;
+	double texture_upload_ms = 0.0;
+	if (!opts.texture_path.empty()) {
+	    auto data = std::make_shared<texture_data>(
+		opts.texture_path == "checker" ? checker_texture(1024, 16)
+					       : load_texture_file(opts.texture_path));
+	    tex = std::make_unique<texture>(*data);
+
+	    if (opts.texture_stream_kib) {
+		// streaming needs every level up front, the gpu cannot generate missing ones
+		build_mip_chain(*data);
+		streamer = std::make_unique<texture_streamer>(opts.texture_stream_kib * 1024);
+		streamer->stream(*tex, data);
+	    }
+	    else {
+		glFinish();
+		auto start = std::chrono::steady_clock::now();
+		tex->upload(*data);
+		glFinish();
+		texture_upload_ms = std::chrono::duration<double, std::milli>(
+					std::chrono::steady_clock::now() - start)
+					.count();
+	    }
 	}
 
 	//
@@ -330,8 +544,8 @@ main(int argc, char *argv[])
 	// bind the Vertex Array Object first, then bind and set vertex buffer(s),
 	// and then configure vertex attributes(s).
 	glBindVertexArray(vao);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	tracked_buffer_data(GL_ARRAY_BUFFER, vbo, sizeof(vertices), vertices, GL_STATIC_DRAW,
+			    gpu_category::vertices, "pinwheel");
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat),
 			      (void *)(0 * sizeof(GLfloat)));
@@ -353,77 +567,1201 @@ main(int argc, char *argv[])
 	// unbind VAOs (nor VBOs) when it's not directly necessary.
 	glBindVertexArray(0);
 
+	// The --objects grid, copies of the pinwheel with a checker texture each, of a size and
+	// a pattern of its own, up to 256 different ones. Drawn as is, every pinwheel needs a
+	// texture binding and a draw call of its own. With the textures packed into an atlas
+	// the whole grid takes one binding and one draw call, the second vertex buffer has the
+	// texture coordinates in the atlas, and the layer, at location 2. The boxes of the
+	// pinwheels go into a bvh, for culling the ones outside the window, and for picking.
+	// With --layers the grid is repeated further and further back, depth tested, and the
+	// pinwheels behind the first layer can be culled with occlusion queries, or on the cpu
+	// with the first layer rasterized as occluders, for which we keep the positions. An
+	// element buffer of the indices of a pinwheel, 0 to count - 1, is in both vertex
+	// arrays, for drawing a pinwheel as indexed, with its first vertex as the base vertex,
+	// as the draws the gpu culler writes do.
+	std::vector<texture_data> object_images;
+	std::vector<std::unique_ptr<texture>> object_textures;
+	std::unique_ptr<texture_atlas> atlas;
+	GLuint object_vbos[2] = {}, object_vaos[2] = {}, object_ibo = 0;
+	std::vector<aabb> object_boxes;
+	std::vector<float> object_positions;
+	bvh objects_bvh;
+	double bvh_build_ms = 0.0;
+	if (opts.objects) {
+	    for (unsigned long i = 0; i < std::min(opts.objects, 256ul); i++) {
+		object_images.push_back(checker_texture(32 << (i % 4), 2 + int(i % 7)));
+		object_textures.push_back(
+		    std::make_unique<texture>(object_images.back(), "grid_texture"));
+		object_textures.back()->upload(object_images.back());
+		object_textures.back()->set_streamable(true);
+	    }
+
+	    std::vector<const texture_data *> images;
+	    for (const texture_data &image : object_images) images.push_back(&image);
+	    atlas = std::make_unique<texture_atlas>(images);
+
+	    std::vector<GLuint> indices(num_triangles * 3);
+	    for (std::size_t v = 0; v < indices.size(); v++) indices[v] = GLuint(v);
+
+	    glGenVertexArrays(2, object_vaos);
+	    glGenBuffers(2, object_vbos);
+	    glGenBuffers(1, &object_ibo);
+	    for (int i = 0; i < 2; i++) {
+		const texture_atlas *coords = i ? atlas.get() : nullptr;
+		std::vector<aabb> *boxes = i ? nullptr : &object_boxes;
+		std::vector<GLfloat> grid = object_grid(
+		    vertices, num_triangles * 3, opts.objects, opts.layers, coords, boxes);
+		glBindVertexArray(object_vaos[i]);
+		if (i)
+		    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object_ibo);
+		else
+		    tracked_buffer_data(GL_ELEMENT_ARRAY_BUFFER, object_ibo,
+					indices.size() * sizeof(GLuint), indices.data(),
+					GL_STATIC_DRAW, gpu_category::indices, "grid");
+		tracked_buffer_data(GL_ARRAY_BUFFER, object_vbos[i],
+				    grid.size() * sizeof(GLfloat), grid.data(), GL_STATIC_DRAW,
+				    gpu_category::vertices, "grid");
+		for (std::size_t v = 0; !i && v < grid.size(); v += 9)
+		    object_positions.insert(object_positions.end(), &grid[v], &grid[v] + 3);
+		for (int a = 0; a < 3; a++) {
+		    glVertexAttribPointer(a, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(GLfloat),
+					  (void *)(3 * a * sizeof(GLfloat)));
+		    glEnableVertexAttribArray(a);
+		}
+	    }
+	    glBindBuffer(GL_ARRAY_BUFFER, 0);
+	    glBindVertexArray(0);
+
+	    auto start = std::chrono::steady_clock::now();
+	    objects_bvh.build(object_boxes);
+	    bvh_build_ms = std::chrono::duration<double, std::milli>(
+			       std::chrono::steady_clock::now() - start)
+			       .count();
+	}
+
+	// The --mesh, in place of the pinwheel, with its levels of detail built right after
+	// it is loaded, all in one range of the geometry heap, the vertices and then the
+	// indices, drawn with the base vertex of the range. Its copies get smaller and smaller,
+	// row by row, as if further and further away, and each draws the coarsest level that
+	// strays less than --lod-error pixels from the finest at its size on the screen.
+	mesh scene_mesh;
+	std::vector<float> mesh_placements;
+	const std::size_t mesh_stride = 6 * sizeof(GLfloat);
+	buffer_heap geometry(std::size_t(64) << 20, gpu_category::vertices, "geometry");
+	buffer_heap::handle mesh_range = buffer_heap::no_handle;
+	std::size_t mesh_vertex_bytes = 0;
+	GLuint mesh_vao = 0;
+	double lod_build_ms = 0.0;
+	if (!opts.mesh_path.empty()) {
+	    scene_mesh = opts.mesh_path == "sphere" ? sphere_mesh(256, 512)
+						    : load_obj(opts.mesh_path);
+	    auto start = std::chrono::steady_clock::now();
+	    build_lods(scene_mesh);
+	    lod_build_ms = std::chrono::duration<double, std::milli>(
+			       std::chrono::steady_clock::now() - start)
+			       .count();
+
+	    // x and y of the centre, and the scale, of each copy in a square grid
+	    unsigned long columns =
+		(unsigned long)std::ceil(std::sqrt(double(opts.mesh_copies)));
+	    float cell = 2.0f / columns;
+	    for (unsigned long i = 0; i < opts.mesh_copies; i++) {
+		mesh_placements.insert(mesh_placements.end(),
+				       {-1.0f + cell * (i % columns + 0.5f),
+					1.0f - cell * (i / columns + 0.5f),
+					0.45f * cell * std::pow(0.85f, float(i))});
+	    }
+
+	    // the range starts at a whole vertex, and the indices after the vertices start at
+	    // a multiple of 4 bytes as well
+	    mesh_vertex_bytes = scene_mesh.vertices.size() * sizeof(GLfloat);
+	    std::size_t index_bytes = scene_mesh.indices.size() * sizeof(GLuint);
+	    mesh_range = geometry.allocate(mesh_vertex_bytes + index_bytes, mesh_stride);
+	    geometry.upload(mesh_range, scene_mesh.vertices.data(), mesh_vertex_bytes);
+	    geometry.upload(mesh_range, scene_mesh.indices.data(), index_bytes,
+			    mesh_vertex_bytes);
+
+	    // one VAO for the block of the heap, whatever meshes it holds
+	    glGenVertexArrays(1, &mesh_vao);
+	    glBindVertexArray(mesh_vao);
+	    glBindBuffer(GL_ARRAY_BUFFER, geometry.buffer(mesh_range));
+	    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, mesh_stride,
+				  (void *)(0 * sizeof(GLfloat)));
+	    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, mesh_stride,
+				  (void *)(3 * sizeof(GLfloat)));
+	    glEnableVertexAttribArray(0);
+	    glEnableVertexAttribArray(1);
+
+	    // the element buffer binding is part of the VAO, unlike the array buffer binding
+	    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry.buffer(mesh_range));
+	    glBindVertexArray(0);
+	    glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// The generated --scene, in place of the pinwheel, all of it in one draw call, spun and
+	// zoomed like the grid.
+	std::unique_ptr<procedural_scene> generated;
+	if (!opts.scene_kind.empty()) {
+	    scene_params params;
+	    params.kind = parse_scene_kind(opts.scene_kind);
+	    params.triangles = opts.scene_triangles;
+	    params.seed = opts.scene_seed;
+	    params.threads = opts.scene_threads;
+	    generated = std::make_unique<procedural_scene>(params);
+	}
+
+	// The --particles, a fountain over whatever is drawn, simulated and drawn on the gpu.
+	std::unique_ptr<particle_system> particles;
+	if (opts.particles)
+	    particles =
+		std::make_unique<particle_system>(opts.particles, !opts.particle_feedback);
+
 	//
 	// V. Rendering
 	//
 
-	// uncomment this call to draw in wireframe polygons.
-	// glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	// debug views, w draws in wireframe polygons, o shows the overdraw heatmap and s the
+	// statistics overlay
+	debug_view view = debug_view::normal;
+	bool show_stats = false;
+
+	// the pinwheel is textured if there is a texture, the grid always is, the mesh and the
+	// generated scene never, toggled with t
+	const bool texturable = (tex || opts.objects) && !mesh_vao && !generated;
+	bool textured = texturable;
+
+	// the grid draws from the atlas, toggled with g
+	bool use_atlas = opts.atlas && atlas;
+	unsigned long object_frames[2] = {}, object_binds[2] = {};
+
+	// a grid texture evicted by the gpu memory budget is uploaded again from its image when
+	// a pinwheel drawn with it is visible
+	unsigned long object_restores = 0;
+	auto bind_object_texture = [&](unsigned i) {
+	    texture &t = *object_textures[i % object_textures.size()];
+	    if (!t.resident()) {
+		t.restore(object_images[i % object_textures.size()]);
+		object_restores++;
+	    }
+	    t.mark_used();
+	    glBindTexture(GL_TEXTURE_2D, t.id());
+	    object_binds[0]++;
+	};
+
+	// The grid is magnified around the origin by zoom, on top of the spin. Culling is with
+	// the bvh or box by box, toggled with b, and a click picks the pinwheel under the
+	// cursor, which is outlined.
+	float zoom = opts.zoom;
+	bool use_bvh = opts.bvh;
+	long picked = -1;
+	// the lists of a frame keep their capacity from frame to frame
+	std::vector<unsigned> visible;
+	std::vector<GLint> run_firsts;
+	std::vector<GLsizei> run_counts;
+	visible.reserve(object_boxes.size());
+	run_firsts.reserve(object_boxes.size());
+	run_counts.reserve(object_boxes.size());
+	unsigned long cull_frames[2] = {}, picks = 0;
+	double cull_ms[2] = {}, visible_total[2] = {}, pick_ms = 0.0;
+
+	// the pinwheels hidden behind others are culled by occlusion queries, toggled with q
+	std::unique_ptr<occlusion_culler> occlusion;
+	if (opts.objects) occlusion = std::make_unique<occlusion_culler>();
+	bool use_occlusion = opts.occlusion && occlusion;
+
+	// or by a compute shader, against the view volume and the depth of the frame before,
+	// which writes the draws of the visible ones, drawn with one call, toggled with i. It
+	// stands in for the other cullers, the frame times are kept per culling : none,
+	// occlusion queries, and the gpu culler.
+	std::unique_ptr<gpu_culler> gpu_cull;
+	if (opts.objects && gpu_culler::supported()) {
+	    gpu_cull = std::make_unique<gpu_culler>();
+	    const GLuint count = num_triangles * 3;
+	    std::vector<gpu_culler::draw_command> draws;
+	    draws.reserve(object_boxes.size());
+	    for (std::size_t i = 0; i < object_boxes.size(); i++)
+		draws.push_back({count, 0, 0, GLint(i * count), 0});
+	    gpu_cull->set_objects(object_boxes, draws);
+	}
+	else if (opts.gpu_culling) {
+	    std::cerr << "gpu culling needs OpenGL 4.3, culling on the cpu" << std::endl;
+	}
+	bool use_gpu_cull = opts.gpu_culling && gpu_cull;
+	unsigned long occlusion_frames[3] = {}, occlusion_gpu_samples[3] = {};
+	double occlusion_cpu_ms[3] = {}, occlusion_gpu_ms[3] = {};
+
+	// or on the cpu, the first layer pinwheels that cover at least min_occluder_area pixels
+	// of its depth buffer are the occluders, at most max_occluders of them, toggled with c
+	std::unique_ptr<software_culler> soft_culler;
+	if (opts.objects) soft_culler = std::make_unique<software_culler>();
+	bool use_soft_occlusion = opts.soft_occlusion && soft_culler;
+	const float min_occluder_area = 16.0f;
+	const std::size_t max_occluders = 256;
+
+	// Opaque draws go front to back, so that early z skips shading what is hidden, cycled
+	// with f, after a depth pre-pass if wanted, toggled with z. The fill test draws instead
+	// of the scene, its gpu times are kept per mode : back to front, front to back, and
+	// front to back with the pre-pass.
+	const bool use_depth = opts.depth != depth_format::off;
+	draw_order order = opts.order;
+	bool use_prepass = opts.depth_prepass;
+	std::unique_ptr<fill_test> fill;
+	if (opts.fill_layers) fill = std::make_unique<fill_test>(opts.fill_layers);
+	const char *fill_mode_names[3] = {"back", "front", "prepass"};
+	unsigned long fill_frames[3] = {}, fill_gpu_samples[3] = {};
+	double fill_gpu_ms[3] = {};
+
+	// the mesh draws its levels of detail, toggled with l
+	bool use_lod = opts.lod;
+	unsigned long lod_frames[2] = {};
+	double lod_triangles[2] = {}, lod_cpu_ms[2] = {};
 
 	// sap green background
 	glClearColor(0.0f, 0.0f, 0.07f, 0.0f);
 
-	// Value 0 is for no vsync, and 1 for vsync, it is integral value of required number of
-	// display refreshes before we swap. Doesn't matter as we are not drawing realtime.
-	glfwSwapInterval(0);
+	// The pacer decides when animation frames are due, and sets the swap interval. Value 0
+	// is for no vsync, and 1 for vsync, it is integral value of required number of display
+	// refreshes before we swap, -1 is adaptive vsync. The benchmark is never paced.
+	frame_pacer pacer(opts.benchmark_frames ? 0.0 : opts.target_fps);
+	pacer.apply_swap_interval(opts.benchmark_frames ? frame_pacer::vsync_mode::off
+							: opts.vsync);
+
+	// offscreen render targets, they have to go before the context does
+	render_target_pool targets;
+
+	// anti-aliasing, with our depth buffer
+	antialiaser aa(opts.aa);
+	aa.set_depth_format(depth_internal_format(opts.depth));
+
+	// the passes of a frame, with their targets from the pool
+	frame_graph graph(targets);
+
+	// gpu time of a frame, tagged with the anti-aliasing mode it was drawn with
+	gpu_timer frame_timer;
+	double last_gpu_ms = 0.0;
+
+	// debug views and pipeline statistics of the scene
+	overdraw_heatmap heatmap;
+	debug_overlay overlay;
+	pipeline_stats stats;
+	double last_cpu_ms = 0.0;
+
+	// cost of each anti-aliasing mode
+	unsigned long aa_frames[num_aa_modes] = {}, aa_gpu_samples[num_aa_modes] = {};
+	double aa_cpu_ms[num_aa_modes] = {}, aa_gpu_ms[num_aa_modes] = {};
+
+	// framebuffer size, all resize events of a wakeup are applied at once
+	int fb_width = 0, fb_height = 0;
+	unsigned long resize_events = 0, resizes_applied = 0;
+
+	// frame cpu time statistics, that is the time we spend submitting a frame, not the time
+	// the gpu spends drawing it, nor the swap and the events. The whole frame, from the
+	// start of one to the start of the next, is kept apart as the frame interval.
+	using frame_clock = std::chrono::steady_clock;
+	using millis = std::chrono::duration<double, std::milli>;
+	unsigned long frames = 0, intervals = 0;
+	double frame_ms_total = 0.0, frame_ms_min = 1e30, frame_ms_max = 0.0;
+	double interval_ms_total = 0.0, interval_ms_min = 1e30, interval_ms_max = 0.0;
+	frame_clock::time_point last_frame_start;
+
+	// The temporaries of a frame are in the frame arena, reset when the frame is done. The
+	// heap allocations of each drawn frame are counted, those of the first frames apart, as
+	// the containers that live across frames grow to their size then.
+	frame_arena &frame = frame_arena::local();
+	const unsigned long warmup_frames = 10;
+	unsigned long heap_warmup = 0, heap_steady = 0, heap_max = 0, heap_frames = 0;
+
+	// what needs redrawing
+	damage_tracker damage;
+
+	// spin the pinwheel, toggled with space
+	bool animate = false;
+
+	// rotation of the pinwheel, advanced with the wall clock only while animating
+	const float spin_speed = 1.0f;	// radians per second
+	float angle = 0.0f;
+	double last_tick = glfwGetTime();
+
+	// seconds the particles have to catch up on, the benchmark steps them 1/60 a frame
+	float particle_dt = 0.0f;
+
+	// time of the oldest input that changed the scene but is not on the screen yet
+	frame_pacer::clock::time_point pending_input;
 
 	// render loop
-	while (!glfwWindowShouldClose(win)) {
-	    // render
-
-	    // foremost we clear the screen, otherwise it is tricky to redraw only the changed
-	    // parts of the screen
-	    glClear(GL_COLOR_BUFFER_BIT);
-
-	    // specify the program to draw the triangle
-	    glUseProgram(shader_program);
+	while (!state.quit) {
+	    // Every wakeup, be it an event or an animation tick, comes here, but we draw only
+	    // if something marked the scene dirty. A static scene under a moving mouse costs
+	    // nothing.
+
+	    // drain the events the main thread queued up since the last wakeup
+	    app_event ev;
+	    bool resized = false;
+	    while (state.events.pop(ev)) {
+		switch (ev.type) {
+		    case app_event::resize:
+			// only the last size counts, a live resize sends us lots of them
+			fb_width = ev.x;
+			fb_height = ev.y;
+			resized = true;
+			resize_events++;
+			break;
+		    case app_event::refresh:
+			damage.mark_dirty(damage_tracker::expose);
+			break;
+		    case app_event::click: {
+			if (!opts.objects || !fb_width || !fb_height) break;
+
+			// back through the zoom and the spin, then straight into the screen
+			float x = (2.0f * ev.x + 1.0f) / fb_width - 1.0f;
+			float y = 1.0f - (2.0f * ev.y + 1.0f) / fb_height;
+			float c = std::cos(angle), s = std::sin(angle);
+			float origin[3] = {(c * x + s * y) / zoom, (c * y - s * x) / zoom,
+					   -1.0f};
+			float direction[3] = {0.0f, 0.0f, 1.0f}, t;
+
+			auto start = frame_clock::now();
+			picked = objects_bvh.pick(origin, direction, t);
+			pick_ms += millis(frame_clock::now() - start).count();
+			picks++;
+
+			if (picked >= 0)
+			    std::cout << "picked object " << picked << std::endl;
+			else
+			    std::cout << "picked nothing" << std::endl;
+			damage.mark_dirty(damage_tracker::input);
+			if (pending_input == frame_pacer::clock::time_point())
+			    pending_input = ev.time;
+			break;
+		    }
+		    case app_event::key: {
+			if (ev.y != GLFW_PRESS) break;
+
+			bool changed = true;
+			switch (ev.x) {
+			    case GLFW_KEY_SPACE:
+				// start or stop spinning
+				animate = !animate;
+				break;
+			    case GLFW_KEY_A:
+				// next anti-aliasing mode
+				aa.set_mode(aa_mode((int(aa.mode()) + 1) % num_aa_modes));
+				std::cout << "anti-aliasing: " << aa_mode_name(aa.mode())
+					  << std::endl;
+				break;
+			    case GLFW_KEY_W:
+				view = view == debug_view::wireframe ? debug_view::normal
+								     : debug_view::wireframe;
+				break;
+			    case GLFW_KEY_O:
+				view = view == debug_view::overdraw ? debug_view::normal
+								    : debug_view::overdraw;
+				break;
+			    case GLFW_KEY_S:
+				show_stats = !show_stats;
+				break;
+			    case GLFW_KEY_T:
+				textured = !textured && texturable;
+				break;
+			    case GLFW_KEY_G:
+				use_atlas = !use_atlas && atlas;
+				break;
+			    case GLFW_KEY_L:
+				use_lod = !use_lod;
+				break;
+			    case GLFW_KEY_B:
+				use_bvh = !use_bvh;
+				break;
+			    case GLFW_KEY_Q:
+				use_occlusion = !use_occlusion && occlusion;
+				if (use_occlusion) occlusion->reset();
+				break;
+			    case GLFW_KEY_C:
+				use_soft_occlusion = !use_soft_occlusion && soft_culler;
+				break;
+			    case GLFW_KEY_I:
+				use_gpu_cull = !use_gpu_cull && gpu_cull;
+				if (use_gpu_cull) gpu_cull->reset();
+				break;
+			    case GLFW_KEY_F:
+				order = draw_order((int(order) + 1) % 3);
+				std::cout << "draw order: " << draw_order_name(order)
+					  << std::endl;
+				break;
+			    case GLFW_KEY_Z:
+				use_prepass = !use_prepass;
+				break;
+			    case GLFW_KEY_EQUAL:
+				zoom *= 2.0f;
+				break;
+			    case GLFW_KEY_MINUS:
+				zoom = std::max(zoom * 0.5f, 1.0f / 64.0f);
+				break;
+			    default:
+				changed = false;
+				break;
+			}
+
+			if (changed) {
+			    damage.mark_dirty(damage_tracker::input);
+			    if (pending_input == frame_pacer::clock::time_point())
+				pending_input = ev.time;
+			}
+			break;
+		    }
+		}
+	    }
+
+	    if (resized) {
+		// make sure the viewport matches the new window dimensions, note that width and
+		// height will be significantly larger than specified on retina displays. The
+		// render targets follow at the next acquire, mostly from the same size bucket.
+		glViewport(0, 0, fb_width, fb_height);
+		damage.mark_dirty(damage_tracker::resize);
+		resizes_applied++;
+	    }
+
+	    // start rebuilding the variants if their files were saved, once for all the files
+	    if (state.shaders_changed.exchange(false)) {
+		std::vector<std::string> files = watcher.take_changes();
+		if (std::any_of(files.begin(), files.end(),
+				[&scene](const std::string &file) { return scene.uses(file); }))
+		    scene.reload();
+	    }
+
+	    // swap in the rebuilt variants that are done compiling
+	    if (scene.update()) {
+		damage.mark_dirty(damage_tracker::shaders);
+		std::cout << "reloaded scene shaders" << std::endl;
+	    }
+
+	    // animation ticks come only when the pacer says the next frame is due
+	    double now = glfwGetTime();
+	    if (!animate) {
+		last_tick = now;
+	    }
+	    else if (pacer.frame_due()) {
+		angle += float(now - last_tick) * spin_speed;
+		particle_dt += float(now - last_tick);
+		last_tick = now;
+		damage.mark_dirty(damage_tracker::animation);
+	    }
+
+	    // benchmark frames are always drawn
+	    if (opts.benchmark_frames) damage.mark_dirty(damage_tracker::forced);
+
+	    // a streamed texture gets sharper every frame until it is complete
+	    if (streamer && streamer->busy()) damage.mark_dirty(damage_tracker::textures);
+
+	    if (damage.begin_frame()) {
+		pacer.begin_frame();
+		auto frame_start = frame_clock::now();
+		unsigned long heap_start = heap_allocations();
+		if (frames) {
+		    double interval_ms = millis(frame_start - last_frame_start).count();
+		    intervals++;
+		    interval_ms_total += interval_ms;
+		    interval_ms_min = std::min(interval_ms_min, interval_ms);
+		    interval_ms_max = std::max(interval_ms_max, interval_ms);
+		}
+		last_frame_start = frame_start;
+
+		// render
+
+		// the sweep benchmarks each mode for benchmark_frames frames
+		if (opts.aa_sweep) {
+		    unsigned long m = std::min<unsigned long>(frames / opts.benchmark_frames,
+							      num_aa_modes - 1);
+		    aa.set_mode(aa_mode(m));
+		}
+		// and the fill test each of its modes
+		if (fill && opts.benchmark_frames) {
+		    unsigned long m =
+			std::min<unsigned long>(frames / opts.benchmark_frames, 2);
+		    order = m ? draw_order::front_to_back : draw_order::back_to_front;
+		    use_prepass = m == 2;
+		}
+		int fill_mode = use_prepass ? 2 : order == draw_order::front_to_back ? 1 : 0;
+
+		// gpu time for the anti-aliasing mode, and the fill mode or the culling, the
+		// gpu culler only draws the grid untextured or from the atlas
+		int aa_index = int(aa.mode());
+		const bool gpu_culled = use_gpu_cull && (!textured || use_atlas);
+		const int cull_mode = gpu_culled ? 2 : int(use_occlusion);
+		frame_timer.begin(aa_index | (fill ? fill_mode : cull_mode) << 8);
+
+		// The frame is a graph of passes, declared here and run by graph.execute().
+		// The scene goes into the target the anti-aliasing mode wants, or the window
+		// itself if it is off. An offscreen target has at least the size of the window,
+		// the viewport covers only the part the window needs.
+		graph.begin();
+		frame_graph::resource window = graph.import("window", 0);
+		frame_graph::resource scene_target =
+		    aa.wants_target(opts.offscreen)
+			? graph.create("scene", aa.scene_desc(fb_width, fb_height))
+			: window;
+
+		// The overdraw view draws the scene with the counting variant into a target of
+		// its own, and maps the counts to colours in the scene framebuffer afterwards.
+		// Otherwise the scene goes straight into the scene framebuffer, in lines for
+		// the wireframe view.
+		frame_graph::resource counts = -1;
+		if (view == debug_view::overdraw) {
+		    render_target_desc desc;
+		    desc.width = fb_width;
+		    desc.height = fb_height;
+		    desc.name = "overdraw";
+		    counts = graph.create("overdraw", desc);
+		}
+
+		unsigned features = 0;
+		if (view == debug_view::overdraw) features |= overdraw_feature;
+		if (view == debug_view::wireframe) features |= wireframe_feature;
+		if (textured) features |= textured_feature;
+		if (textured && opts.objects) features |= tex_coords_feature;
+		if (textured && use_atlas) features |= atlas_feature;
+
+		// A variant that does not compile, after an edit, sends us back to the normal
+		// view, whose variant compiled at the start. Its error is printed once, the
+		// variants remember it until the files change.
+		const shader_variants::variant *program = nullptr;
+		const bool known_failure = scene.failed(features);
+		try {
+		    program = &scene.get(features);
+		}
+		catch (const std::exception &e) {
+		    if (!known_failure) std::cerr << e.what() << std::endl;
+		    view = debug_view::normal;
+		    program = &scene.get(0);
+		}
+
+		graph.add_pass("scene", {}, {counts >= 0 ? counts : scene_target}, [&] {
+		    if (counts >= 0) {
+			heatmap.begin(graph.target(counts));
+		    }
+		    else {
+			glBindFramebuffer(GL_FRAMEBUFFER, graph.fbo(scene_target));
+
+			// foremost we clear the screen, otherwise it is tricky to redraw only
+			// the changed parts of the screen, and the depth buffer if there is one
+			glClear(GL_COLOR_BUFFER_BIT | (use_depth ? GL_DEPTH_BUFFER_BIT : 0));
+		    }
+		    if (view == debug_view::wireframe)
+			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+		    // the particles move on first, on the gpu, outside the pipeline statistics
+		    if (particles) {
+			particles->update(opts.benchmark_frames ? 1.0f / 60.0f : particle_dt);
+			particle_dt = 0.0f;
+		    }
+
+		    stats.begin();
+
+		    // the next mip levels of a streamed texture, before we sample it
+		    if (streamer) streamer->update();
+
+		    // specify the program to draw the triangle
+		    glUseProgram(program->program->id());
+		    glUniform1f(program->uniforms[angle_uniform], angle);
+
+		    // the sampler uniform is 0 by default, which is where the texture goes
+		    glActiveTexture(GL_TEXTURE0);
+
+		    // no depth buffer for the overdraw counts, the test passes everything
+		    if (use_depth) glEnable(GL_DEPTH_TEST);
+
+		    if (fill) {
+			fill->draw(order, use_prepass);
+			fill_frames[fill_mode]++;
+		    }
+		    else if (generated) {
+			glUniform3f(program->uniforms[placement_uniform], 0.0f, 0.0f, zoom);
+			generated->draw();
+			stats.count_draw();
+		    }
+		    else if (mesh_vao) {
+			// The copies of the mesh, with the level of detail for their size on
+			// the screen, where a unit of the mesh spans scale times half the
+			// window. The triangles facing away are culled before they reach the
+			// depth test. The vertex shader passes z through, so the viewer looks
+			// down +z and the faces wound counter-clockwise from outside come out
+			// clockwise on the screen, the front face is clockwise for the mesh.
+			double half_window = 0.5 * std::max(fb_width, fb_height);
+			GLint base_vertex = GLint(geometry.offset(mesh_range) / mesh_stride);
+			std::size_t indices_at =
+			    geometry.offset(mesh_range) + mesh_vertex_bytes;
+			glEnable(GL_CULL_FACE);
+			glFrontFace(GL_CW);
+			glBindVertexArray(mesh_vao);
+			for (std::size_t i = 0; i < mesh_placements.size(); i += 3) {
+			    const float *place = &mesh_placements[i];
+			    std::size_t lod =
+				use_lod ? select_lod(scene_mesh, place[2] * half_window,
+						     opts.lod_error_px)
+					: 0;
+			    const mesh_lod &level = scene_mesh.lods[lod];
+			    glUniform3f(program->uniforms[placement_uniform], place[0],
+					place[1], place[2]);
+			    glDrawElementsBaseVertex(
+				GL_TRIANGLES, level.index_count, GL_UNSIGNED_INT,
+				(void *)(indices_at + level.first_index * sizeof(GLuint)),
+				base_vertex);
+			    stats.count_draw();
+			    lod_triangles[use_lod] += level.index_count / 3;
+			}
+			glFrontFace(GL_CCW);
+			glDisable(GL_CULL_FACE);
+			lod_frames[use_lod]++;
+		    }
+		    else if (opts.objects) {
+			// The pinwheels inside the view volume, of the matrix that the vertex
+			// shader applies, column by column.
+			float c = std::cos(angle) * zoom, s = std::sin(angle) * zoom;
+			const float view_matrix[16] = {c, s, 0, 0, -s, c, 0, 0,
+						       0, 0, 1, 0, 0, 0, 0, 1};
+			frustum view_volume = frustum::from_matrix(view_matrix);
+
+			int count = num_triangles * 3;
+			if (gpu_culled) {
+			    // The compute shader culls the grid and writes the draws of the
+			    // visible pinwheels, drawn with one call, and they are drawn again
+			    // into its depth pyramid, for culling the next frame.
+			    glBindVertexArray(object_vaos[use_atlas]);
+			    glUniform3f(program->uniforms[placement_uniform], 0.0f, 0.0f, zoom);
+			    gpu_cull->cull(view_matrix);
+			    if (textured) {
+				glBindTexture(GL_TEXTURE_2D_ARRAY, atlas->id());
+				object_binds[1]++;
+			    }
+			    gpu_cull->draw();
+			    stats.count_draw();
+			    gpu_cull->update_depth(fb_width, fb_height);
+			}
+			else {
+			    auto cull_start = frame_clock::now();
+			    visible.clear();
+			    if (use_bvh) {
+				objects_bvh.cull(view_volume, visible);
+			    }
+			    else {
+				for (unsigned i = 0; i < object_boxes.size(); i++)
+				    if (view_volume.intersects(object_boxes[i]))
+					visible.push_back(i);
+			    }
+			    cull_ms[use_bvh] += millis(frame_clock::now() - cull_start).count();
+			    visible_total[use_bvh] += visible.size();
+			    cull_frames[use_bvh]++;
+
+			    // the pinwheels hidden behind the first layer, culled on the cpu
+			    if (use_soft_occlusion) {
+				soft_culler->begin(view_matrix);
+				std::size_t occluders = 0;
+				for (unsigned i : visible) {
+				    if (i >= opts.objects || occluders == max_occluders ||
+					soft_culler->screen_area(object_boxes[i]) <
+					    min_occluder_area)
+					continue;
+				    const float *p =
+					&object_positions[std::size_t(i) * count * 3];
+				    soft_culler->add_occluder(p, num_triangles);
+				    occluders++;
+				}
+				soft_culler->rasterize();
+				soft_culler->cull(visible, object_boxes);
+			    }
+
+			    // In draw order, which leaves the pinwheels of a layer in index
+			    // order, so that the runs of the atlas stay long.
+			    sort_draws(visible, object_boxes, view_matrix, order);
+
+			    // The depth of the grid first, with the plain variant and colour
+			    // writes off, gl_Position is invariant, so the depth is the same in
+			    // every variant. The colour pass then shades each pixel once,
+			    // at equal depth. Not under the occlusion queries, which would then
+			    // see everything.
+			    glBindVertexArray(object_vaos[use_atlas]);
+			    const bool prepass = use_prepass && use_depth && !use_occlusion &&
+						 view == debug_view::normal;
+			    if (prepass) {
+				const shader_variants::variant &plain = scene.get(0);
+				glUseProgram(plain.program->id());
+				glUniform1f(plain.uniforms[angle_uniform], angle);
+				glUniform3f(plain.uniforms[placement_uniform], 0.0f, 0.0f,
+					    zoom);
+				glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+				for (unsigned i : visible) {
+				    glDrawArrays(GL_TRIANGLES, GLint(i * count), count);
+				    stats.count_draw();
+				}
+				glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+				glDepthMask(GL_FALSE);
+				glDepthFunc(GL_LEQUAL);
+				glUseProgram(program->program->id());
+			    }
+
+			    // the grid, a binding and a draw call per pinwheel, or one of each
+			    // for all, a glMultiDrawArrays for the runs of neighbouring
+			    // pinwheels
+			    glUniform3f(program->uniforms[placement_uniform], 0.0f, 0.0f, zoom);
+			    if (use_occlusion) {
+				// a draw call per pinwheel, each inside its occlusion query
+				if (textured && use_atlas) {
+				    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas->id());
+				    object_binds[1]++;
+				}
+				auto draw_object = [&](unsigned i) {
+				    if (textured && !use_atlas) bind_object_texture(i);
+				    glDrawArrays(GL_TRIANGLES, GLint(i * count), count);
+				    stats.count_draw();
+				};
+				occlusion->draw(visible, object_boxes, view_matrix,
+						std::ref(draw_object));
+			    }
+			    else if (use_atlas) {
+				run_firsts.clear();
+				run_counts.clear();
+				for (std::size_t i = 0; i < visible.size(); i++) {
+				    if (i && visible[i] == visible[i - 1] + 1) {
+					run_counts.back() += count;
+					continue;
+				    }
+				    run_firsts.push_back(GLint(visible[i] * count));
+				    run_counts.push_back(count);
+				}
+
+				if (textured) {
+				    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas->id());
+				    object_binds[1]++;
+				}
+				glMultiDrawArrays(GL_TRIANGLES, run_firsts.data(),
+						  run_counts.data(),
+						  GLsizei(run_firsts.size()));
+				stats.count_draw();
+			    }
+			    else {
+				for (unsigned i : visible) {
+				    if (textured) bind_object_texture(i);
+				    glDrawArrays(GL_TRIANGLES, GLint(i * count), count);
+				    stats.count_draw();
+				}
+			    }
+			    if (prepass) {
+				glDepthMask(GL_TRUE);
+				glDepthFunc(GL_LESS);
+			    }
+			}
+			glDisable(GL_DEPTH_TEST);
+			object_frames[use_atlas]++;
+			occlusion_frames[cull_mode]++;
+
+			// the picked pinwheel again, outlined, over whatever is in front of it
+			const shader_variants::variant *outline = nullptr;
+			if (picked >= 0 && view == debug_view::normal) {
+			    try {
+				outline = &scene.get(wireframe_feature);
+			    }
+			    catch (const std::exception &e) {
+				std::cerr << e.what() << std::endl;
+				picked = -1;
+			    }
+			}
+			if (outline) {
+			    glUseProgram(outline->program->id());
+			    glUniform1f(outline->uniforms[angle_uniform], angle);
+			    glUniform3f(outline->uniforms[placement_uniform], 0.0f, 0.0f, zoom);
+			    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+			    glDrawArrays(GL_TRIANGLES, GLint(picked * count), count);
+			    stats.count_draw();
+			}
+		    }
+		    else {
+			if (textured) glBindTexture(GL_TEXTURE_2D, tex->id());
+
+			// seeing as we only have a single VAO (vertex array object) there's no
+			// need to bind it every time, but we'll do so to keep things a bit more
+			// organized
+			glBindVertexArray(vao);
+
+			// draw our triangles
+
+			// set the count to 12 since we're drawing 12 vertices now (4
+			// triangles); not 4! it reads that array contains triangles and 12
+			// vertices starting from 0
+			glDrawArrays(GL_TRIANGLES, 0, num_triangles * 3);
+			stats.count_draw();
+		    }
+
+		    glDisable(GL_DEPTH_TEST);
+
+		    // the particles over it all, not into the overdraw counts
+		    if (particles && counts < 0) {
+			particles->draw(fb_width, fb_height);
+			stats.count_draw();
+		    }
+
+		    // no need to unuse program everytime
+		    // glUseProgram(0);
+
+		    // no need to unbind it every time
+		    // glBindVertexArray(0);
+
+		    stats.end();
+		    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		});
+
+		if (counts >= 0) {
+		    graph.add_pass("heatmap", {counts}, {scene_target}, [&] {
+			glBindFramebuffer(GL_FRAMEBUFFER, graph.fbo(scene_target));
+			heatmap.resolve(graph.target(counts));
+		    });
+		}
+
+		// Resolve or filter the offscreen image into the window, through a single
+		// sampled copy if the window cannot take the multisampled one. The copy lives
+		// after the overdraw counts are done with, so it gets their target.
+		if (scene_target != window) {
+		    frame_graph::resource shown = scene_target;
+		    if (aa.needs_resolve()) {
+			shown = graph.create("resolved", aa.resolve_desc(fb_width, fb_height));
+			graph.add_pass("resolve", {scene_target}, {shown}, [&, shown] {
+			    aa.resolve(graph.target(scene_target), graph.target(shown));
+			});
+		    }
+		    graph.add_pass("present", {shown}, {window},
+				   [&, shown] { aa.present(graph.target(shown)); });
+		}
+
+		// the overlay goes into the window after anti-aliasing, the numbers are those
+		// of the latest frame the gpu has finished
+		if (show_stats) {
+		    graph.add_pass("overlay", {}, {window}, [&] {
+			overlay.draw(stats_lines(stats.latest(), stats.extended(), last_cpu_ms,
+						 last_gpu_ms, view, aa.mode()),
+				     fb_width, fb_height);
+		    });
+		}
+
+		graph.execute();
+		targets.end_frame();
+		gpu_memory::get().end_frame();
+		if (particles) particles->end_frame();
+		frame_timer.end();
+
+		double frame_ms = millis(frame_clock::now() - frame_start).count();
+		last_cpu_ms = frame_ms;
+		frames++;
+		frame_ms_total += frame_ms;
+		frame_ms_min = std::min(frame_ms_min, frame_ms);
+		frame_ms_max = std::max(frame_ms_max, frame_ms);
+		aa_frames[aa_index]++;
+		aa_cpu_ms[aa_index] += frame_ms;
+		if (mesh_vao) lod_cpu_ms[use_lod] += frame_ms;
+		if (opts.objects) occlusion_cpu_ms[cull_mode] += frame_ms;
+
+		// swap buffers, a skipped frame is not swapped either, the front buffer still
+		// has the last frame we drew
+		glfwSwapBuffers(win);
+
+		// the frame is presented (as far as we can tell), check its deadline and the
+		// latency of the input it shows
+		pacer.end_frame(pending_input);
+		pending_input = frame_pacer::clock::time_point();
+
+		frame.reset();
+		unsigned long heap_frame = heap_allocations() - heap_start;
+		if (frames <= warmup_frames) {
+		    heap_warmup += heap_frame;
+		}
+		else {
+		    heap_steady += heap_frame;
+		    heap_max = std::max(heap_max, heap_frame);
+		    if (heap_frame) heap_frames++;
+		}
+	    }
+
+	    // gpu times and pipeline statistics of earlier frames, whichever are done by now,
+	    // whether the overlay shows them or not
+	    stats.collect();
+	    double gpu_ms = 0.0;
+	    int gpu_tag = 0;
+	    while (frame_timer.poll(gpu_ms, gpu_tag)) {
+		aa_gpu_ms[gpu_tag & 0xff] += gpu_ms;
+		aa_gpu_samples[gpu_tag & 0xff]++;
+		if (fill) {
+		    fill_gpu_ms[gpu_tag >> 8] += gpu_ms;
+		    fill_gpu_samples[gpu_tag >> 8]++;
+		}
+		else {
+		    occlusion_gpu_ms[gpu_tag >> 8] += gpu_ms;
+		    occlusion_gpu_samples[gpu_tag >> 8]++;
+		}
+		last_gpu_ms = gpu_ms;
+	    }
+
+	    // The main thread polls the window system, we only wait for what it sends us. When
+	    // benchmarking we want to draw frames back to back, when animating we sleep until
+	    // the next frame is due (events still wake us up), otherwise we sleep until
+	    // something happens. A program still compiling in the background is polled every
+	    // few milliseconds, a streamed texture gets its levels at the animation frame rate.
+
+	    if (opts.benchmark_frames) {
+		unsigned long sweeps = opts.aa_sweep ? num_aa_modes : fill ? 3 : 1;
+		if (frames >= opts.benchmark_frames * sweeps) break;
+	    }
+	    else if (scene.rebuilding()) {
+		wait_for_events(state, animate ? std::min(pacer.seconds_until_due(), 0.005)
+					       : 0.005);
+	    }
+	    else if (animate || (streamer && streamer->busy())) {
+		wait_for_events(state, pacer.seconds_until_due());
+	    }
+	    else {
+		wait_for_events(state, -1.0);
+	    }
+	}
 
-	    // seeing as we only have a single VAO (vertex array object) there's no need to bind
-	    // it every time, but we'll do so to keep things a bit more organized
-	    glBindVertexArray(vao);
+	// collect the gpu times still in flight
+	glFinish();
+	double gpu_ms = 0.0;
+	int gpu_tag = 0;
+	while (frame_timer.poll(gpu_ms, gpu_tag)) {
+	    aa_gpu_ms[gpu_tag & 0xff] += gpu_ms;
+	    aa_gpu_samples[gpu_tag & 0xff]++;
+	    if (fill) {
+		fill_gpu_ms[gpu_tag >> 8] += gpu_ms;
+		fill_gpu_samples[gpu_tag >> 8]++;
+	    }
+	    else {
+		occlusion_gpu_ms[gpu_tag >> 8] += gpu_ms;
+		occlusion_gpu_samples[gpu_tag >> 8]++;
+	    }
+	}
 
-	    // draw our triangles
+	// good practice: de-allocate all resources once they've outlived their purposei,
+	// the programs delete themselves
+	glDeleteVertexArrays(1, &vao);
+	tracked_delete_buffers(1, &vbo);
+	glDeleteVertexArrays(2, object_vaos);
+	tracked_delete_buffers(2, object_vbos);
+	tracked_delete_buffers(1, &object_ibo);
+	glDeleteVertexArrays(1, &mesh_vao);
+
+	// report frame cpu times, one line per stat so that scripts can grep them
+	if (opts.benchmark_frames && frames) {
+	    std::cout << "frames: " << frames << std::endl;
+	    std::cout << "frame_cpu_ms_mean: " << frame_ms_total / frames << std::endl;
+	    std::cout << "frame_cpu_ms_min: " << frame_ms_min << std::endl;
+	    std::cout << "frame_cpu_ms_max: " << frame_ms_max << std::endl;
+	    if (intervals) {
+		std::cout << "frame_interval_ms_mean: " << interval_ms_total / intervals
+			  << std::endl;
+		std::cout << "frame_interval_ms_min: " << interval_ms_min << std::endl;
+		std::cout << "frame_interval_ms_max: " << interval_ms_max << std::endl;
+	    }
+
+	    // heap allocations of the first frames, and per frame after them
+	    std::cout << "frame_heap_allocations_warmup: " << heap_warmup << std::endl;
+	    if (frames > warmup_frames) {
+		std::cout << "frame_heap_allocations_per_frame: "
+			  << double(heap_steady) / (frames - warmup_frames) << std::endl;
+		std::cout << "frame_heap_allocations_max: " << heap_max << std::endl;
+		std::cout << "frame_heap_allocating_frames: " << heap_frames << std::endl;
+	    }
+	    frame.report(std::cout);
+	}
 
-	    // set the count to 12 since we're drawing 12 vertices now (4 triangles);
-	    // not 4! it reads that array contains triangles and 12 vertices starting from 0
-	    glDrawArrays(GL_TRIANGLES, 0, num_triangles * 3);
+	// report how many wakeups were drawn and how many were skipped
+	std::cout << "frames_rendered: " << damage.rendered_frames() << std::endl;
+	std::cout << "frames_skipped: " << damage.skipped_frames() << std::endl;
+	for (int i = 0; i < damage_tracker::num_reasons; i++) {
+	    std::cout << "frames_damaged_by_" << damage_tracker::reason_name(i) << ": "
+		      << damage.frames_for_reason(i) << std::endl;
+	}
 
-	    // no need to unuse program everytime
-	    // glUseProgram(0);
+	// report deadlines missed and input latency
+	pacer.report(std::cout);
+
+	// report the cost of each anti-aliasing mode that drew frames, gpu times only if the
+	// context has timer queries
+	for (int i = 0; i < num_aa_modes; i++) {
+	    if (!aa_frames[i]) continue;
+	    std::string name = std::string("aa_") + aa_mode_name(aa_mode(i));
+	    std::cout << name << "_frames: " << aa_frames[i] << std::endl;
+	    std::cout << name << "_cpu_ms_mean: " << aa_cpu_ms[i] / aa_frames[i] << std::endl;
+	    if (aa_gpu_samples[i])
+		std::cout << name << "_gpu_ms_mean: " << aa_gpu_ms[i] / aa_gpu_samples[i]
+			  << std::endl;
+	}
 
-	    // no need to unbind it every time
-	    // glBindVertexArray(0);
+	// report the pipeline statistics of the last frame
+	const frame_counters &counters = stats.latest();
+	std::cout << "stats_draw_calls: " << counters.draw_calls << std::endl;
+	std::cout << "stats_primitives_generated: " << counters.primitives_generated
+		  << std::endl;
+	if (stats.extended()) {
+	    std::cout << "stats_vertex_invocations: " << counters.vertex_invocations
+		      << std::endl;
+	    std::cout << "stats_clipping_output: " << counters.clipping_output << std::endl;
+	    std::cout << "stats_fragment_invocations: " << counters.fragment_invocations
+		      << std::endl;
+	}
 
-	    // swap buffers and poll IO events (keys pressed/released, mouse moved
-	    // etc.)
-	    glfwSwapBuffers(win);
+	// report resizes and render target allocations
+	std::cout << "resize_events: " << resize_events << std::endl;
+	std::cout << "resizes_applied: " << resizes_applied << std::endl;
+	targets.report(std::cout);
+	gpu_memory::get().report(std::cout);
+
+	// report the passes, the transient memory aliasing saved, and the gpu time of each pass
+	graph.report(std::cout);
+
+	// report the shader variants, and the rebuilds, failed ones kept the old program
+	scene.report(std::cout);
+	std::cout << "shader_reloads: " << scene.reloads() << std::endl;
+	std::cout << "shader_reload_failures: " << scene.failures() << std::endl;
+
+	// report the texture, its memory and how fast it went up
+	if (tex) {
+	    std::cout << "texture_width: " << tex->width() << std::endl;
+	    std::cout << "texture_height: " << tex->height() << std::endl;
+	    std::cout << "texture_levels: " << tex->levels() << std::endl;
+	    std::cout << "texture_immutable: " << tex->immutable() << std::endl;
+	    std::cout << "texture_bytes: " << tex->bytes() << std::endl;
+	    if (texture_upload_ms > 0.0) {
+		std::cout << "texture_upload_ms: " << texture_upload_ms << std::endl;
+		std::cout << "texture_upload_mb_per_s: "
+			  << tex->bytes() / 1048576.0 / (texture_upload_ms * 1e-3) << std::endl;
+	    }
+	}
+	if (streamer) streamer->report(std::cout);
+
+	// report how well the atlas is packed, and the texture bindings it saves a frame
+	if (atlas) {
+	    std::cout << "objects: " << opts.objects << std::endl;
+	    atlas->report(std::cout);
+	    double binds[2] = {};
+	    for (int i = 0; i < 2; i++) {
+		if (!object_frames[i]) continue;
+		binds[i] = double(object_binds[i]) / object_frames[i];
+		std::cout << (i ? "objects_atlas_binds_per_frame: "
+				: "objects_binds_per_frame: ")
+			  << binds[i] << std::endl;
+	    }
+	    if (binds[0] > 0.0 && binds[1] > 0.0)
+		std::cout << "objects_bind_reduction: " << binds[0] / binds[1] << std::endl;
+	}
+	if (opts.objects && gpu_memory::get().budget())
+	    std::cout << "objects_texture_restores: " << object_restores << std::endl;
+
+	// report the bvh, the culling cost with and without it, and when benchmarking how
+	// fast it refits and answers picks
+	if (opts.objects) {
+	    std::cout << "bvh_nodes: " << objects_bvh.nodes() << std::endl;
+	    std::cout << "bvh_depth: " << objects_bvh.depth() << std::endl;
+	    std::cout << "bvh_build_ms: " << bvh_build_ms << std::endl;
+	    for (int i = 0; i < 2; i++) {
+		if (!cull_frames[i]) continue;
+		const char *name = i ? "cull_bvh_" : "cull_linear_";
+		std::cout << name << "ms_mean: " << cull_ms[i] / cull_frames[i] << std::endl;
+		std::cout << name << "visible_mean: " << visible_total[i] / cull_frames[i]
+			  << std::endl;
+	    }
+	    if (picks) std::cout << "pick_ms_mean: " << pick_ms / picks << std::endl;
+	    if (opts.benchmark_frames) bvh_benchmark(objects_bvh, object_boxes, std::cout);
+	}
 
-	    // Either we poll for the events (immediately returns) or we wait for the events
-	    // (waits), we are not doing realtime so we wait.
+	// report what the cpu culled, and how fast, and when benchmarking how much simd buys
+	if (soft_culler) {
+	    soft_culler->report(std::cout);
+	    if (opts.benchmark_frames)
+		software_culler_benchmark(*soft_culler, object_boxes, std::cout);
+	}
 
-	    glfwWaitEvents();
-	    // glfwPollEvents();
+	// report the pinwheels the occlusion queries and the gpu culler culled, and the frame
+	// times with each culling
+	if (occlusion) {
+	    std::cout << "object_layers: " << opts.layers << std::endl;
+	    occlusion->report(std::cout);
+	    if (gpu_cull) gpu_cull->report(std::cout);
+	    const char *names[3] = {"occlusion_off_", "occlusion_on_", "gpu_culling_"};
+	    for (int i = 0; i < 3; i++) {
+		if (!occlusion_frames[i]) continue;
+		const char *name = names[i];
+		std::cout << name << "frames: " << occlusion_frames[i] << std::endl;
+		std::cout << name << "frame_cpu_ms_mean: "
+			  << occlusion_cpu_ms[i] / occlusion_frames[i] << std::endl;
+		if (occlusion_gpu_samples[i])
+		    std::cout << name << "frame_gpu_ms_mean: "
+			      << occlusion_gpu_ms[i] / occlusion_gpu_samples[i] << std::endl;
+	    }
+	}
 
-	    // process input
-	    if (glfwGetKey(win, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-		glfwSetWindowShouldClose(win, true);
+	// report the depth buffer and the draw order, and the fill rate of each fill mode, in
+	// layer pixels shaded or rejected a second
+	std::cout << "depth_format: " << depth_format_name(opts.depth) << std::endl;
+	std::cout << "depth_order: " << draw_order_name(order) << std::endl;
+	std::cout << "depth_prepass: " << use_prepass << std::endl;
+	if (fill) {
+	    std::cout << "fill_layers: " << fill->layers() << std::endl;
+	    std::cout << "fill_iterations: " << fill->iterations() << std::endl;
+	    double pixels = double(fill->layers()) * fb_width * fb_height, ms[3] = {};
+	    for (int i = 0; i < 3; i++) {
+		if (!fill_frames[i]) continue;
+		std::string name = std::string("fill_") + fill_mode_names[i];
+		std::cout << name << "_frames: " << fill_frames[i] << std::endl;
+		if (!fill_gpu_samples[i]) continue;
+		ms[i] = fill_gpu_ms[i] / fill_gpu_samples[i];
+		std::cout << name << "_gpu_ms_mean: " << ms[i] << std::endl;
+		std::cout << name << "_mpixels_per_s: " << pixels / ms[i] * 1e-3 << std::endl;
+	    }
+	    if (ms[0] > 0.0 && ms[1] > 0.0)
+		std::cout << "fill_front_speedup: " << ms[0] / ms[1] << std::endl;
+	    if (ms[0] > 0.0 && ms[2] > 0.0)
+		std::cout << "fill_prepass_speedup: " << ms[0] / ms[2] << std::endl;
 	}
 
-	// good practice: de-allocate all resources once they've outlived their purposei,
-	// shaders are deleted beforehand
-	glDeleteVertexArrays(1, &vao);
-	glDeleteBuffers(1, &vbo);
-	glDeleteProgram(shader_program);
+	// report the generated scene, its size and how fast it was made
+	if (generated) generated->report(std::cout);
+
+	// report the particles, and how many a second the gpu updated and drew
+	if (particles) particles->report(std::cout);
+
+	// report the levels of detail, and the triangles and frame times with and without them
+	if (mesh_vao) {
+	    std::cout << "mesh_copies: " << opts.mesh_copies << std::endl;
+	    std::cout << "mesh_lods: " << scene_mesh.lods.size() << std::endl;
+	    std::cout << "mesh_lod_build_ms: " << lod_build_ms << std::endl;
+	    geometry.report(std::cout);
+	    for (std::size_t i = 0; i < scene_mesh.lods.size(); i++) {
+		std::cout << "mesh_lod_" << i << "_triangles: " << scene_mesh.triangles(i)
+			  << std::endl;
+		std::cout << "mesh_lod_" << i << "_error: " << scene_mesh.lods[i].error
+			  << std::endl;
+	    }
+	    for (int i = 0; i < 2; i++) {
+		if (!lod_frames[i]) continue;
+		const char *name = i ? "mesh_lod_on_" : "mesh_lod_off_";
+		std::cout << name << "frames: " << lod_frames[i] << std::endl;
+		std::cout << name << "triangles_per_frame: " << lod_triangles[i] / lod_frames[i]
+			  << std::endl;
+		std::cout << name << "frame_cpu_ms_mean: " << lod_cpu_ms[i] / lod_frames[i]
+			  << std::endl;
+	    }
+	}
 
-	// terminate glfw, clearing all previously allocated GLFW resources
-	glfwTerminate();
 	check_glerror(__FILE__, __LINE__);
-	return 0;
     }
-    catch (std::exception &ex) {
-	std::cerr << ex.what() << std::endl;
-	return 1;
+    catch (...) {
+	// handed over to the main thread, which rethrows it after joining us
+	state.render_error = std::current_exception();
     }
+
+    // release the context, glfw destroys it with the window in the main thread
+    glfwMakeContextCurrent(nullptr);
+
+    // the main thread may be sleeping in glfwWaitEvents, tell it that we are done
+    glfwSetWindowShouldClose(win, true);
+    glfwPostEmptyEvent();
 }
 
 /*
@@ -437,9 +1775,443 @@ main(int argc, char *argv[])
 static void
 framebuffer_size_callback(GLFWwindow *win, int wid, int hgt)
 {
-    // make sure the viewport matches the new window dimensions;
+    // we have no context on this thread, the render thread sets the viewport
+    app_state *state = static_cast<app_state *>(glfwGetWindowUserPointer(win));
+    post_event(*state, {app_event::resize, wid, hgt, frame_pacer::clock::now()});
+}
 
-    // note that width and height will be significantly larger than specified on retina
-    // displays.
-    glViewport(0, 0, wid, hgt);
+/*
+ * window_refresh_callback() : the system lost the contents of the window, e.g. it was
+ * uncovered, and wants us to redraw
+ *
+ * win : window that made the callback call
+ */
+
+static void
+window_refresh_callback(GLFWwindow *win)
+{
+    app_state *state = static_cast<app_state *>(glfwGetWindowUserPointer(win));
+    post_event(*state, {app_event::refresh, 0, 0, frame_pacer::clock::now()});
+}
+
+/*
+ * key_callback() : keyboard input, quitting is handled right here, everything else goes to the
+ * render thread, which decides whether the key changes the scene
+ *
+ * win : window that made the callback call
+ * key, scancode, action, mods : which key, and whether it was pressed, released or repeated
+ */
+
+static void
+key_callback(GLFWwindow *win, int key, int scancode, int action, int mods)
+{
+    app_state *state = static_cast<app_state *>(glfwGetWindowUserPointer(win));
+
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
+	glfwSetWindowShouldClose(win, true);
+	return;
+    }
+    post_event(*state, {app_event::key, key, action, frame_pacer::clock::now()});
+}
+
+/*
+ * mouse_button_callback() : a press of the left button picks, the render thread gets where
+ * the cursor was, in framebuffer pixels, which are not window pixels on retina displays
+ *
+ * win : window that made the callback call
+ * button, action, mods : which button, and whether it was pressed or released
+ */
+
+static void
+mouse_button_callback(GLFWwindow *win, int button, int action, int mods)
+{
+    if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS) return;
+
+    app_state *state = static_cast<app_state *>(glfwGetWindowUserPointer(win));
+    double x, y;
+    int win_width, win_height, fb_width, fb_height;
+    glfwGetCursorPos(win, &x, &y);
+    glfwGetWindowSize(win, &win_width, &win_height);
+    glfwGetFramebufferSize(win, &fb_width, &fb_height);
+    if (!win_width || !win_height) return;
+
+    post_event(*state, {app_event::click, int(x * fb_width / win_width),
+			int(y * fb_height / win_height), frame_pacer::clock::now()});
+}
+
+/*
+ * post_event() : queue an event for the render thread and wake it up, called on the main thread
+ * only, as the queue has a single producer
+ *
+ * state : state shared with the render thread
+ * ev : the event
+ */
+
+static void
+post_event(app_state &state, const app_event &ev)
+{
+    // The render thread drains the queue every wakeup, so it only fills up if a frame takes
+    // ages, we count the events we lose then rather than block the window system.
+    if (!state.events.push(ev)) state.events_dropped++;
+    wake_render_thread(state);
+}
+
+/*
+ * wake_render_thread() : wake the render thread up if it is waiting for events
+ *
+ * state : state shared with the render thread
+ */
+
+static void
+wake_render_thread(app_state &state)
+{
+    // Taking the lock, even for nothing, makes sure that the render thread is either before
+    // its check of the queue or already asleep, otherwise the notification could get lost.
+    { std::lock_guard<std::mutex> lock(state.wake_mutex); }
+    state.wake_cv.notify_one();
+}
+
+/*
+ * wait_for_events() : put the render thread to sleep until there are events, we have to quit or
+ * the timeout runs out
+ *
+ * state : state shared with the main thread
+ * timeout : in seconds, negative to wait without a timeout
+ */
+
+static void
+wait_for_events(app_state &state, double timeout)
+{
+    std::unique_lock<std::mutex> lock(state.wake_mutex);
+    auto ready = [&state] {
+	return state.quit || state.shaders_changed || !state.events.empty();
+    };
+
+    if (timeout < 0.0)
+	state.wake_cv.wait(lock, ready);
+    else
+	state.wake_cv.wait_for(lock, std::chrono::duration<double>(timeout), ready);
+}
+
+/*
+ * parse_options() : parse the command line, we only have a handful of options, so we do not
+ * need getopt
+ *
+ * argc, argv : arguments of main()
+ */
+
+static app_options
+parse_options(int argc, char *argv[])
+{
+    app_options opts;
+
+    for (int i = 1; i < argc; i++) {
+	std::string arg = argv[i];
+
+	if (arg == "--benchmark" && i + 1 < argc) {
+	    // render this many frames in a hidden window and print the frame times
+	    opts.benchmark_frames = std::stoul(argv[++i]);
+	}
+	else if (arg == "--fps" && i + 1 < argc) {
+	    // animation frame rate, 0 for as fast as possible
+	    opts.target_fps = std::stod(argv[++i]);
+	}
+	else if (arg == "--vsync" && i + 1 < argc) {
+	    opts.vsync = frame_pacer::parse_vsync_mode(argv[++i]);
+	}
+	else if (arg == "--offscreen") {
+	    opts.offscreen = true;
+	}
+	else if (arg == "--shaders" && i + 1 < argc) {
+	    // directory of scene.vert and scene.frag
+	    opts.shader_dir = argv[++i];
+	    opts.embedded_shaders = false;
+	}
+	else if (arg == "--texture" && i + 1 < argc) {
+	    opts.texture_path = argv[++i];
+	}
+	else if (arg == "--texture-stream" && i + 1 < argc) {
+	    // KiB a frame
+	    opts.texture_stream_kib = std::stoul(argv[++i]);
+	}
+	else if (arg == "--gpu-budget" && i + 1 < argc) {
+	    // MiB
+	    opts.gpu_budget_mib = std::stoul(argv[++i]);
+	}
+	else if (arg == "--objects" && i + 1 < argc) {
+	    opts.objects = std::stoul(argv[++i]);
+	}
+	else if (arg == "--atlas") {
+	    opts.atlas = true;
+	}
+	else if (arg == "--layers" && i + 1 < argc) {
+	    opts.layers = std::max(std::stoul(argv[++i]), 1ul);
+	}
+	else if (arg == "--occlusion") {
+	    opts.occlusion = true;
+	}
+	else if (arg == "--soft-occlusion") {
+	    opts.soft_occlusion = true;
+	}
+	else if (arg == "--gpu-culling") {
+	    opts.gpu_culling = true;
+	}
+	else if (arg == "--zoom" && i + 1 < argc) {
+	    opts.zoom = std::stof(argv[++i]);
+	}
+	else if (arg == "--no-bvh") {
+	    opts.bvh = false;
+	}
+	else if (arg == "--mesh" && i + 1 < argc) {
+	    opts.mesh_path = argv[++i];
+	}
+	else if (arg == "--mesh-copies" && i + 1 < argc) {
+	    opts.mesh_copies = std::stoul(argv[++i]);
+	}
+	else if (arg == "--lod-error" && i + 1 < argc) {
+	    // pixels
+	    opts.lod_error_px = std::stod(argv[++i]);
+	}
+	else if (arg == "--no-lod") {
+	    opts.lod = false;
+	}
+	else if (arg == "--scene" && i + 1 < argc) {
+	    opts.scene_kind = argv[++i];
+	    parse_scene_kind(opts.scene_kind);
+	}
+	else if (arg == "--triangles" && i + 1 < argc) {
+	    opts.scene_triangles = std::stoull(argv[++i]);
+	}
+	else if (arg == "--seed" && i + 1 < argc) {
+	    opts.scene_seed = std::uint32_t(std::stoul(argv[++i]));
+	}
+	else if (arg == "--scene-threads" && i + 1 < argc) {
+	    opts.scene_threads = std::max(std::stoi(argv[++i]), 0);
+	}
+	else if (arg == "--particles" && i + 1 < argc) {
+	    opts.particles = std::stoul(argv[++i]);
+	}
+	else if (arg == "--particle-feedback") {
+	    opts.particle_feedback = true;
+	}
+	else if (arg == "--no-shader-cache") {
+	    // always compile the shader variants
+	    opts.shader_cache_dir.clear();
+	}
+	else if (arg == "--aa" && i + 1 < argc) {
+	    // all is only meaningful for the benchmark
+	    std::string mode = argv[++i];
+	    opts.aa_sweep = mode == "all";
+	    opts.aa = opts.aa_sweep ? aa_mode::off : parse_aa_mode(mode);
+	}
+	else if (arg == "--depth" && i + 1 < argc) {
+	    opts.depth = parse_depth_format(argv[++i]);
+	}
+	else if (arg == "--order" && i + 1 < argc) {
+	    opts.order = parse_draw_order(argv[++i]);
+	}
+	else if (arg == "--depth-prepass") {
+	    opts.depth_prepass = true;
+	}
+	else if (arg == "--fill" && i + 1 < argc) {
+	    // layers
+	    opts.fill_layers = std::max(std::stoi(argv[++i]), 0);
+	}
+	else {
+	    throw std::runtime_error(
+		"unknown option " + arg +
+		"\nusage: final [--benchmark <frames>] [--fps <hz>] [--vsync off|on|adaptive]"
+		" [--offscreen] [--aa off|msaa2|msaa4|msaa8|fxaa|all] [--shaders <dir>]"
+		" [--no-shader-cache] [--texture <file>|checker] [--texture-stream <kib>]"
+		" [--objects <n>] [--atlas] [--layers <n>] [--occlusion] [--soft-occlusion]"
+		" [--gpu-culling] [--zoom <f>] [--no-bvh] [--mesh <file.obj>|sphere]"
+		" [--mesh-copies <n>] [--lod-error <px>] [--no-lod]"
+		" [--depth off|16|24|32f|24s8|32fs8] [--order none|front|back]"
+		" [--depth-prepass] [--fill <layers>]"
+		" [--scene soup|pinwheels|spheres|terrain] [--triangles <n>] [--seed <n>]"
+		" [--scene-threads <n>] [--gpu-budget <mib>] [--particles <n>]"
+		" [--particle-feedback]");
+	}
+    }
+    if (opts.aa_sweep && !opts.benchmark_frames)
+	throw std::runtime_error("--aa all needs --benchmark");
+    if (opts.aa_sweep && opts.fill_layers)
+	throw std::runtime_error("--aa all and --fill cannot be benchmarked together");
+    // the window has no float depth
+    if (depth_is_float(opts.depth)) opts.offscreen = true;
+    return opts;
+}
+
+/*
+ * stats_lines() : the lines of the statistics overlay
+ *
+ * counters : pipeline statistics of a frame
+ * extended : whether the counters have the shader invocation counts
+ * cpu_ms, gpu_ms : frame times
+ * view, aa : current debug view and anti-aliasing mode
+ */
+
+static std::vector<std::string>
+stats_lines(const frame_counters &counters, bool extended, double cpu_ms, double gpu_ms,
+	    debug_view view, aa_mode aa)
+{
+    std::vector<std::string> lines;
+    std::ostringstream os;
+    os.setf(std::ios::fixed);
+    os.precision(3);
+
+    os << "CPU MS: " << cpu_ms;
+    lines.push_back(os.str());
+    os.str("");
+    os << "GPU MS: " << gpu_ms;
+    lines.push_back(os.str());
+
+    lines.push_back("DRAW CALLS: " + std::to_string(counters.draw_calls));
+    lines.push_back("PRIMITIVES: " + std::to_string(counters.primitives_generated));
+    if (extended) {
+	lines.push_back("VERTEX INVOCATIONS: " + std::to_string(counters.vertex_invocations));
+	lines.push_back("CLIPPED PRIMITIVES: " + std::to_string(counters.clipping_output));
+	lines.push_back("FRAGMENT INVOCATIONS: " +
+			std::to_string(counters.fragment_invocations));
+    }
+    else {
+	lines.push_back("NO PIPELINE STATISTICS QUERY");
+    }
+    lines.push_back(std::string("VIEW: ") + debug_view_name(view));
+    lines.push_back(std::string("AA: ") + aa_mode_name(aa));
+    return lines;
+}
+
+/*
+ * object_grid() : the vertices of the --objects grid, the pinwheel scaled down into the
+ * cells of a square grid, row by row from the top left, with texture coordinates after the
+ * position and the colour, stretched over the unrotated square of each pinwheel as the
+ * shader does for the single one. The layers follow each other further back, with the
+ * pinwheels behind the first at 0.3 of the size, so that their boxes, and the rectangles
+ * around those on the screen, stay inside the diamond of the one in front however it turns.
+ *
+ * vertices, count : the pinwheel, position and colour, count vertices
+ * objects, layers : number of copies in a layer, and of layers
+ * atlas : where the texture of each copy went, the copies take the images in turn, nullptr
+ * for a texture of its own
+ * boxes : if not nullptr, gets the bounds of the copies
+ */
+
+static std::vector<GLfloat>
+object_grid(const GLfloat *vertices, int count, unsigned long objects, unsigned long layers,
+	    const texture_atlas *atlas, std::vector<aabb> *boxes)
+{
+    unsigned long columns = (unsigned long)std::ceil(std::sqrt(double(objects)));
+    float cell = 2.0f / columns;
+
+    std::vector<GLfloat> grid;
+    grid.reserve(objects * layers * count * 9);
+    for (unsigned long i = 0; i < objects * layers; i++) {
+	unsigned long layer = i / objects, j = i % objects;
+	float cx = -1.0f + cell * (j % columns + 0.5f);
+	float cy = 1.0f - cell * (j / columns + 0.5f);
+	float cz = 0.9f * layer / layers, scale = 0.45f * cell * (layer ? 0.3f : 1.0f);
+	aabb box;
+	for (int v = 0; v < count; v++) {
+	    const GLfloat *p = &vertices[v * 6];
+	    float s = p[0] * 0.5f + 0.5f, t = 0.5f - p[1] * 0.5f;
+	    GLfloat page = 0.0f;
+	    if (atlas) {
+		const atlas_region &region = atlas->region(i % atlas->images());
+		s = region.u(s);
+		t = region.v(t);
+		page = GLfloat(region.layer);
+	    }
+	    GLfloat x = cx + p[0] * scale, y = cy + p[1] * scale, z = cz + p[2];
+	    grid.insert(grid.end(), {x, y, z, p[3], p[4], p[5], s, t, page});
+	    box.grow({{x, y, z}, {x, y, z}});
+	}
+	if (boxes) boxes->push_back(box);
+    }
+    return grid;
+}
+
+/*
+ * bvh_benchmark() : refit the bvh to boxes that moved a little, and back, and fire picking
+ * rays into the grid from random points, each timed over many runs
+ *
+ * tree, boxes : the bvh and the boxes it was built over
+ * out : where the rates go, one stat per line
+ */
+
+static void
+bvh_benchmark(bvh &tree, const std::vector<aabb> &boxes, std::ostream &out)
+{
+    using clock = std::chrono::steady_clock;
+    using millis = std::chrono::duration<double, std::milli>;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> jitter(-0.001f, 0.001f), point(-1.0f, 1.0f);
+
+    std::vector<aabb> moved(boxes);
+    for (aabb &b : moved) {
+	for (int k = 0; k < 2; k++) {
+	    float d = jitter(rng);
+	    b.lo[k] += d;
+	    b.hi[k] += d;
+	}
+    }
+
+    const int refits = 20;
+    auto start = clock::now();
+    for (int i = 0; i < refits; i++) tree.refit(i % 2 ? boxes : moved);
+    out << "bvh_refit_ms: " << millis(clock::now() - start).count() / refits << std::endl;
+    tree.refit(boxes);
+
+    const int rays = 100000;
+    long hits = 0;
+    start = clock::now();
+    for (int i = 0; i < rays; i++) {
+	float origin[3] = {point(rng), point(rng), -1.0f}, direction[3] = {0.0f, 0.0f, 1.0f};
+	float t;
+	if (tree.pick(origin, direction, t) >= 0) hits++;
+    }
+    double ms = millis(clock::now() - start).count();
+    out << "bvh_picks_per_s: " << rays / (ms * 1e-3) << std::endl;
+    out << "bvh_pick_hit_rate: " << double(hits) / rays << std::endl;
+}
+
+/*
+ * software_culler_benchmark() : rasterize the occluders of the last frame again, many times,
+ * with simd if the cpu has it and without, and test every box of the grid against them
+ *
+ * culler : the software culler, after a frame with occluders
+ * boxes : the boxes of the grid
+ * out : where the times go, one stat per line
+ */
+
+static void
+software_culler_benchmark(software_culler &culler, const std::vector<aabb> &boxes,
+			  std::ostream &out)
+{
+    using clock = std::chrono::steady_clock;
+    using millis = std::chrono::duration<double, std::milli>;
+    if (!culler.occluder_triangles()) return;
+
+    const int runs = 100;
+    bool simd = culler.simd();
+    for (bool with_simd : {true, false}) {
+	if (with_simd && !simd) continue;
+	culler.set_simd(with_simd);
+	auto start = clock::now();
+	for (int i = 0; i < runs; i++) culler.rasterize();
+	out << (with_simd ? "soft_occlusion_rasterize_avx2_ms: "
+			  : "soft_occlusion_rasterize_scalar_ms: ")
+	    << millis(clock::now() - start).count() / runs << std::endl;
+    }
+    culler.set_simd(simd);
+
+    // all of them, inside the window or not
+    const int passes = 10;
+    unsigned long hidden = 0;
+    auto start = clock::now();
+    for (int i = 0; i < passes; i++)
+	for (const aabb &box : boxes) hidden += !culler.visible(box);
+    double ms = millis(clock::now() - start).count();
+    out << "soft_occlusion_all_tests_per_ms: " << boxes.size() * passes / ms << std::endl;
+    out << "soft_occlusion_all_hidden: " << hidden / passes << std::endl;
 }
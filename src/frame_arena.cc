@@ -0,0 +1,152 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	frame_arena.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Bump allocation of the data of a frame, and the count of heap allocations
+
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+
+frame_arena::frame_arena(std::size_t chunk_bytes)
+    : chunk_bytes_(std::max(chunk_bytes, std::size_t(64)))
+{
+}
+
+frame_arena &
+frame_arena::local()
+{
+    thread_local frame_arena arena;
+    return arena;
+}
+
+void
+frame_arena::add_chunk(std::size_t bytes)
+{
+    chunks_.emplace_back(new char[bytes]);
+    top_ = chunks_.back().get();
+    end_ = top_ + bytes;
+    capacity_ += bytes;
+    chunk_allocations_++;
+}
+
+void *
+frame_arena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    auto aligned = [alignment](char *p) {
+	std::uintptr_t a = std::uintptr_t(p);
+	return reinterpret_cast<char *>((a + alignment - 1) & ~std::uintptr_t(alignment - 1));
+    };
+    char *p = top_ ? aligned(top_) : nullptr;
+    if (!p || p + bytes > end_) {
+	// each chunk doubles the capacity, and is at least as big as what it has to hold
+	add_chunk(std::max({chunk_bytes_, capacity_, bytes + alignment}));
+	p = aligned(top_);
+    }
+    bytes_ += p + bytes - top_;
+    top_ = p + bytes;
+    return p;
+}
+
+void
+frame_arena::deallocate(void *p, std::size_t bytes)
+{
+    if (static_cast<char *>(p) + bytes != top_) return;
+    top_ = static_cast<char *>(p);
+    bytes_ -= bytes;
+}
+
+void
+frame_arena::reset()
+{
+    peak_bytes_ = std::max(peak_bytes_, bytes_);
+    bytes_ = 0;
+    resets_++;
+
+    // a frame that took more than one chunk gets one for all of it from now on
+    if (chunks_.size() > 1) {
+	std::size_t total = capacity_;
+	chunks_.clear();
+	capacity_ = 0;
+	add_chunk(total);
+    }
+    if (!chunks_.empty()) {
+	top_ = chunks_.front().get();
+	end_ = top_ + capacity_;
+    }
+}
+
+void
+frame_arena::report(std::ostream &out) const
+{
+    out << "frame_arena_capacity: " << capacity_ << std::endl;
+    out << "frame_arena_peak_bytes: " << std::max(peak_bytes_, bytes_) << std::endl;
+    out << "frame_arena_chunk_allocations: " << chunk_allocations_ << std::endl;
+    out << "frame_arena_resets: " << resets_ << std::endl;
+}
+
+// The global operator new and delete are replaced by ones that count, on top of malloc as the
+// standard library has them. The array and nothrow forms of the standard library call these.
+
+static std::atomic<unsigned long> heap_allocation_count(0);
+
+unsigned long
+heap_allocations()
+{
+    return heap_allocation_count.load(std::memory_order_relaxed);
+}
+
+void *
+operator new(std::size_t size)
+{
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    for (;;) {
+	if (void *p = std::malloc(size ? size : 1)) return p;
+	std::new_handler handler = std::get_new_handler();
+	if (!handler) throw std::bad_alloc();
+	handler();
+    }
+}
+
+void *
+operator new(std::size_t size, std::align_val_t alignment)
+{
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    std::size_t a = std::max(std::size_t(alignment), sizeof(void *));
+    for (;;) {
+	if (void *p = std::aligned_alloc(a, (std::max(size, std::size_t(1)) + a - 1) / a * a))
+	    return p;
+	std::new_handler handler = std::get_new_handler();
+	if (!handler) throw std::bad_alloc();
+	handler();
+    }
+}
+
+void
+operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
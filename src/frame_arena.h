@@ -0,0 +1,113 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// frame_arena.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Bump allocation of the data of a frame, gone when the frame ends, and a count of the heap
+// allocations of the process
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+// The draw lists, sort keys and graph of a frame are built anew every frame and dropped at its
+// end. From the heap that is a malloc and a free each, and more as vectors grow. The arena
+// hands out memory by bumping a pointer through a chunk, frees nothing, and forgets it all at
+// once in reset(), at the end of the frame. A frame that does not fit into the chunk gets
+// more chunks, and at the reset they are replaced by one chunk big enough for all of them, so
+// after the first few frames a frame allocates nothing from the heap.
+//
+// Each thread has an arena of its own, local(), so nothing is locked. Memory from an arena is
+// only good until its reset, and the arena runs no destructors, containers have to be
+// destroyed, or emptied, before it is reset.
+
+class frame_arena {
+   public:
+    explicit frame_arena(std::size_t chunk_bytes = std::size_t(1) << 20);
+
+    frame_arena(const frame_arena &) = delete;
+    frame_arena &operator=(const frame_arena &) = delete;
+
+    // the arena of the calling thread
+    static frame_arena &local();
+
+    // bytes aligned to alignment, a power of two
+    void *allocate(std::size_t bytes, std::size_t alignment);
+
+    // only the latest allocation gives its bytes back, so that the temporaries of a thread
+    // that never resets its arena do not pile up
+    void deallocate(void *p, std::size_t bytes);
+
+    // forget everything allocated, at the end of the frame
+    void reset();
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t peak_bytes() const { return peak_bytes_; }
+    unsigned long chunk_allocations() const { return chunk_allocations_; }
+
+    // print the capacity, the most a frame used, and the chunks taken from the heap, one stat
+    // per line
+    void report(std::ostream &out) const;
+
+   private:
+    void add_chunk(std::size_t bytes);
+
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char *top_ = nullptr, *end_ = nullptr;
+    std::size_t chunk_bytes_, capacity_ = 0;
+    // of this frame, and the most of any frame
+    std::size_t bytes_ = 0, peak_bytes_ = 0;
+    unsigned long chunk_allocations_ = 0, resets_ = 0;
+};
+
+// A standard allocator from an arena, the calling thread's if none is given
+template <typename T>
+class frame_allocator {
+   public:
+    using value_type = T;
+
+    frame_allocator() : arena_(&frame_arena::local()) {}
+    explicit frame_allocator(frame_arena &arena) : arena_(&arena) {}
+    template <typename U>
+    frame_allocator(const frame_allocator<U> &other) : arena_(other.arena())
+    {
+    }
+
+    T *
+    allocate(std::size_t n)
+    {
+	return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *p, std::size_t n) { arena_->deallocate(p, n * sizeof(T)); }
+
+    frame_arena *arena() const { return arena_; }
+
+   private:
+    frame_arena *arena_;
+};
+
+template <typename T, typename U>
+bool
+operator==(const frame_allocator<T> &a, const frame_allocator<U> &b)
+{
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool
+operator!=(const frame_allocator<T> &a, const frame_allocator<U> &b)
+{
+    return a.arena() != b.arena();
+}
+
+template <typename T>
+using frame_vector = std::vector<T, frame_allocator<T>>;
+
+// operator new calls of the process so far, from all threads, every heap allocation of the
+// standard containers and of new goes through it
+unsigned long heap_allocations();
+
+#endif	// FRAME_ARENA_H
@@ -0,0 +1,326 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	frame_graph.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Frame graph with pass culling and transient target aliasing
+
+#include "frame_graph.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+// transients can share a target only if the pool would hand out the same kind for both
+static bool
+same_target(const render_target_desc &a, const render_target_desc &b)
+{
+    return a.width == b.width && a.height == b.height && a.color_format == b.color_format &&
+	   a.depth_format == b.depth_format && a.samples == b.samples;
+}
+
+frame_graph::frame_graph(render_target_pool &pool, int depth)
+    : pool_(pool), timed_(GLEW_VERSION_3_3 || GLEW_ARB_timer_query),
+      timings_(std::max(depth, 1))
+{
+}
+
+frame_graph::~frame_graph()
+{
+    for (timing_frame &f : timings_)
+	if (!f.queries.empty()) glDeleteQueries(GLsizei(f.queries.size()), f.queries.data());
+}
+
+void
+frame_graph::begin()
+{
+    resources_.clear();
+    passes_.clear();
+    order_.clear();
+    current_ = -1;
+    collect_timings();
+}
+
+frame_graph::resource
+frame_graph::create(const char *name, const render_target_desc &desc)
+{
+    resources_.push_back({name, desc, false, 0, -1, -1, nullptr});
+    return resource(resources_.size() - 1);
+}
+
+frame_graph::resource
+frame_graph::import(const char *name, GLuint fbo)
+{
+    resources_.push_back({name, render_target_desc(), true, fbo, -1, -1, nullptr});
+    return resource(resources_.size() - 1);
+}
+
+void
+frame_graph::add_pass(const char *name, std::initializer_list<resource> reads,
+		      std::initializer_list<resource> writes, void *commands,
+		      void (*run)(void *))
+{
+    passes_.push_back({name, frame_vector<resource>(reads), frame_vector<resource>(writes),
+		       commands, run, false});
+}
+
+void
+frame_graph::execute()
+{
+    // the passes hold memory of the frame arena, they go before it is reset, even on a throw
+    try {
+	run_passes();
+    }
+    catch (...) {
+	passes_.clear();
+	current_ = -1;
+	throw;
+    }
+    passes_.clear();
+}
+
+void
+frame_graph::run_passes()
+{
+    cull();
+    schedule();
+    alias();
+    culled_ = passes_.size() - order_.size();
+
+    // a timestamp before the first pass and after every pass, if a frame of them is free
+    timing_frame *timing = nullptr;
+    if (timed_ && count_ == int(timings_.size())) {
+	skipped_timings_++;
+    }
+    else if (timed_) {
+	timing = &timings_[(head_ + count_) % timings_.size()];
+	std::size_t n = order_.size() + 1, have = timing->queries.size();
+	if (have < n) {
+	    timing->queries.resize(n);
+	    glGenQueries(GLsizei(n - have), timing->queries.data() + have);
+	}
+	timing->stats.clear();
+	glQueryCounter(timing->queries[0], GL_TIMESTAMP);
+	count_++;
+    }
+
+    for (std::size_t k = 0; k < order_.size(); k++) {
+	current_ = order_[k];
+	const pass_node &p = passes_[current_];
+	p.run(p.commands);
+
+	std::size_t s = stats_index(p.name);
+	stats_[s].frames++;
+	if (timing) {
+	    timing->stats.push_back(s);
+	    glQueryCounter(timing->queries[k + 1], GL_TIMESTAMP);
+	}
+    }
+    current_ = -1;
+
+    frames_++;
+    passes_total_ += order_.size();
+    culled_total_ += culled_;
+    transient_bytes_total_ += transient_bytes_;
+    aliased_bytes_total_ += aliased_bytes_;
+}
+
+GLuint
+frame_graph::fbo(resource r) const
+{
+    const resource_node &n = resources_.at(r);
+    return n.imported ? n.fbo : target(r).fbo;
+}
+
+const render_target &
+frame_graph::target(resource r) const
+{
+    const resource_node &n = resources_.at(r);
+    if (current_ < 0 || !n.target)
+	throw std::runtime_error(std::string("frame graph resource ") + n.name +
+				 " has no target outside its passes");
+    return *n.target;
+}
+
+void
+frame_graph::cull()
+{
+    // alive are the passes writing an imported resource, and the writers of everything an
+    // alive pass reads, until nothing changes
+    for (pass_node &p : passes_) {
+	p.alive = std::any_of(p.writes.begin(), p.writes.end(),
+			      [this](resource r) { return resources_[r].imported; });
+    }
+
+    bool changed = true;
+    while (changed) {
+	changed = false;
+	for (const pass_node &p : passes_) {
+	    if (!p.alive) continue;
+	    for (resource r : p.reads) {
+		for (pass_node &w : passes_) {
+		    if (w.alive ||
+			std::find(w.writes.begin(), w.writes.end(), r) == w.writes.end())
+			continue;
+		    w.alive = true;
+		    changed = true;
+		}
+	    }
+	}
+    }
+}
+
+void
+frame_graph::schedule()
+{
+    // Pass p depends on the writers of what it reads, and on the writers added before it of
+    // what it writes. Of the passes whose dependencies have run, the one added first runs
+    // next, so the graph keeps the order it was given wherever that order is possible.
+    std::size_t n = passes_.size();
+    frame_vector<frame_vector<int>> deps(n);
+    for (std::size_t p = 0; p < n; p++) {
+	const pass_node &pass = passes_[p];
+	for (std::size_t w = 0; w < n; w++) {
+	    if (w == p) continue;
+	    const frame_vector<resource> &written = passes_[w].writes;
+	    auto writes = [&written](resource r) {
+		return std::find(written.begin(), written.end(), r) != written.end();
+	    };
+	    bool reads_it = std::any_of(pass.reads.begin(), pass.reads.end(), writes);
+	    bool after_it =
+		w < p && std::any_of(pass.writes.begin(), pass.writes.end(), writes);
+	    if (reads_it || after_it) deps[p].push_back(int(w));
+	}
+    }
+
+    frame_vector<bool> done(n, false);
+    std::size_t alive = std::count_if(passes_.begin(), passes_.end(),
+				      [](const pass_node &p) { return p.alive; });
+    while (order_.size() < alive) {
+	std::size_t next = n, stuck = n;
+	for (std::size_t p = 0; p < n; p++) {
+	    if (done[p] || !passes_[p].alive) continue;
+	    if (stuck == n) stuck = p;
+	    if (std::all_of(deps[p].begin(), deps[p].end(),
+			    [&](int d) { return done[d] || !passes_[d].alive; })) {
+		next = p;
+		break;
+	    }
+	}
+	if (next == n)
+	    throw std::runtime_error(std::string("frame graph has a cycle through pass ") +
+				     passes_[stuck].name);
+	done[next] = true;
+	order_.push_back(int(next));
+    }
+}
+
+void
+frame_graph::alias()
+{
+    // lifetimes in execution order
+    for (std::size_t k = 0; k < order_.size(); k++) {
+	const pass_node &p = passes_[order_[k]];
+	for (const frame_vector<resource> *list : {&p.reads, &p.writes}) {
+	    for (resource r : *list) {
+		resource_node &n = resources_[r];
+		if (n.first < 0) n.first = int(k);
+		n.last = int(k);
+	    }
+	}
+    }
+
+    // transients by the start of their lifetime, each into the first target of its kind that
+    // is free by then, or a new one from the pool
+    frame_vector<resource> transients;
+    for (std::size_t r = 0; r < resources_.size(); r++)
+	if (!resources_[r].imported && resources_[r].first >= 0) transients.push_back(int(r));
+    std::sort(transients.begin(), transients.end(), [this](resource a, resource b) {
+	return resources_[a].first < resources_[b].first;
+    });
+
+    struct slot {
+	render_target_desc desc;
+	int last;
+	render_target *target;
+    };
+    frame_vector<slot> slots;
+    transient_bytes_ = aliased_bytes_ = 0;
+    for (resource r : transients) {
+	resource_node &n = resources_[r];
+	slot *free = nullptr;
+	for (slot &s : slots) {
+	    if (s.last < n.first && same_target(s.desc, n.desc)) {
+		free = &s;
+		break;
+	    }
+	}
+	if (free) {
+	    aliased_bytes_ += free->target->bytes;
+	}
+	else {
+	    slots.push_back({n.desc, -1, pool_.acquire(n.desc)});
+	    free = &slots.back();
+	}
+	free->last = n.last;
+	n.target = free->target;
+	transient_bytes_ += n.target->bytes;
+    }
+
+    transients_total_ += transients.size();
+    targets_total_ += slots.size();
+}
+
+void
+frame_graph::collect_timings()
+{
+    // frames finish in order, and the last timestamp of a frame is the last to be written
+    while (count_) {
+	timing_frame &f = timings_[head_];
+	std::size_t n = f.stats.size();
+	GLuint available = GL_FALSE;
+	glGetQueryObjectuiv(f.queries[n], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) break;
+
+	GLuint64 before = 0, after = 0;
+	glGetQueryObjectui64v(f.queries[0], GL_QUERY_RESULT, &before);
+	for (std::size_t k = 0; k < n; k++) {
+	    glGetQueryObjectui64v(f.queries[k + 1], GL_QUERY_RESULT, &after);
+	    stats_[f.stats[k]].gpu_ms += double(after - before) * 1e-6;
+	    stats_[f.stats[k]].gpu_samples++;
+	    before = after;
+	}
+
+	head_ = (head_ + 1) % int(timings_.size());
+	count_--;
+    }
+}
+
+std::size_t
+frame_graph::stats_index(const char *name)
+{
+    for (std::size_t i = 0; i < stats_.size(); i++)
+	if (stats_[i].name == name) return i;
+    stats_.push_back({name});
+    return stats_.size() - 1;
+}
+
+void
+frame_graph::report(std::ostream &out) const
+{
+    out << "frame_graph_frames: " << frames_ << std::endl;
+    if (!frames_) return;
+    out << "frame_graph_passes_per_frame: " << passes_total_ / frames_ << std::endl;
+    out << "frame_graph_culled_per_frame: " << culled_total_ / frames_ << std::endl;
+    out << "frame_graph_transients_per_frame: " << transients_total_ / frames_ << std::endl;
+    out << "frame_graph_targets_per_frame: " << targets_total_ / frames_ << std::endl;
+    out << "frame_graph_transient_bytes_mean: " << transient_bytes_total_ / frames_
+	<< std::endl;
+    out << "frame_graph_aliased_bytes_mean: " << aliased_bytes_total_ / frames_ << std::endl;
+    out << "frame_graph_skipped_timings: " << skipped_timings_ << std::endl;
+    for (const pass_stats &s : stats_) {
+	out << "pass_" << s.name << "_frames: " << s.frames << std::endl;
+	if (s.gpu_samples)
+	    out << "pass_" << s.name << "_gpu_ms_mean: " << s.gpu_ms / s.gpu_samples
+		<< std::endl;
+    }
+}
@@ -0,0 +1,148 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// frame_graph.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Frame graph : render passes declare what they read and write, the graph orders them, culls
+// the ones nobody needs, and lets transient targets share memory
+
+#ifndef FRAME_GRAPH_H
+#define FRAME_GRAPH_H
+
+#include <GL/glew.h>
+
+#include <initializer_list>
+#include <iosfwd>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "frame_arena.h"
+#include "render_target_pool.h"
+
+// A frame is declared anew every frame, between begin() and execute(). Resources are either
+// transient targets that the graph gets from the pool, or imported framebuffers, like the
+// window. A pass that reads a resource runs after every pass that writes it, the writers of a
+// resource run in the order they were added, and otherwise the passes keep their order. Passes
+// that contribute nothing to an imported resource are culled. A transient lives from the first
+// to the last pass that uses it, and transients with the same description whose lifetimes do
+// not overlap get the same target. Each pass is timed on the gpu with timestamp queries, read
+// back frames later, so the cpu never waits.
+//
+// What is declared for a frame, the lists of the passes and their commands, and what
+// execute() works out from it, is in the frame arena of the thread, and gone at the end of
+// execute(), before the arena is reset.
+
+class frame_graph {
+   public:
+    using resource = int;
+
+    // needs the context to be current, depth : frames of timestamps that can be in flight
+    explicit frame_graph(render_target_pool &pool, int depth = 8);
+    ~frame_graph();
+
+    frame_graph(const frame_graph &) = delete;
+    frame_graph &operator=(const frame_graph &) = delete;
+
+    // start declaring a frame, collecting the timings of earlier frames that are done
+    void begin();
+
+    // a target the graph allocates when the frame executes
+    resource create(const char *name, const render_target_desc &desc);
+
+    // a framebuffer from outside, 0 for the window, passes writing it are never culled
+    resource import(const char *name, GLuint fbo);
+
+    // a pass, the resources it reads and writes, and the commands it records, which are
+    // copied into the frame arena, and so may not own anything that needs destroying
+    template <typename F>
+    void
+    add_pass(const char *name, std::initializer_list<resource> reads,
+	     std::initializer_list<resource> writes, F execute)
+    {
+	static_assert(std::is_trivially_destructible<F>::value,
+		      "the frame arena runs no destructors");
+	void *commands = frame_arena::local().allocate(sizeof(F), alignof(F));
+	new (commands) F(std::move(execute));
+	add_pass(name, reads, writes, commands,
+		 [](void *commands) { (*static_cast<F *>(commands))(); });
+    }
+
+    // order, cull, alias and run the passes, throws on a cycle, the targets go back to the
+    // pool at its end_frame()
+    void execute();
+
+    // framebuffer of a resource, and the target of a transient, only inside a pass
+    GLuint fbo(resource r) const;
+    const render_target &target(resource r) const;
+
+    // of the last frame
+    std::size_t passes_run() const { return order_.size(); }
+    std::size_t passes_culled() const { return culled_; }
+    std::size_t transient_bytes() const { return transient_bytes_; }
+    std::size_t aliased_bytes() const { return aliased_bytes_; }
+
+    // print the passes, culling and aliasing per frame, and the mean gpu time of each pass,
+    // one stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    struct resource_node {
+	const char *name;
+	render_target_desc desc;
+	bool imported;
+	GLuint fbo;
+	// passes, in execution order, of the first and last use
+	int first, last;
+	render_target *target;
+    };
+
+    struct pass_node {
+	const char *name;
+	frame_vector<resource> reads, writes;
+	void *commands;
+	void (*run)(void *);
+	bool alive;
+    };
+
+    // statistics of the passes by name
+    struct pass_stats {
+	std::string name;
+	unsigned long frames = 0, gpu_samples = 0;
+	double gpu_ms = 0.0;
+    };
+
+    // a frame of timestamps in flight, one before the passes and one after each
+    struct timing_frame {
+	std::vector<GLuint> queries;
+	std::vector<std::size_t> stats;
+    };
+
+    void add_pass(const char *name, std::initializer_list<resource> reads,
+		  std::initializer_list<resource> writes, void *commands, void (*run)(void *));
+    void run_passes();
+    void schedule();
+    void cull();
+    void alias();
+    void collect_timings();
+    std::size_t stats_index(const char *name);
+
+    render_target_pool &pool_;
+    std::vector<resource_node> resources_;
+    std::vector<pass_node> passes_;
+    std::vector<int> order_;
+    std::size_t culled_ = 0;
+    int current_ = -1;
+
+    bool timed_;
+    std::vector<timing_frame> timings_;
+    int head_ = 0, count_ = 0;
+    std::vector<pass_stats> stats_;
+
+    std::size_t transient_bytes_ = 0, aliased_bytes_ = 0;
+    unsigned long frames_ = 0, skipped_timings_ = 0;
+    double passes_total_ = 0.0, culled_total_ = 0.0, transients_total_ = 0.0;
+    double targets_total_ = 0.0, transient_bytes_total_ = 0.0, aliased_bytes_total_ = 0.0;
+};
+
+#endif	// FRAME_GRAPH_H
@@ -0,0 +1,126 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	frame_pacer.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Frame pacing
+
+#include "frame_pacer.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+using millis = std::chrono::duration<double, std::milli>;
+
+frame_pacer::frame_pacer(double target_hz)
+    : target_hz_(target_hz),
+      period_(target_hz > 0.0 ? std::chrono::duration_cast<clock::duration>(
+				    std::chrono::duration<double>(1.0 / target_hz))
+			      : clock::duration::zero()),
+      next_due_(clock::now())
+{
+}
+
+int
+frame_pacer::apply_swap_interval(vsync_mode mode)
+{
+    switch (mode) {
+	case vsync_mode::off:
+	    swap_interval_ = 0;
+	    break;
+	case vsync_mode::on:
+	    swap_interval_ = 1;
+	    break;
+	case vsync_mode::adaptive:
+	    // negative intervals are only allowed with the tear control extensions
+	    if (glfwExtensionSupported("GLX_EXT_swap_control_tear") ||
+		glfwExtensionSupported("WGL_EXT_swap_control_tear"))
+		swap_interval_ = -1;
+	    else
+		swap_interval_ = 1;
+	    break;
+    }
+    glfwSwapInterval(swap_interval_);
+    return swap_interval_;
+}
+
+bool
+frame_pacer::frame_due() const
+{
+    return clock::now() >= next_due_;
+}
+
+double
+frame_pacer::seconds_until_due() const
+{
+    std::chrono::duration<double> left = next_due_ - clock::now();
+    return std::max(0.0, left.count());
+}
+
+void
+frame_pacer::begin_frame()
+{
+    clock::time_point now = clock::now();
+
+    // After an idle stretch (or a very late frame) we do not try to catch up with a burst of
+    // frames, we start a fresh schedule from now.
+    if (now - next_due_ > period_) next_due_ = now;
+
+    deadline_ = next_due_ + period_;
+    next_due_ = deadline_;
+}
+
+void
+frame_pacer::end_frame(clock::time_point oldest_input)
+{
+    clock::time_point presented = clock::now();
+    frames_++;
+
+    // number of deadlines overshot, a frame presented within one period after its deadline
+    // missed one refresh, and so on
+    int missed = 0;
+    if (period_ > clock::duration::zero() && presented > deadline_) {
+	missed = 1 + int((presented - deadline_) / period_);
+    }
+    histogram_[std::min(missed, histogram_buckets - 1)]++;
+
+    if (oldest_input != clock::time_point()) {
+	double ms = millis(presented - oldest_input).count();
+	latency_samples_++;
+	latency_ms_total_ += ms;
+	latency_ms_max_ = std::max(latency_ms_max_, ms);
+    }
+}
+
+double
+frame_pacer::latency_ms_mean() const
+{
+    return latency_samples_ ? latency_ms_total_ / latency_samples_ : 0.0;
+}
+
+void
+frame_pacer::report(std::ostream &os) const
+{
+    os << "pacing_target_hz: " << target_hz_ << std::endl;
+    os << "pacing_swap_interval: " << swap_interval_ << std::endl;
+    os << "pacing_frames: " << frames_ << std::endl;
+    for (int i = 0; i < histogram_buckets; i++) {
+	os << "pacing_missed_" << i << (i == histogram_buckets - 1 ? "_or_more" : "") << ": "
+	   << histogram_[i] << std::endl;
+    }
+    os << "input_latency_samples: " << latency_samples_ << std::endl;
+    os << "input_latency_ms_mean: " << latency_ms_mean() << std::endl;
+    os << "input_latency_ms_max: " << latency_ms_max_ << std::endl;
+}
+
+frame_pacer::vsync_mode
+frame_pacer::parse_vsync_mode(const std::string &name)
+{
+    if (name == "off") return vsync_mode::off;
+    if (name == "on") return vsync_mode::on;
+    if (name == "adaptive") return vsync_mode::adaptive;
+    throw std::runtime_error("unknown vsync mode " + name + ", use off, on or adaptive");
+}
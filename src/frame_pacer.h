@@ -0,0 +1,78 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// frame_pacer.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Frame pacing : target frame rate, swap interval selection, late frame detection and input to
+// photon latency
+
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+
+// The pacer hands out a deadline for every frame, one period after the previous one. The render
+// loop sleeps (in the event wait, so input still wakes it up) until the next frame is due, and
+// after the swap the pacer checks how many deadlines the frame overshot. Presentation time is
+// approximated by the time the swap returns, so latencies are a lower bound of the real input
+// to photon latency, the scanout of the display comes on top.
+
+class frame_pacer {
+   public:
+    using clock = std::chrono::steady_clock;
+
+    // vsync modes, adaptive lets late frames tear instead of waiting a whole refresh
+    enum class vsync_mode { off, on, adaptive };
+
+    // histogram buckets : on time, 1, 2, 3 and 4 or more missed deadlines
+    static constexpr int histogram_buckets = 5;
+
+    // target_hz of 0 means uncapped, every frame is due immediately
+    explicit frame_pacer(double target_hz = 60.0);
+
+    // set the swap interval of the current context, adaptive falls back to plain vsync if the
+    // swap_control_tear extension is missing, returns the interval actually set
+    int apply_swap_interval(vsync_mode mode);
+
+    // whether the next frame is due, and if not, how long until it is
+    bool frame_due() const;
+    double seconds_until_due() const;
+
+    // bracket every drawn frame, end_frame() goes right after the swap, oldest_input is the
+    // time of the first input event the frame reflects, or a default time point if none
+    void begin_frame();
+    void end_frame(clock::time_point oldest_input = clock::time_point());
+
+    // statistics
+    double target_hz() const { return target_hz_; }
+    int swap_interval() const { return swap_interval_; }
+    unsigned long frames() const { return frames_; }
+    unsigned long missed_histogram(int bucket) const { return histogram_[bucket]; }
+    unsigned long latency_samples() const { return latency_samples_; }
+    double latency_ms_mean() const;
+    double latency_ms_max() const { return latency_ms_max_; }
+
+    // print all statistics, one per line
+    void report(std::ostream &os) const;
+
+    static vsync_mode parse_vsync_mode(const std::string &name);
+
+   private:
+    double target_hz_;
+    clock::duration period_;
+    int swap_interval_ = 0;
+
+    // when the next frame may start, and when the current frame has to be presented
+    clock::time_point next_due_;
+    clock::time_point deadline_;
+
+    unsigned long frames_ = 0;
+    unsigned long histogram_[histogram_buckets] = {};
+
+    unsigned long latency_samples_ = 0;
+    double latency_ms_total_ = 0.0;
+    double latency_ms_max_ = 0.0;
+};
+
+#endif	// FRAME_PACER_H
@@ -0,0 +1,467 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	gpu_culler.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Culling in a compute shader into indirect draws, against the frustum and a depth pyramid
+
+#include "gpu_culler.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "gpu_memory.h"
+#include "opengl_stuff.h"
+
+// An object per invocation. The box is outside the view volume if its eight corners are all
+// outside one of the planes, and hidden if its nearest depth is behind the farthest of the
+// pyramid texels under it. The commands of the visible objects go one after the other, at the
+// slots the drawn counter hands out, or, without compact, each at its own slot with an
+// instance count of 0 if it is culled.
+static const char *cull_src =
+    "#version 430 core\n"
+    "layout(local_size_x = 256) in;\n"
+    "struct box {\n"
+    "   vec4 lo, hi;\n"
+    "};\n"
+    "struct command {\n"
+    "   uint count, instance_count, first_index;\n"
+    "   int base_vertex;\n"
+    "   uint base_instance;\n"
+    "};\n"
+    "layout(std430, binding = 0) readonly buffer boxes {\n"
+    "   box b[];\n"
+    "};\n"
+    "layout(std430, binding = 1) readonly buffer draws {\n"
+    "   command d[];\n"
+    "};\n"
+    "layout(std430, binding = 2) writeonly buffer commands {\n"
+    "   command c[];\n"
+    "};\n"
+    "layout(std430, binding = 3) buffer counters {\n"
+    "   uint drawn, frustum_culled, occlusion_culled;\n"
+    "};\n"
+    "uniform mat4 matrix;\n"
+    "uniform uint count;\n"
+    "uniform bool compact, have_pyramid;\n"
+    "uniform sampler2D pyramid;\n"
+    "uniform ivec2 pyramid_size;\n"
+    "uniform int levels;\n"
+    "float farthest(vec2 uv, int level)\n"
+    "{\n"
+    "   ivec2 size = max(pyramid_size >> level, ivec2(1));\n"
+    "   ivec2 p = clamp(ivec2(uv * vec2(size)), ivec2(0), size - 1);\n"
+    "   return texelFetch(pyramid, p, level).r;\n"
+    "}\n"
+    "void main()\n"
+    "{\n"
+    "   uint id = gl_GlobalInvocationID.x;\n"
+    "   if (id >= count) return;\n"
+    "   vec3 lo = b[id].lo.xyz, hi = b[id].hi.xyz;\n"
+    "   uint outside = 63u;\n"
+    "   bool behind = false;\n"
+    "   vec3 ndc_lo = vec3(1e30), ndc_hi = vec3(-1e30);\n"
+    "   for (int i = 0; i < 8; i++) {\n"
+    "      vec3 corner = mix(lo, hi, vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));\n"
+    "      vec4 p = matrix * vec4(corner, 1.0);\n"
+    "      outside &= (p.x < -p.w ? 1u : 0u) | (p.x > p.w ? 2u : 0u) |\n"
+    "                 (p.y < -p.w ? 4u : 0u) | (p.y > p.w ? 8u : 0u) |\n"
+    "                 (p.z < -p.w ? 16u : 0u) | (p.z > p.w ? 32u : 0u);\n"
+    "      if (p.w <= 0.0) {\n"
+    "         behind = true;\n"
+    "      }\n"
+    "      else {\n"
+    "         ndc_lo = min(ndc_lo, p.xyz / p.w);\n"
+    "         ndc_hi = max(ndc_hi, p.xyz / p.w);\n"
+    "      }\n"
+    "   }\n"
+    "   bool visible = outside == 0u;\n"
+    "   if (!visible) {\n"
+    "      atomicAdd(frustum_culled, 1u);\n"
+    "   }\n"
+    "   else if (have_pyramid && !behind) {\n"
+    "      vec2 uv_lo = clamp(ndc_lo.xy * 0.5 + 0.5, 0.0, 1.0);\n"
+    "      vec2 uv_hi = clamp(ndc_hi.xy * 0.5 + 0.5, 0.0, 1.0);\n"
+    "      vec2 extent = (uv_hi - uv_lo) * vec2(pyramid_size);\n"
+    "      float texels = max(max(extent.x, extent.y), 1.0);\n"
+    "      int level = clamp(int(ceil(log2(texels))), 0, levels - 1);\n"
+    "      float far = max(max(farthest(uv_lo, level), farthest(uv_hi, level)),\n"
+    "                      max(farthest(vec2(uv_lo.x, uv_hi.y), level),\n"
+    "                          farthest(vec2(uv_hi.x, uv_lo.y), level)));\n"
+    "      if (ndc_lo.z * 0.5 + 0.5 > far) {\n"
+    "         visible = false;\n"
+    "         atomicAdd(occlusion_culled, 1u);\n"
+    "      }\n"
+    "   }\n"
+    "   command cmd = d[id];\n"
+    "   cmd.instance_count = visible ? 1u : 0u;\n"
+    "   if (!compact) c[id] = cmd;\n"
+    "   if (visible) {\n"
+    "      uint slot = atomicAdd(drawn, 1u);\n"
+    "      if (compact) c[slot] = cmd;\n"
+    "   }\n"
+    "}\n";
+
+// a full target quad, a 4 vertex strip from the bits of the vertex id
+static const char *reduce_vertex_src =
+    "#version 330 core\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 p = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;\n"
+    "   gl_Position = vec4(p, 0.0, 1.0);\n"
+    "}\n";
+
+// the farthest of the 2x2 texels of the level above, which is the base level of the texture
+// while this one is written, an odd last row or column is read twice
+static const char *reduce_fragment_src =
+    "#version 330 core\n"
+    "uniform sampler2D depth;\n"
+    "void main()\n"
+    "{\n"
+    "   ivec2 last = textureSize(depth, 0) - 1;\n"
+    "   ivec2 p = ivec2(gl_FragCoord.xy) * 2;\n"
+    "   float a = texelFetch(depth, min(p, last), 0).r;\n"
+    "   float b = texelFetch(depth, min(p + ivec2(1, 0), last), 0).r;\n"
+    "   float c = texelFetch(depth, min(p + ivec2(0, 1), last), 0).r;\n"
+    "   float d = texelFetch(depth, min(p + ivec2(1, 1), last), 0).r;\n"
+    "   gl_FragDepth = max(max(a, b), max(c, d));\n"
+    "}\n";
+
+bool
+gpu_culler::supported()
+{
+    return GLEW_VERSION_4_3;
+}
+
+gpu_culler::gpu_culler()
+    : indirect_count_(GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters),
+      timed_(GLEW_VERSION_3_3 || GLEW_ARB_timer_query)
+{
+    GLuint shader = compile_shader(GL_COMPUTE_SHADER, cull_src, "gpu cull");
+    try {
+	cull_program_ = link_program(&shader, 1, "gpu cull");
+	glDeleteShader(shader);
+    }
+    catch (...) {
+	glDeleteShader(shader);
+	throw;
+    }
+    matrix_loc_ = glGetUniformLocation(cull_program_, "matrix");
+    count_loc_ = glGetUniformLocation(cull_program_, "count");
+    compact_loc_ = glGetUniformLocation(cull_program_, "compact");
+    pyramid_loc_ = glGetUniformLocation(cull_program_, "pyramid");
+    have_pyramid_loc_ = glGetUniformLocation(cull_program_, "have_pyramid");
+    pyramid_size_loc_ = glGetUniformLocation(cull_program_, "pyramid_size");
+    levels_loc_ = glGetUniformLocation(cull_program_, "levels");
+    glProgramUniform1i(cull_program_, pyramid_loc_, pyramid_unit);
+
+    reduce_program_ = build_program(reduce_vertex_src, reduce_fragment_src, "depth pyramid");
+    glProgramUniform1i(reduce_program_, glGetUniformLocation(reduce_program_, "depth"),
+		       pyramid_unit);
+
+    glGenBuffers(1, &boxes_);
+    glGenBuffers(1, &draws_);
+    glGenBuffers(1, &commands_);
+    glGenBuffers(1, &counters_);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counters_);
+    tracked_buffer_data(GL_SHADER_STORAGE_BUFFER, counters_, 3 * sizeof(GLuint), nullptr,
+			GL_DYNAMIC_COPY, gpu_category::other, "gpu_culler");
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    for (timing_frame &f : timings_) {
+	glGenBuffers(1, &f.readback);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, f.readback);
+	tracked_buffer_data(GL_COPY_WRITE_BUFFER, f.readback, 3 * sizeof(GLuint), nullptr,
+			    GL_STREAM_READ, gpu_category::staging, "gpu_culler");
+	if (timed_) glGenQueries(4, f.queries);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // depth only, no colour to write or read
+    glGenFramebuffers(1, &pyramid_fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, pyramid_fbo_);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &empty_vao_);
+}
+
+gpu_culler::~gpu_culler()
+{
+    for (timing_frame &f : timings_) {
+	if (f.fence) glDeleteSync(f.fence);
+	if (timed_) glDeleteQueries(4, f.queries);
+	tracked_delete_buffers(1, &f.readback);
+    }
+    tracked_delete_buffers(1, &boxes_);
+    tracked_delete_buffers(1, &draws_);
+    tracked_delete_buffers(1, &commands_);
+    tracked_delete_buffers(1, &counters_);
+    tracked_delete_textures(1, &pyramid_);
+    glDeleteFramebuffers(1, &pyramid_fbo_);
+    glDeleteVertexArrays(1, &empty_vao_);
+    glDeleteProgram(cull_program_);
+    glDeleteProgram(reduce_program_);
+}
+
+void
+gpu_culler::set_objects(const std::vector<aabb> &boxes, const std::vector<draw_command> &draws)
+{
+    if (boxes.size() != draws.size())
+	throw std::runtime_error("gpu culler needs a draw command for every box");
+    if (boxes.size() > max_objects)
+	throw std::runtime_error("too many objects to cull on the gpu, at most " +
+				 std::to_string(max_objects));
+    objects_ = boxes.size();
+
+    // a box is two vec4s in the storage buffer
+    std::vector<GLfloat> corners;
+    corners.reserve(objects_ * 8);
+    for (const aabb &b : boxes)
+	corners.insert(corners.end(), {b.lo[0], b.lo[1], b.lo[2], 0.0f, b.hi[0], b.hi[1],
+				       b.hi[2], 0.0f});
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, boxes_);
+    tracked_buffer_data(GL_SHADER_STORAGE_BUFFER, boxes_, corners.size() * sizeof(GLfloat),
+			corners.data(), GL_STATIC_DRAW, gpu_category::other, "gpu_culler");
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, draws_);
+    tracked_buffer_data(GL_SHADER_STORAGE_BUFFER, draws_, objects_ * sizeof(draw_command),
+			draws.data(), GL_STATIC_DRAW, gpu_category::other, "gpu_culler");
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, commands_);
+    tracked_buffer_data(GL_SHADER_STORAGE_BUFFER, commands_, objects_ * sizeof(draw_command),
+			nullptr, GL_DYNAMIC_COPY, gpu_category::other, "gpu_culler");
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    have_pyramid_ = false;
+}
+
+void
+gpu_culler::cull(const float matrix[16])
+{
+    static_assert(sizeof(draw_command) == 5 * sizeof(GLuint),
+		  "a draw command is five packed uints, as the gpu reads it");
+
+    collect_timings();
+    if (!objects_) return;
+
+    // a frame for the counters and timestamps, if one is free
+    if (in_flight_ == timing_depth) {
+	skipped_timings_++;
+	open_ = -1;
+    }
+    else {
+	open_ = (head_ + in_flight_) % timing_depth;
+	if (timed_) glQueryCounter(timings_[open_].queries[0], GL_TIMESTAMP);
+    }
+
+    GLint program = 0, unit = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &unit);
+
+    const GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counters_);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT,
+		      &zero);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, boxes_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, draws_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commands_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, counters_);
+
+    glActiveTexture(GL_TEXTURE0 + pyramid_unit);
+    glBindTexture(GL_TEXTURE_2D, pyramid_);
+
+    glUseProgram(cull_program_);
+    glUniformMatrix4fv(matrix_loc_, 1, GL_FALSE, matrix);
+    glUniform1ui(count_loc_, GLuint(objects_));
+    glUniform1i(compact_loc_, indirect_count_);
+    glUniform1i(have_pyramid_loc_, have_pyramid_ && pyramid_);
+    glUniform2i(pyramid_size_loc_, pyramid_width_, pyramid_height_);
+    glUniform1i(levels_loc_, levels_);
+    glDispatchCompute(GLuint((objects_ + 255) / 256), 1, 1);
+
+    // the commands and the count are read by the draws, and the counters copied
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    if (open_ >= 0) {
+	timing_frame &f = timings_[open_];
+	if (timed_) glQueryCounter(f.queries[1], GL_TIMESTAMP);
+	glBindBuffer(GL_COPY_READ_BUFFER, counters_);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, f.readback);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+			    3 * sizeof(GLuint));
+    }
+
+    glUseProgram(program);
+    glActiveTexture(unit);
+    frames_++;
+}
+
+void
+gpu_culler::draw() const
+{
+    if (!objects_) return;
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands_);
+    if (indirect_count_) {
+	// the count is the drawn counter, at the start of the counters
+	glBindBuffer(GL_PARAMETER_BUFFER_ARB, counters_);
+	if (GLEW_VERSION_4_6)
+	    glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0,
+					     GLsizei(objects_), 0);
+	else
+	    glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0,
+						GLsizei(objects_), 0);
+    }
+    else {
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, GLsizei(objects_),
+				    0);
+    }
+}
+
+void
+gpu_culler::resize_pyramid(int width, int height)
+{
+    int w = 1, h = 1;
+    while (w * 4 <= width) w *= 2;
+    while (h * 4 <= height) h *= 2;
+    if (pyramid_ && w == pyramid_width_ && h == pyramid_height_) return;
+
+    tracked_delete_textures(1, &pyramid_);
+    pyramid_width_ = w;
+    pyramid_height_ = h;
+    levels_ = 1;
+    while ((std::max(w, h) >> levels_) > 0) levels_++;
+
+    glGenTextures(1, &pyramid_);
+    glBindTexture(GL_TEXTURE_2D, pyramid_);
+    glTexStorage2D(GL_TEXTURE_2D, levels_, GL_DEPTH_COMPONENT32F, w, h);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    std::size_t bytes = 0;
+    for (int level = 0; level < levels_; level++)
+	bytes += std::size_t(std::max(w >> level, 1)) * std::max(h >> level, 1) * 4;
+    tracked_texture(pyramid_, bytes, gpu_category::targets, "gpu_culler");
+
+    have_pyramid_ = false;
+}
+
+void
+gpu_culler::update_depth(int width, int height)
+{
+    if (!objects_) return;
+
+    GLint draw_fbo = 0, read_fbo = 0, viewport[4] = {}, program = 0, vao = 0, unit = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw_fbo);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_fbo);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &unit);
+
+    glActiveTexture(GL_TEXTURE0 + pyramid_unit);
+    resize_pyramid(width, height);
+    if (open_ >= 0 && timed_) glQueryCounter(timings_[open_].queries[2], GL_TIMESTAMP);
+
+    // the visible objects into the first level, with the scene's program
+    glBindFramebuffer(GL_FRAMEBUFFER, pyramid_fbo_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, pyramid_, 0);
+    glViewport(0, 0, pyramid_width_, pyramid_height_);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    draw();
+
+    // each level from the one above, which is all the texture has while it is read, so that
+    // reading and writing it is no feedback loop
+    glUseProgram(reduce_program_);
+    glBindVertexArray(empty_vao_);
+    glBindTexture(GL_TEXTURE_2D, pyramid_);
+    glDepthFunc(GL_ALWAYS);
+    for (int level = 1; level < levels_; level++) {
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, pyramid_,
+			       level);
+	glViewport(0, 0, std::max(pyramid_width_ >> level, 1),
+		   std::max(pyramid_height_ >> level, 1));
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels_ - 1);
+    glDepthFunc(GL_LESS);
+    have_pyramid_ = true;
+
+    if (open_ >= 0) {
+	timing_frame &f = timings_[open_];
+	if (timed_) glQueryCounter(f.queries[3], GL_TIMESTAMP);
+	f.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	in_flight_++;
+	open_ = -1;
+    }
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_fbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_fbo);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glUseProgram(program);
+    glBindVertexArray(vao);
+    glActiveTexture(unit);
+}
+
+void
+gpu_culler::collect_timings()
+{
+    // frames finish in order, the fence comes after everything of its frame
+    while (in_flight_) {
+	timing_frame &f = timings_[head_];
+	GLenum state = glClientWaitSync(f.fence, 0, 0);
+	if (state != GL_ALREADY_SIGNALED && state != GL_CONDITION_SATISFIED) break;
+	glDeleteSync(f.fence);
+	f.fence = nullptr;
+
+	GLuint counts[3] = {};
+	glBindBuffer(GL_COPY_READ_BUFFER, f.readback);
+	glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(counts), counts);
+	drawn_total_ += counts[0];
+	frustum_total_ += counts[1];
+	occluded_total_ += counts[2];
+	samples_++;
+
+	if (timed_) {
+	    GLuint64 t[4] = {};
+	    for (int i = 0; i < 4; i++)
+		glGetQueryObjectui64v(f.queries[i], GL_QUERY_RESULT, &t[i]);
+	    cull_gpu_ms_ += double(t[1] - t[0]) * 1e-6;
+	    depth_gpu_ms_ += double(t[3] - t[2]) * 1e-6;
+	    gpu_samples_++;
+	}
+
+	head_ = (head_ + 1) % timing_depth;
+	in_flight_--;
+    }
+}
+
+void
+gpu_culler::report(std::ostream &out) const
+{
+    out << "gpu_culler_objects: " << objects_ << std::endl;
+    out << "gpu_culler_indirect_count: " << (indirect_count_ ? "yes" : "no") << std::endl;
+    out << "gpu_culler_pyramid: " << pyramid_width_ << "x" << pyramid_height_ << std::endl;
+    out << "gpu_culler_frames: " << frames_ << std::endl;
+    out << "gpu_culler_skipped_readbacks: " << skipped_timings_ << std::endl;
+    if (samples_) {
+	out << "gpu_culler_drawn_per_frame: " << drawn_total_ / samples_ << std::endl;
+	out << "gpu_culler_frustum_culled_per_frame: " << frustum_total_ / samples_
+	    << std::endl;
+	out << "gpu_culler_occlusion_culled_per_frame: " << occluded_total_ / samples_
+	    << std::endl;
+    }
+    if (gpu_samples_) {
+	double cull_ms = cull_gpu_ms_ / gpu_samples_;
+	out << "gpu_culler_cull_gpu_ms_mean: " << cull_ms << std::endl;
+	out << "gpu_culler_depth_gpu_ms_mean: " << depth_gpu_ms_ / gpu_samples_ << std::endl;
+	if (cull_ms > 0.0)
+	    out << "gpu_culler_mobjects_per_s: " << objects_ / cull_ms * 1e-3 << std::endl;
+    }
+}
@@ -0,0 +1,127 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// gpu_culler.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Frustum and depth pyramid culling in a compute shader, writing the indirect draws of the
+// visible objects
+
+#ifndef GPU_CULLER_H
+#define GPU_CULLER_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "bvh.h"
+
+// The boxes of the objects, and a draw command for each, are uploaded once. Every frame a
+// compute shader, an invocation per object, tests its box against the view volume and against
+// a pyramid of the farthest depths of the last frame, and writes the commands of the visible
+// ones into an indirect buffer, with a count the draw takes from the gpu too, so the cpu only
+// issues one glMultiDrawElementsIndirectCount whatever the number of objects. That needs 4.6
+// or ARB_indirect_parameters. Without it the compute shader writes every command in place,
+// with an instance count of 0 for the culled ones, and glMultiDrawElementsIndirect goes
+// through all of them.
+//
+// The pyramid comes from drawing the visible objects once more, depth only, into a depth
+// texture of about half the window, then halving it level by level keeping the farthest of
+// each 2x2. A box is tested at the level where it is at most two texels across, by the four
+// texels under it, so an object that comes into view from behind others is drawn a frame late,
+// as with the occlusion queries. Culled objects never go into the pyramid, the objects that
+// are drawn hide them.
+//
+// The number of objects drawn and culled is read back frames later, from a ring of buffers
+// with fences, and the cull and the pyramid are timed with timestamp queries, so the cpu
+// never waits. It needs 4.3, for compute shaders and indirect multi draws.
+
+class gpu_culler {
+   public:
+    // DrawElementsIndirectCommand, as the indirect draws read it
+    struct draw_command {
+	GLuint count, instance_count, first_index;
+	GLint base_vertex;
+	GLuint base_instance;
+    };
+
+    // a compute dispatch is at most 65535 groups of 256
+    static constexpr std::size_t max_objects = std::size_t(65535) * 256;
+
+    // whether the context can cull on the gpu
+    static bool supported();
+
+    // needs the context to be current, and supported()
+    gpu_culler();
+    ~gpu_culler();
+
+    gpu_culler(const gpu_culler &) = delete;
+    gpu_culler &operator=(const gpu_culler &) = delete;
+
+    // the boxes of the objects and the draw of each, their instance counts are ignored,
+    // throws if there are more than max_objects or the counts differ
+    void set_objects(const std::vector<aabb> &boxes, const std::vector<draw_command> &draws);
+
+    // cull with matrix, column major, which takes the boxes to clip space as the scene
+    // program does, against the pyramid of the last update_depth()
+    void cull(const float matrix[16]);
+
+    // draw the visible objects of the last cull() as triangles, with the program, the vertex
+    // array and its element buffer of unsigned int indices that are bound
+    void draw() const;
+
+    // draw the visible objects again, with the bound program and vertex array, into the
+    // pyramid for a window of width by height pixels, and reduce it. Depth testing is left
+    // on, the framebuffer, viewport, program and vertex array bindings are kept.
+    void update_depth(int width, int height);
+
+    // forget the pyramid, when the view changed beyond what a frame late covers
+    void reset() { have_pyramid_ = false; }
+
+    std::size_t objects() const { return objects_; }
+    bool uses_indirect_count() const { return indirect_count_; }
+
+    // print the objects drawn and culled per frame, and the gpu time and rate of the cull,
+    // one stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    static constexpr int timing_depth = 4;
+    // the texture unit of the pyramid, out of the way of the scene's
+    static constexpr int pyramid_unit = 7;
+
+    // a frame in flight, the counters copied into readback after the cull, and timestamps
+    // before and after the cull and the pyramid
+    struct timing_frame {
+	GLuint readback = 0;
+	GLsync fence = nullptr;
+	GLuint queries[4] = {};
+    };
+
+    // a pyramid whose first level has the largest powers of two within half the window
+    void resize_pyramid(int width, int height);
+    void collect_timings();
+
+    bool indirect_count_, timed_;
+    GLuint cull_program_ = 0, reduce_program_ = 0;
+    GLint matrix_loc_ = -1, count_loc_ = -1, compact_loc_ = -1, pyramid_loc_ = -1;
+    GLint have_pyramid_loc_ = -1, pyramid_size_loc_ = -1, levels_loc_ = -1;
+
+    // boxes, the commands as given, the commands to draw, and the drawn, frustum culled and
+    // occlusion culled counters, the first also the draw count
+    GLuint boxes_ = 0, draws_ = 0, commands_ = 0, counters_ = 0;
+    std::size_t objects_ = 0;
+
+    GLuint pyramid_ = 0, pyramid_fbo_ = 0, empty_vao_ = 0;
+    int pyramid_width_ = 0, pyramid_height_ = 0, levels_ = 0;
+    bool have_pyramid_ = false;
+
+    timing_frame timings_[timing_depth];
+    int head_ = 0, in_flight_ = 0, open_ = -1;
+
+    unsigned long frames_ = 0, samples_ = 0, gpu_samples_ = 0, skipped_timings_ = 0;
+    double drawn_total_ = 0.0, frustum_total_ = 0.0, occluded_total_ = 0.0;
+    double cull_gpu_ms_ = 0.0, depth_gpu_ms_ = 0.0;
+};
+
+#endif	// GPU_CULLER_H
@@ -0,0 +1,275 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	gpu_memory.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Accounting of the gpu memory of buffers, textures and renderbuffers
+
+#include "gpu_memory.h"
+
+#include <algorithm>
+#include <ostream>
+
+#include "render_target_pool.h"
+
+// the driver is asked this often, the numbers are for the report, not for decisions
+static const unsigned long driver_sample_frames = 60;
+
+const char *
+gpu_category_name(gpu_category category)
+{
+    switch (category) {
+	case gpu_category::vertices:
+	    return "vertices";
+	case gpu_category::indices:
+	    return "indices";
+	case gpu_category::textures:
+	    return "textures";
+	case gpu_category::targets:
+	    return "targets";
+	case gpu_category::staging:
+	    return "staging";
+	case gpu_category::other:
+	    return "other";
+    }
+    return "unknown";
+}
+
+gpu_memory &
+gpu_memory::get()
+{
+    static gpu_memory tracker;
+    return tracker;
+}
+
+void
+gpu_memory::set_budget(std::size_t bytes)
+{
+    budget_ = bytes;
+    enforce_budget(key(-1));
+}
+
+void
+gpu_memory::add(totals &t, std::size_t bytes)
+{
+    t.bytes += bytes;
+    t.peak_bytes = std::max(t.peak_bytes, t.bytes);
+    t.objects++;
+    t.allocations++;
+}
+
+void
+gpu_memory::remove(totals &t, std::size_t bytes)
+{
+    t.bytes -= bytes;
+    t.objects--;
+}
+
+void
+gpu_memory::allocated(gpu_object kind, GLuint id, std::size_t bytes, gpu_category category,
+		      const char *tag, std::function<void()> evict)
+{
+    key k = key_of(kind, id);
+    auto found = entries_.find(k);
+    if (found != entries_.end()) {
+	// a new store for the same object
+	entry &old = found->second;
+	remove(all_, old.bytes);
+	remove(categories_[int(old.category)], old.bytes);
+	remove(tags_[old.tag], old.bytes);
+	if (old.evict) lru_.erase(old.lru);
+	entries_.erase(found);
+    }
+
+    // new objects are fair game for eviction until they are used
+    entry &e = entries_[k];
+    e = {kind, id, bytes, category, tag && *tag ? tag : "untagged", std::move(evict), 0, {}};
+    add(all_, bytes);
+    add(categories_[int(category)], bytes);
+    add(tags_[e.tag], bytes);
+    if (e.evict) e.lru = lru_.insert(lru_.end(), k);
+
+    enforce_budget(k);
+}
+
+void
+gpu_memory::released(gpu_object kind, GLuint id)
+{
+    auto found = entries_.find(key_of(kind, id));
+    if (found == entries_.end()) return;
+    entry &e = found->second;
+    remove(all_, e.bytes);
+    remove(categories_[int(e.category)], e.bytes);
+    remove(tags_[e.tag], e.bytes);
+    if (e.evict) lru_.erase(e.lru);
+    entries_.erase(found);
+}
+
+void
+gpu_memory::used(gpu_object kind, GLuint id)
+{
+    auto found = entries_.find(key_of(kind, id));
+    if (found == entries_.end()) return;
+    entry &e = found->second;
+    e.used_frame = frame_;
+    if (e.evict) lru_.splice(lru_.end(), lru_, e.lru);
+}
+
+void
+gpu_memory::end_frame()
+{
+    if (budget_ && all_.bytes > budget_) over_budget_frames_++;
+    if (frame_ % driver_sample_frames == 1) sample_driver();
+    frame_++;
+}
+
+void
+gpu_memory::enforce_budget(key keep)
+{
+    // The evict function of the owner releases the object, and maybe others with it, so the
+    // list is walked from the start again after every eviction.
+    bool evicted = true;
+    while (budget_ && all_.bytes > budget_ && evicted) {
+	evicted = false;
+	for (key k : lru_) {
+	    entry &e = entries_.at(k);
+	    if (k == keep || e.used_frame == frame_) continue;
+	    std::size_t bytes = e.bytes;
+	    std::function<void()> evict = e.evict;
+	    evict();
+
+	    // an owner that kept it is not asked again
+	    auto left = entries_.find(k);
+	    if (left != entries_.end()) {
+		lru_.erase(left->second.lru);
+		left->second.evict = nullptr;
+	    }
+	    else {
+		evictions_++;
+		evicted_bytes_ += bytes;
+	    }
+	    evicted = true;
+	    break;
+	}
+    }
+}
+
+void
+gpu_memory::sample_driver()
+{
+    GLint v[4] = {};
+    if (GLEW_NVX_gpu_memory_info) {
+	driver_ = "nvx";
+	glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, v);
+	driver_dedicated_kib_ = v[0];
+	glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, v);
+	driver_total_kib_ = v[0];
+	glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, v);
+	if (driver_available_min_kib_ < 0 || v[0] < driver_available_min_kib_)
+	    driver_available_min_kib_ = v[0];
+	glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX, v);
+	driver_evictions_ = v[0];
+	glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, v);
+	driver_evicted_kib_ = v[0];
+    }
+    else if (GLEW_ATI_meminfo) {
+	// the total free and the largest free block of the pool, then of the auxiliary pool,
+	// textures and buffers share the pool on current hardware
+	driver_ = "ati";
+	glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, v);
+	if (driver_available_min_kib_ < 0 || v[0] < driver_available_min_kib_)
+	    driver_available_min_kib_ = v[0];
+    }
+}
+
+void
+gpu_memory::report(std::ostream &out) const
+{
+    out << "gpu_memory_budget_bytes: " << budget_ << std::endl;
+    out << "gpu_memory_bytes: " << all_.bytes << std::endl;
+    out << "gpu_memory_peak_bytes: " << all_.peak_bytes << std::endl;
+    out << "gpu_memory_objects: " << all_.objects << std::endl;
+    out << "gpu_memory_allocations: " << all_.allocations << std::endl;
+    for (int i = 0; i < num_gpu_categories; i++) {
+	const totals &t = categories_[i];
+	if (!t.allocations) continue;
+	std::string name = std::string("gpu_memory_") + gpu_category_name(gpu_category(i));
+	out << name << "_bytes: " << t.bytes << std::endl;
+	out << name << "_peak_bytes: " << t.peak_bytes << std::endl;
+	out << name << "_objects: " << t.objects << std::endl;
+    }
+    for (const auto &tag : tags_) {
+	std::string name = "gpu_memory_tag_" + tag.first;
+	out << name << "_bytes: " << tag.second.bytes << std::endl;
+	out << name << "_peak_bytes: " << tag.second.peak_bytes << std::endl;
+    }
+    out << "gpu_memory_evictions: " << evictions_ << std::endl;
+    out << "gpu_memory_evicted_bytes: " << evicted_bytes_ << std::endl;
+    out << "gpu_memory_over_budget_frames: " << over_budget_frames_ << std::endl;
+
+    out << "gpu_memory_driver: " << driver_ << std::endl;
+    if (driver_dedicated_kib_ >= 0)
+	out << "gpu_memory_driver_dedicated_kib: " << driver_dedicated_kib_ << std::endl;
+    if (driver_total_kib_ >= 0)
+	out << "gpu_memory_driver_total_kib: " << driver_total_kib_ << std::endl;
+    if (driver_available_min_kib_ >= 0)
+	out << "gpu_memory_driver_available_min_kib: " << driver_available_min_kib_
+	    << std::endl;
+    if (driver_evictions_ >= 0)
+	out << "gpu_memory_driver_evictions: " << driver_evictions_ << std::endl;
+    if (driver_evicted_kib_ >= 0)
+	out << "gpu_memory_driver_evicted_kib: " << driver_evicted_kib_ << std::endl;
+}
+
+void
+tracked_buffer_data(GLenum target, GLuint buffer, GLsizeiptr size, const void *data,
+		    GLenum usage, gpu_category category, const char *tag)
+{
+    glBindBuffer(target, buffer);
+    glBufferData(target, size, data, usage);
+    gpu_memory::get().allocated(gpu_object::buffer, buffer, std::size_t(size), category, tag);
+}
+
+void
+tracked_renderbuffer_storage(GLuint renderbuffer, GLsizei samples, GLenum format,
+			     GLsizei width, GLsizei height, gpu_category category,
+			     const char *tag)
+{
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format, width, height);
+    std::size_t bytes = std::size_t(width) * height * std::max(samples, 1) *
+			render_target_pool::format_bytes(format);
+    gpu_memory::get().allocated(gpu_object::renderbuffer, renderbuffer, bytes, category, tag);
+}
+
+void
+tracked_texture(GLuint texture, std::size_t bytes, gpu_category category, const char *tag,
+		std::function<void()> evict)
+{
+    gpu_memory::get().allocated(gpu_object::texture, texture, bytes, category, tag,
+				std::move(evict));
+}
+
+void
+tracked_delete_buffers(GLsizei n, const GLuint *buffers)
+{
+    for (GLsizei i = 0; i < n; i++)
+	if (buffers[i]) gpu_memory::get().released(gpu_object::buffer, buffers[i]);
+    glDeleteBuffers(n, buffers);
+}
+
+void
+tracked_delete_textures(GLsizei n, const GLuint *textures)
+{
+    for (GLsizei i = 0; i < n; i++)
+	if (textures[i]) gpu_memory::get().released(gpu_object::texture, textures[i]);
+    glDeleteTextures(n, textures);
+}
+
+void
+tracked_delete_renderbuffers(GLsizei n, const GLuint *renderbuffers)
+{
+    for (GLsizei i = 0; i < n; i++)
+	if (renderbuffers[i])
+	    gpu_memory::get().released(gpu_object::renderbuffer, renderbuffers[i]);
+    glDeleteRenderbuffers(n, renderbuffers);
+}
@@ -0,0 +1,152 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// gpu_memory.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Accounting of the gpu memory of buffers, textures and renderbuffers, with a budget that
+// evicts the least recently used streamable textures
+
+#ifndef GPU_MEMORY_H
+#define GPU_MEMORY_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+// what the memory is for, each with its own totals
+enum class gpu_category { vertices, indices, textures, targets, staging, other };
+constexpr int num_gpu_categories = 6;
+
+const char *gpu_category_name(gpu_category category);
+
+enum class gpu_object { buffer, texture, renderbuffer };
+
+// The driver does not tell us what our objects cost, so we count what we ask for : the size
+// of each buffer store, the levels of each texture and the samples of each renderbuffer, give
+// or take the padding. Every object is recorded under a category and a tag, the tag names its
+// owner ("grid", "scene_msaa"), and the totals of both are kept with their peaks.
+//
+// With a budget, recording an allocation that goes over it evicts the streamable objects
+// least recently used, those recorded with an evict function, which gives the memory back and
+// forgets the object. The owner restores it when it is needed again. Objects used in this
+// frame are never evicted, if the rest is not enough the frame is counted as over budget.
+//
+// There is one tracker for the process, like the context it watches, so the classes that
+// allocate report to it without being handed it. It is only called from the thread that owns
+// the context.
+
+class gpu_memory {
+   public:
+    static gpu_memory &get();
+
+    gpu_memory(const gpu_memory &) = delete;
+    gpu_memory &operator=(const gpu_memory &) = delete;
+
+    // 0 for none, a lower budget evicts at once
+    void set_budget(std::size_t bytes);
+    std::size_t budget() const { return budget_; }
+
+    // record the storage of an object, an object recorded again is resized, evict makes it
+    // streamable
+    void allocated(gpu_object kind, GLuint id, std::size_t bytes, gpu_category category,
+		   const char *tag, std::function<void()> evict = nullptr);
+
+    // forget an object, its storage is gone
+    void released(gpu_object kind, GLuint id);
+
+    // the object is drawn with this frame, the most recently used of the streamable ones
+    void used(gpu_object kind, GLuint id);
+
+    // once a frame, evicts down to the budget and samples what the driver says is free
+    void end_frame();
+
+    std::size_t bytes() const { return all_.bytes; }
+    std::size_t peak_bytes() const { return all_.peak_bytes; }
+    std::size_t category_bytes(gpu_category category) const
+    {
+	return categories_[int(category)].bytes;
+    }
+    unsigned long evictions() const { return evictions_; }
+
+    // print the totals by category and by tag, the evictions, and the driver's numbers if it
+    // has GL_NVX_gpu_memory_info or GL_ATI_meminfo, one stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    gpu_memory() = default;
+
+    struct totals {
+	std::size_t bytes = 0, peak_bytes = 0;
+	unsigned long objects = 0, allocations = 0;
+    };
+
+    using key = std::uint64_t;
+
+    struct entry {
+	gpu_object kind;
+	GLuint id;
+	std::size_t bytes;
+	gpu_category category;
+	std::string tag;
+	std::function<void()> evict;
+	unsigned long used_frame;
+	// place in lru_, only if streamable
+	std::list<key>::iterator lru;
+    };
+
+    static key key_of(gpu_object kind, GLuint id) { return key(kind) << 32 | id; }
+
+    void add(totals &t, std::size_t bytes);
+    void remove(totals &t, std::size_t bytes);
+
+    // evict the least recently used streamable objects until the total is within the budget,
+    // but not keep
+    void enforce_budget(key keep);
+
+    void sample_driver();
+
+    std::size_t budget_ = 0;
+    std::unordered_map<key, entry> entries_;
+    // streamable objects, least recently used first
+    std::list<key> lru_;
+
+    totals all_;
+    totals categories_[num_gpu_categories];
+    std::map<std::string, totals> tags_;
+
+    unsigned long frame_ = 1, evictions_ = 0, over_budget_frames_ = 0;
+    std::size_t evicted_bytes_ = 0;
+
+    // what the driver says, in KiB, -1 for not known, through the extension named
+    const char *driver_ = "none";
+    long driver_dedicated_kib_ = -1, driver_total_kib_ = -1, driver_available_min_kib_ = -1;
+    long driver_evictions_ = -1, driver_evicted_kib_ = -1;
+};
+
+// Allocations through the tracker, each the GL call and its record
+
+// glBufferData on buffer, which is bound to target, buffers given a new store are resized
+void tracked_buffer_data(GLenum target, GLuint buffer, GLsizeiptr size, const void *data,
+			 GLenum usage, gpu_category category, const char *tag);
+
+// glRenderbufferStorageMultisample on renderbuffer, which is bound, 0 samples for one
+void tracked_renderbuffer_storage(GLuint renderbuffer, GLsizei samples, GLenum format,
+				  GLsizei width, GLsizei height, gpu_category category,
+				  const char *tag);
+
+// a texture whose storage the caller allocated, of bytes for all its levels and layers
+void tracked_texture(GLuint texture, std::size_t bytes, gpu_category category,
+		     const char *tag, std::function<void()> evict = nullptr);
+
+// delete and forget, names of 0 are skipped
+void tracked_delete_buffers(GLsizei n, const GLuint *buffers);
+void tracked_delete_textures(GLsizei n, const GLuint *textures);
+void tracked_delete_renderbuffers(GLsizei n, const GLuint *renderbuffers);
+
+#endif	// GPU_MEMORY_H
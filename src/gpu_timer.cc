@@ -0,0 +1,67 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	gpu_timer.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	GPU timing with GL_TIME_ELAPSED queries
+
+#include "gpu_timer.h"
+
+#include <algorithm>
+
+gpu_timer::gpu_timer(int depth)
+    : supported_(GLEW_VERSION_3_3 || GLEW_ARB_timer_query),
+      depth_(std::min(std::max(depth, 1), max_depth))
+{
+    if (supported_) glGenQueries(depth_, queries_);
+}
+
+gpu_timer::~gpu_timer()
+{
+    if (supported_) glDeleteQueries(depth_, queries_);
+}
+
+void
+gpu_timer::begin(int tag)
+{
+    if (!supported_ || open_) return;
+
+    if (count_ == depth_) {
+	skipped_++;
+	return;
+    }
+
+    int slot = (head_ + count_) % depth_;
+    tags_[slot] = tag;
+    glBeginQuery(GL_TIME_ELAPSED, queries_[slot]);
+    open_ = true;
+}
+
+void
+gpu_timer::end()
+{
+    if (!open_) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    open_ = false;
+    count_++;
+}
+
+bool
+gpu_timer::poll(double &ms, int &tag)
+{
+    if (!count_) return false;
+
+    // results become available in order, so the oldest one is the only one worth checking
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(queries_[head_], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return false;
+
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(queries_[head_], GL_QUERY_RESULT, &ns);
+    ms = double(ns) * 1e-6;
+    tag = tags_[head_];
+
+    head_ = (head_ + 1) % depth_;
+    count_--;
+    return true;
+}
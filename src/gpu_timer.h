@@ -0,0 +1,55 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// gpu_timer.h v0.0 (Simple OpenGL Code Snippets)
+//
+// GPU timing with GL_TIME_ELAPSED queries, without stalling the pipeline
+
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <GL/glew.h>
+
+// The gpu finishes a frame long after we have submitted it, so asking for a query result right
+// away would make the cpu wait for the gpu. The timer keeps a ring of queries in flight and
+// hands back the results that are ready, each with the tag it was started with, so the caller
+// can attribute a result to whatever it was timing frames ago. When all queries are in flight
+// the measurement is skipped rather than waited for.
+
+class gpu_timer {
+   public:
+    // depth : number of queries that can be in flight
+    explicit gpu_timer(int depth = 8);
+    ~gpu_timer();
+
+    gpu_timer(const gpu_timer &) = delete;
+    gpu_timer &operator=(const gpu_timer &) = delete;
+
+    // false if the context has no timer queries (needs 3.3 or ARB_timer_query)
+    bool supported() const { return supported_; }
+
+    // bracket the commands to time, only one measurement can be open at a time
+    void begin(int tag);
+    void end();
+
+    // the oldest finished measurement, if there is one, in milliseconds
+    bool poll(double &ms, int &tag);
+
+    // measurements skipped because all queries were in flight
+    unsigned long skipped() const { return skipped_; }
+
+   private:
+    static constexpr int max_depth = 32;
+
+    bool supported_;
+    int depth_;
+    GLuint queries_[max_depth] = {};
+    int tags_[max_depth] = {};
+
+    // ring of queries in flight, oldest at head_
+    int head_ = 0, count_ = 0;
+    bool open_ = false;
+
+    unsigned long skipped_ = 0;
+};
+
+#endif	// GPU_TIMER_H
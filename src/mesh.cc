@@ -0,0 +1,195 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	mesh.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Indexed triangle meshes with a chain of levels of detail, loaded from OBJ files or
+//	generated
+
+#include "mesh.h"
+
+#include "mesh_simplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+/*
+ * add_level() : append a level of detail, with colours from the area weighted normals of its
+ * vertices
+ *
+ * positions, indices : xyz a vertex, three indices a triangle, from 0
+ * error : of the level, in the units of the positions
+ */
+
+static void
+add_level(mesh &m, const std::vector<float> &positions, const std::vector<unsigned> &indices,
+	  float error)
+{
+    std::size_t count = positions.size() / 3;
+    std::vector<float> normals(positions.size(), 0.0f);
+    for (std::size_t t = 0; t + 2 < indices.size(); t += 3) {
+	const float *p0 = &positions[3 * indices[t]], *p1 = &positions[3 * indices[t + 1]],
+		    *p2 = &positions[3 * indices[t + 2]];
+	float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+	float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+	float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+		      e1[0] * e2[1] - e1[1] * e2[0]};
+	for (int k = 0; k < 3; k++)
+	    for (int i = 0; i < 3; i++) normals[3 * indices[t + k] + i] += n[i];
+    }
+
+    GLuint base = GLuint(m.vertices.size() / 6);
+    m.vertices.reserve(m.vertices.size() + count * 6);
+    for (std::size_t v = 0; v < count; v++) {
+	const float *n = &normals[3 * v];
+	float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if (len == 0.0f) len = 1.0f;
+	m.vertices.insert(m.vertices.end(),
+			  {positions[3 * v], positions[3 * v + 1], positions[3 * v + 2],
+			   n[0] / len * 0.5f + 0.5f, n[1] / len * 0.5f + 0.5f,
+			   n[2] / len * 0.5f + 0.5f});
+    }
+
+    mesh_lod lod = {GLuint(m.indices.size()), GLsizei(indices.size()), error};
+    for (unsigned i : indices) m.indices.push_back(base + i);
+    m.lods.push_back(lod);
+}
+
+mesh
+load_obj(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open mesh " + path);
+
+    std::vector<float> positions;
+    std::vector<unsigned> indices;
+    std::string line;
+    while (std::getline(in, line)) {
+	std::istringstream ls(line);
+	std::string tag;
+	ls >> tag;
+	if (tag == "v") {
+	    float x, y, z;
+	    if (!(ls >> x >> y >> z)) throw std::runtime_error("bad vertex in " + path);
+	    positions.insert(positions.end(), {x, y, z});
+	}
+	else if (tag == "f") {
+	    // v, v/vt, v//vn or v/vt/vn, from 1, or from the end if negative
+	    std::vector<unsigned> face;
+	    std::string corner;
+	    while (ls >> corner) {
+		long i = std::strtol(corner.c_str(), nullptr, 10);
+		long count = long(positions.size() / 3);
+		if (i < 0) i += count + 1;
+		if (i < 1 || i > count) throw std::runtime_error("bad face in " + path);
+		face.push_back(unsigned(i - 1));
+	    }
+	    for (std::size_t k = 2; k < face.size(); k++)
+		indices.insert(indices.end(), {face[0], face[k - 1], face[k]});
+	}
+    }
+    if (indices.empty()) throw std::runtime_error("no triangles in " + path);
+
+    // into the unit sphere, around the centre of the bounding box
+    float lo[3] = {1e30f, 1e30f, 1e30f}, hi[3] = {-1e30f, -1e30f, -1e30f};
+    for (std::size_t v = 0; v < positions.size(); v += 3) {
+	for (int i = 0; i < 3; i++) {
+	    lo[i] = std::min(lo[i], positions[v + i]);
+	    hi[i] = std::max(hi[i], positions[v + i]);
+	}
+    }
+    float centre[3] = {(lo[0] + hi[0]) * 0.5f, (lo[1] + hi[1]) * 0.5f, (lo[2] + hi[2]) * 0.5f};
+    float radius = 0.0f;
+    for (std::size_t v = 0; v < positions.size(); v += 3) {
+	float d = 0.0f;
+	for (int i = 0; i < 3; i++) {
+	    positions[v + i] -= centre[i];
+	    d += positions[v + i] * positions[v + i];
+	}
+	radius = std::max(radius, std::sqrt(d));
+    }
+    if (radius > 0.0f)
+	for (float &p : positions) p /= radius;
+
+    mesh m;
+    add_level(m, positions, indices, 0.0f);
+    return m;
+}
+
+mesh
+sphere_mesh(int rings, int segments)
+{
+    rings = std::max(rings, 2);
+    segments = std::max(segments, 3);
+
+    // the poles and rings - 1 rings of segments vertices in between, closed so that the
+    // simplifier sees no boundary
+    std::vector<float> positions = {0.0f, 1.0f, 0.0f};
+    std::vector<unsigned> indices;
+    const float pi = 3.14159265358979f;
+    for (int r = 1; r < rings; r++) {
+	float phi = pi * r / rings;
+	for (int s = 0; s < segments; s++) {
+	    float theta = 2.0f * pi * s / segments;
+	    positions.insert(positions.end(), {std::sin(phi) * std::cos(theta), std::cos(phi),
+					       std::sin(phi) * std::sin(theta)});
+	}
+    }
+    positions.insert(positions.end(), {0.0f, -1.0f, 0.0f});
+
+    auto ring = [segments](int r, int s) {
+	return unsigned(1 + (r - 1) * segments + s % segments);
+    };
+    unsigned bottom = unsigned(positions.size() / 3 - 1);
+    for (int s = 0; s < segments; s++) {
+	indices.insert(indices.end(), {0, ring(1, s + 1), ring(1, s)});
+	for (int r = 1; r + 1 < rings; r++) {
+	    indices.insert(indices.end(), {ring(r, s), ring(r, s + 1), ring(r + 1, s)});
+	    indices.insert(indices.end(),
+			   {ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s)});
+	}
+	indices.insert(indices.end(), {ring(rings - 1, s), ring(rings - 1, s + 1), bottom});
+    }
+
+    mesh m;
+    add_level(m, positions, indices, 0.0f);
+    return m;
+}
+
+void
+build_lods(mesh &m, int max_lods, double ratio, std::size_t min_triangles)
+{
+    if (m.lods.size() != 1) throw std::runtime_error("levels of detail built twice");
+
+    // the finest level, back to positions and indices from 0
+    const mesh_lod &finest = m.lods[0];
+    std::vector<float> positions;
+    for (std::size_t v = 0; v < m.vertices.size(); v += 6)
+	positions.insert(positions.end(),
+			 {m.vertices[v], m.vertices[v + 1], m.vertices[v + 2]});
+    std::vector<unsigned> indices(m.indices.begin() + finest.first_index,
+				  m.indices.begin() + finest.first_index + finest.index_count);
+
+    std::vector<std::size_t> targets;
+    double count = double(indices.size() / 3);
+    for (int i = 1; i < max_lods; i++) {
+	count *= ratio;
+	if (count < double(min_triangles)) break;
+	targets.push_back(std::size_t(count));
+    }
+
+    for (const simplified_mesh &level : simplify_mesh(positions, indices, targets))
+	add_level(m, level.positions, level.indices, level.error);
+}
+
+std::size_t
+select_lod(const mesh &m, double pixels_per_unit, double max_error_px)
+{
+    std::size_t lod = 0;
+    while (lod + 1 < m.lods.size() && m.lods[lod + 1].error * pixels_per_unit <= max_error_px)
+	lod++;
+    return lod;
+}
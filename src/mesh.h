@@ -0,0 +1,50 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// mesh.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Indexed triangle meshes with a chain of levels of detail, loaded from OBJ files or generated
+
+#ifndef MESH_H
+#define MESH_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// one level of detail, a range of the index buffer
+struct mesh_lod {
+    GLuint first_index;
+    GLsizei index_count;
+    // how far it strays from the finest level, in the units of the positions
+    float error;
+};
+
+// A mesh scaled into the unit sphere around the origin, with all its levels of detail in one
+// vertex buffer and one index buffer, finest first. The vertices have a position and a
+// colour, six floats, as the pinwheel has; the colour shows the direction of the normal.
+struct mesh {
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+    std::vector<mesh_lod> lods;
+
+    std::size_t triangles(std::size_t lod) const { return lods[lod].index_count / 3; }
+};
+
+// the v and f lines of a Wavefront OBJ file, polygons as fans, throws if it cannot be read
+extern mesh load_obj(const std::string &path);
+
+// a uv sphere, for when there is no file
+extern mesh sphere_mesh(int rings, int segments);
+
+// append coarser levels to a mesh with only the finest one, each with ratio times the
+// triangles of the one before, until there are max_lods or one has fewer than min_triangles
+extern void build_lods(mesh &m, int max_lods = 8, double ratio = 0.5,
+		       std::size_t min_triangles = 32);
+
+// the coarsest level whose error stays under max_error_px pixels, when one unit of the mesh
+// covers pixels_per_unit pixels on the screen
+extern std::size_t select_lod(const mesh &m, double pixels_per_unit, double max_error_px);
+
+#endif	// MESH_H
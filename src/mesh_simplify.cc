@@ -0,0 +1,289 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	mesh_simplify.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Triangle mesh simplification by quadric error edge collapses
+
+#include "mesh_simplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+
+struct vec3d {
+    double x, y, z;
+};
+
+static vec3d
+operator-(const vec3d &a, const vec3d &b)
+{
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+static vec3d
+cross(const vec3d &a, const vec3d &b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+static double
+dot(const vec3d &a, const vec3d &b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// sum of weighted squared distances to planes ax + by + cz + d = 0, the symmetric 4x4 matrix
+// of the plane coefficients by rows of its upper triangle
+struct quadric {
+    double q[10] = {};
+    double weight = 0.0;
+
+    void add_plane(const vec3d &n, double d, double w)
+    {
+	double p[4] = {n.x, n.y, n.z, d};
+	for (int i = 0, k = 0; i < 4; i++)
+	    for (int j = i; j < 4; j++) q[k++] += w * p[i] * p[j];
+	weight += w;
+    }
+
+    quadric &operator+=(const quadric &o)
+    {
+	for (int i = 0; i < 10; i++) q[i] += o.q[i];
+	weight += o.weight;
+	return *this;
+    }
+
+    double error(const vec3d &v) const
+    {
+	return q[0] * v.x * v.x + 2 * q[1] * v.x * v.y + 2 * q[2] * v.x * v.z +
+	       2 * q[3] * v.x + q[4] * v.y * v.y + 2 * q[5] * v.y * v.z + 2 * q[6] * v.y +
+	       q[7] * v.z * v.z + 2 * q[8] * v.z + q[9];
+    }
+
+    // the point of least error, false if the planes do not pin one down
+    bool optimum(vec3d &v) const
+    {
+	double a = q[0], b = q[1], c = q[2], e = q[4], f = q[5], i = q[7];
+	double det = a * (e * i - f * f) - b * (b * i - f * c) + c * (b * f - e * c);
+	double scale = std::max({std::fabs(a), std::fabs(e), std::fabs(i)});
+	if (std::fabs(det) <= 1e-10 * scale * scale * scale) return false;
+
+	// Cramer's rule on the top left 3x3 against the negated last column
+	double r0 = -q[3], r1 = -q[6], r2 = -q[8];
+	v.x = (r0 * (e * i - f * f) - b * (r1 * i - f * r2) + c * (r1 * f - e * r2)) / det;
+	v.y = (a * (r1 * i - f * r2) - r0 * (b * i - f * c) + c * (b * r2 - r1 * c)) / det;
+	v.z = (a * (e * r2 - r1 * f) - b * (b * r2 - r1 * c) + r0 * (b * f - e * c)) / det;
+	return true;
+    }
+};
+
+// a candidate collapse, stale once either vertex changed after it was queued
+struct collapse {
+    double cost;
+    unsigned a, b;
+    unsigned stamp_a, stamp_b;
+
+    bool operator>(const collapse &o) const { return cost > o.cost; }
+};
+
+// boundary planes count this much more than the triangles, so that outlines stay put
+static const double boundary_weight = 100.0;
+
+// where the collapse of an edge puts the merged vertex, and its cost
+static vec3d
+place_collapse(const quadric &q, const vec3d &a, const vec3d &b, double &cost)
+{
+    vec3d mid = {(a.x + b.x) * 0.5, (a.y + b.y) * 0.5, (a.z + b.z) * 0.5};
+
+    // the optimum of a nearly flat neighbourhood can be far off, it is only trusted near
+    // the edge
+    vec3d v;
+    if (q.optimum(v)) {
+	vec3d d = v - mid, e = b - a;
+	if (dot(d, d) <= dot(e, e)) {
+	    cost = std::max(q.error(v), 0.0);
+	    return v;
+	}
+    }
+
+    vec3d best = mid;
+    cost = std::max(q.error(mid), 0.0);
+    for (const vec3d &c : {a, b}) {
+	double e = std::max(q.error(c), 0.0);
+	if (e < cost) {
+	    cost = e;
+	    best = c;
+	}
+    }
+    return best;
+}
+
+std::vector<simplified_mesh>
+simplify_mesh(const std::vector<float> &positions, const std::vector<unsigned> &indices,
+	      const std::vector<std::size_t> &targets)
+{
+    std::size_t num_vertices = positions.size() / 3, num_triangles = indices.size() / 3;
+
+    std::vector<vec3d> pos(num_vertices);
+    for (std::size_t i = 0; i < num_vertices; i++)
+	pos[i] = {positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]};
+
+    std::vector<unsigned> tris(indices);
+    std::vector<char> alive(num_triangles, 1);
+    std::vector<std::vector<unsigned>> vertex_tris(num_vertices);
+    std::vector<quadric> quadrics(num_vertices);
+    std::vector<unsigned> stamps(num_vertices, 0);
+
+    // the planes of the triangles, weighted by area, and the number of triangles on each edge
+    std::unordered_map<std::uint64_t, int> edge_uses;
+    auto edge_key = [](unsigned a, unsigned b) {
+	return std::uint64_t(std::min(a, b)) << 32 | std::max(a, b);
+    };
+    for (std::size_t t = 0; t < num_triangles; t++) {
+	const unsigned *v = &tris[3 * t];
+	vec3d n = cross(pos[v[1]] - pos[v[0]], pos[v[2]] - pos[v[0]]);
+	double len = std::sqrt(dot(n, n));
+	for (int k = 0; k < 3; k++) {
+	    vertex_tris[v[k]].push_back(unsigned(t));
+	    edge_uses[edge_key(v[k], v[(k + 1) % 3])]++;
+	}
+	if (len == 0.0) continue;
+
+	n = {n.x / len, n.y / len, n.z / len};
+	for (int k = 0; k < 3; k++) quadrics[v[k]].add_plane(n, -dot(n, pos[v[0]]), len * 0.5);
+    }
+
+    // a plane through each boundary edge, perpendicular to its triangle
+    for (std::size_t t = 0; t < num_triangles; t++) {
+	const unsigned *v = &tris[3 * t];
+	vec3d n = cross(pos[v[1]] - pos[v[0]], pos[v[2]] - pos[v[0]]);
+	for (int k = 0; k < 3; k++) {
+	    unsigned a = v[k], b = v[(k + 1) % 3];
+	    if (edge_uses[edge_key(a, b)] != 1) continue;
+
+	    vec3d e = pos[b] - pos[a];
+	    vec3d p = cross(e, n);
+	    double len = std::sqrt(dot(p, p));
+	    if (len == 0.0) continue;
+
+	    p = {p.x / len, p.y / len, p.z / len};
+	    double w = boundary_weight * dot(e, e);
+	    quadrics[a].add_plane(p, -dot(p, pos[a]), w);
+	    quadrics[b].add_plane(p, -dot(p, pos[a]), w);
+	}
+    }
+
+    std::priority_queue<collapse, std::vector<collapse>, std::greater<collapse>> queue;
+    auto push = [&](unsigned a, unsigned b) {
+	quadric q = quadrics[a];
+	q += quadrics[b];
+	double cost;
+	place_collapse(q, pos[a], pos[b], cost);
+	queue.push({cost, a, b, stamps[a], stamps[b]});
+    };
+    for (const auto &edge : edge_uses) push(unsigned(edge.first >> 32), unsigned(edge.first));
+
+    std::vector<simplified_mesh> copies;
+    std::size_t live = num_triangles, next = 0;
+    double max_error = 0.0;
+    std::vector<unsigned> neighbours;
+
+    auto take_copy = [&]() {
+	simplified_mesh copy;
+	std::vector<unsigned> remap(num_vertices, ~0u);
+	for (std::size_t t = 0; t < num_triangles; t++) {
+	    if (!alive[t]) continue;
+	    for (int k = 0; k < 3; k++) {
+		unsigned v = tris[3 * t + k];
+		if (remap[v] == ~0u) {
+		    remap[v] = unsigned(copy.positions.size() / 3);
+		    copy.positions.insert(copy.positions.end(),
+					  {float(pos[v].x), float(pos[v].y), float(pos[v].z)});
+		}
+		copy.indices.push_back(remap[v]);
+	    }
+	}
+	copy.error = float(max_error);
+	copies.push_back(std::move(copy));
+    };
+
+    while (next < targets.size() && !queue.empty()) {
+	if (live <= targets[next]) {
+	    take_copy();
+	    next++;
+	    continue;
+	}
+
+	collapse c = queue.top();
+	queue.pop();
+	if (c.stamp_a != stamps[c.a] || c.stamp_b != stamps[c.b]) continue;
+
+	quadric q = quadrics[c.a];
+	q += quadrics[c.b];
+	double cost;
+	vec3d v = place_collapse(q, pos[c.a], pos[c.b], cost);
+
+	// a triangle keeping one of the two vertices must not turn over, or shrink to nothing
+	bool flips = false;
+	for (unsigned from : {c.a, c.b}) {
+	    for (unsigned t : vertex_tris[from]) {
+		if (!alive[t]) continue;
+		const unsigned *tv = &tris[3 * t];
+		if (std::count(tv, tv + 3, c.a) + std::count(tv, tv + 3, c.b) > 1) continue;
+
+		vec3d p[3], moved[3];
+		for (int k = 0; k < 3; k++) {
+		    p[k] = pos[tv[k]];
+		    moved[k] = tv[k] == from ? v : p[k];
+		}
+		vec3d before = cross(p[1] - p[0], p[2] - p[0]);
+		vec3d after = cross(moved[1] - moved[0], moved[2] - moved[0]);
+		if (dot(before, after) <= 1e-3 * dot(before, before)) flips = true;
+	    }
+	}
+	if (flips) continue;
+
+	// b merges into a, the triangles on the edge go away
+	pos[c.a] = v;
+	quadrics[c.a] = q;
+	for (unsigned t : vertex_tris[c.b]) {
+	    if (!alive[t]) continue;
+	    unsigned *tv = &tris[3 * t];
+	    for (int k = 0; k < 3; k++)
+		if (tv[k] == c.b) tv[k] = c.a;
+	    if (tv[0] == tv[1] || tv[1] == tv[2] || tv[0] == tv[2]) {
+		alive[t] = 0;
+		live--;
+	    }
+	    else {
+		vertex_tris[c.a].push_back(t);
+	    }
+	}
+	vertex_tris[c.b].clear();
+	vertex_tris[c.b].shrink_to_fit();
+	std::vector<unsigned> &around = vertex_tris[c.a];
+	around.erase(std::remove_if(around.begin(), around.end(),
+				    [&alive](unsigned t) { return !alive[t]; }),
+		     around.end());
+	stamps[c.a]++;
+	stamps[c.b]++;
+
+	max_error = std::max(max_error, std::sqrt(cost / std::max(q.weight, 1e-30)));
+
+	// the edges around a have new costs
+	neighbours.clear();
+	for (unsigned t : around)
+	    for (int k = 0; k < 3; k++)
+		if (tris[3 * t + k] != c.a) neighbours.push_back(tris[3 * t + k]);
+	std::sort(neighbours.begin(), neighbours.end());
+	neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+	for (unsigned n : neighbours) push(c.a, n);
+    }
+
+    // the last collapse may have been the one that reached the target
+    if (next < targets.size() && live <= targets[next]) take_copy();
+
+    return copies;
+}
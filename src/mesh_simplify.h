@@ -0,0 +1,36 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// mesh_simplify.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Triangle mesh simplification by quadric error edge collapses
+
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <cstddef>
+#include <vector>
+
+// A simplified mesh, positions xyz and three indices a triangle, and how far it strays from
+// the original, roughly, in the units of the positions.
+struct simplified_mesh {
+    std::vector<float> positions;
+    std::vector<unsigned> indices;
+    float error = 0.0f;
+};
+
+// Garland and Heckbert's simplification: every vertex keeps a quadric, the sum of the squared
+// distances to the planes of the triangles around it, weighted by their area, and the edge
+// whose collapse into a single vertex adds the least error goes first, the new vertex at the
+// point that minimizes the summed quadric. Boundary edges get planes perpendicular to their
+// triangle, so that open meshes keep their outline, and collapses that would flip a triangle
+// are skipped.
+//
+// The collapses run once, from the finest mesh to the coarsest, and a copy is taken whenever
+// the triangle count falls to the next of targets, which have to be in decreasing order. The
+// error of a copy is the largest of its collapses, the root of the quadric error over the area
+// it was summed over. Fewer copies come back if the mesh cannot be simplified that far.
+extern std::vector<simplified_mesh> simplify_mesh(const std::vector<float> &positions,
+						  const std::vector<unsigned> &indices,
+						  const std::vector<std::size_t> &targets);
+
+#endif	// MESH_SIMPLIFY_H
@@ -0,0 +1,92 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// object_pool.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Pool of nodes of one type for long lived objects, allocated in slabs and reused
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// The nodes of a scene, render targets and the like, live for many frames but come and go,
+// each a new and a delete from the heap, scattered over it. The pool takes them from slabs of
+// per_slab nodes, side by side, and keeps the destroyed ones in a free list, so that a node
+// that goes is the next one to come, and the heap is only asked for a slab when all the nodes
+// are taken. Slabs are never given back before the pool goes, its objects have to be
+// destroyed by then.
+
+template <typename T>
+class object_pool {
+   public:
+    explicit object_pool(std::size_t per_slab = 64) : per_slab_(per_slab ? per_slab : 1) {}
+
+    object_pool(const object_pool &) = delete;
+    object_pool &operator=(const object_pool &) = delete;
+
+    // a T constructed from args in a free node, if the constructor throws the node stays free
+    template <typename... Args>
+    T *
+    create(Args &&...args)
+    {
+	if (!free_) add_slab();
+	// the object is built over the link, which is put back if it fails half way
+	node *n = free_;
+	node *next = n->next;
+	T *object;
+	try {
+	    object = new (n->storage) T(std::forward<Args>(args)...);
+	}
+	catch (...) {
+	    n->next = next;
+	    throw;
+	}
+	free_ = next;
+	live_++;
+	return object;
+    }
+
+    // destroy an object of this pool, its node is the next to be handed out
+    void
+    destroy(T *object)
+    {
+	if (!object) return;
+	object->~T();
+	node *n = reinterpret_cast<node *>(object);
+	n->next = free_;
+	free_ = n;
+	live_--;
+    }
+
+    std::size_t live() const { return live_; }
+    std::size_t capacity() const { return slabs_.size() * per_slab_; }
+    std::size_t slabs() const { return slabs_.size(); }
+
+   private:
+    union node {
+	node *next;
+	alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    void
+    add_slab()
+    {
+	slabs_.emplace_back(new node[per_slab_]);
+	node *slab = slabs_.back().get();
+	for (std::size_t i = per_slab_; i-- > 0;) {
+	    slab[i].next = free_;
+	    free_ = &slab[i];
+	}
+    }
+
+    std::size_t per_slab_;
+    std::vector<std::unique_ptr<node[]>> slabs_;
+    node *free_ = nullptr;
+    std::size_t live_ = 0;
+};
+
+#endif	// OBJECT_POOL_H
@@ -0,0 +1,160 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	occlusion_culler.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Occlusion culling with hardware occlusion queries
+
+#include "occlusion_culler.h"
+
+#include "opengl_stuff.h"
+
+// the box as a 14 vertex triangle strip around the unit cube, the corners from the bits of
+// the vertex id, no vertex data
+static const char *box_vertex_src =
+    "#version 330 core\n"
+    "uniform mat4 matrix;\n"
+    "uniform vec3 lo, hi;\n"
+    "void main()\n"
+    "{\n"
+    "   int i = gl_VertexID;\n"
+    "   vec3 corner = vec3((0x287a >> i) & 1, (0x02af >> i) & 1, (0x31e3 >> i) & 1);\n"
+    "   gl_Position = matrix * vec4(mix(lo, hi, corner), 1.0);\n"
+    "}\n";
+
+static const char *box_fragment_src =
+    "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = vec4(1.0);\n"
+    "}\n";
+
+static GLenum
+best_query_target()
+{
+    if (GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility)
+	return GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+    if (GLEW_VERSION_3_3 || GLEW_ARB_occlusion_query2) return GL_ANY_SAMPLES_PASSED;
+    return GL_SAMPLES_PASSED;
+}
+
+occlusion_culler::occlusion_culler() : target_(best_query_target())
+{
+    program_ = build_program(box_vertex_src, box_fragment_src, "occlusion boxes");
+    matrix_loc_ = glGetUniformLocation(program_, "matrix");
+    lo_loc_ = glGetUniformLocation(program_, "lo");
+    hi_loc_ = glGetUniformLocation(program_, "hi");
+
+    glGenVertexArrays(1, &empty_vao_);
+}
+
+occlusion_culler::~occlusion_culler()
+{
+    for (const object &o : objects_)
+	if (o.query) glDeleteQueries(1, &o.query);
+    glDeleteVertexArrays(1, &empty_vao_);
+    glDeleteProgram(program_);
+}
+
+void
+occlusion_culler::draw(const std::vector<unsigned> &candidates, const std::vector<aabb> &boxes,
+		       const float matrix[16], const std::function<void(unsigned)> &draw_object)
+{
+    if (objects_.size() < boxes.size()) objects_.resize(boxes.size());
+    drawn_ = conditional_ = culled_ = 0;
+    hidden_.clear();
+
+    for (unsigned i : candidates) {
+	object &o = objects_[i];
+
+	// the result of the query in flight, if the gpu has it by now
+	if (o.pending) {
+	    GLuint available = GL_FALSE;
+	    glGetQueryObjectuiv(o.query, GL_QUERY_RESULT_AVAILABLE, &available);
+	    if (available) {
+		GLuint samples = 0;
+		glGetQueryObjectuiv(o.query, GL_QUERY_RESULT, &samples);
+		o.visible = samples != 0;
+		o.pending = false;
+	    }
+	}
+
+	if (o.pending) {
+	    // still in flight, the gpu decides when it gets there
+	    glBeginConditionalRender(o.query, GL_QUERY_NO_WAIT);
+	    draw_object(i);
+	    glEndConditionalRender();
+	    conditional_++;
+	}
+	else if (o.visible) {
+	    // drawn, and its own samples tell whether it still is visible
+	    if (!o.query) glGenQueries(1, &o.query);
+	    glBeginQuery(target_, o.query);
+	    draw_object(i);
+	    glEndQuery(target_);
+	    o.pending = true;
+	    drawn_++;
+	}
+	else {
+	    hidden_.push_back(i);
+	}
+    }
+
+    // the boxes of the hidden objects, against the depth of everything drawn above
+    if (!hidden_.empty()) {
+	GLint program = 0, vao = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glUseProgram(program_);
+	glUniformMatrix4fv(matrix_loc_, 1, GL_FALSE, matrix);
+	glBindVertexArray(empty_vao_);
+	for (unsigned i : hidden_) {
+	    object &o = objects_[i];
+	    glUniform3fv(lo_loc_, 1, boxes[i].lo);
+	    glUniform3fv(hi_loc_, 1, boxes[i].hi);
+	    glBeginQuery(target_, o.query);
+	    glDrawArrays(GL_TRIANGLE_STRIP, 0, 14);
+	    glEndQuery(target_);
+	    o.pending = true;
+	    culled_++;
+	}
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	glUseProgram(GLuint(program));
+	glBindVertexArray(GLuint(vao));
+    }
+
+    frames_++;
+    drawn_total_ += drawn_;
+    conditional_total_ += conditional_;
+    culled_total_ += culled_;
+}
+
+void
+occlusion_culler::reset()
+{
+    // a query in flight can be started again, its old result is dropped then
+    for (object &o : objects_) {
+	o.pending = false;
+	o.visible = true;
+    }
+}
+
+void
+occlusion_culler::report(std::ostream &out) const
+{
+    const char *name = "samples";
+    if (target_ == GL_ANY_SAMPLES_PASSED_CONSERVATIVE)
+	name = "any_samples_conservative";
+    else if (target_ == GL_ANY_SAMPLES_PASSED)
+	name = "any_samples";
+    out << "occlusion_query: " << name << std::endl;
+    out << "occlusion_frames: " << frames_ << std::endl;
+    if (!frames_) return;
+    out << "occlusion_drawn_per_frame: " << drawn_total_ / frames_ << std::endl;
+    out << "occlusion_conditional_per_frame: " << conditional_total_ / frames_ << std::endl;
+    out << "occlusion_culled_per_frame: " << culled_total_ / frames_ << std::endl;
+}
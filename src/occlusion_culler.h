@@ -0,0 +1,79 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// occlusion_culler.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Occlusion culling with hardware occlusion queries, reusing the results of earlier frames
+
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <GL/glew.h>
+
+#include <functional>
+#include <ostream>
+#include <vector>
+
+#include "bvh.h"
+
+// Every object has an occlusion query of its own, and is drawn or skipped by what its last
+// finished query said, so that we never wait for the gpu. An object that was visible is drawn
+// inside a new query, and one that was hidden is not drawn, only its bounding box is, with
+// colour and depth writes off, inside a new query, after the visible objects have filled the
+// depth buffer. An object whose query is still in flight is drawn under conditional rendering,
+// which the gpu skips if the query turns out to have no samples by then, and draws anyway if
+// the result is not there yet. The queries are GL_ANY_SAMPLES_PASSED_CONSERVATIVE where there
+// is 4.3 or ARB_ES3_compatibility, which may err on the side of visible but is cheaper, else
+// GL_ANY_SAMPLES_PASSED, which needs 3.3 or ARB_occlusion_query2, else GL_SAMPLES_PASSED.
+
+class occlusion_culler {
+   public:
+    // needs the context to be current
+    occlusion_culler();
+    ~occlusion_culler();
+
+    occlusion_culler(const occlusion_culler &) = delete;
+    occlusion_culler &operator=(const occlusion_culler &) = delete;
+
+    // Draw the candidates, in their order, front to back culls best, each with draw_object,
+    // which has the program and the vertex array of the scene bound. The boxes are indexed by
+    // object, and matrix, column major, takes them to clip space as the scene program does.
+    // Depth testing has to be on, the bound program and vertex array are kept.
+    void draw(const std::vector<unsigned> &candidates, const std::vector<aabb> &boxes,
+	      const float matrix[16], const std::function<void(unsigned)> &draw_object);
+
+    // forget the results, when the scene or the view changed beyond what a frame late covers
+    void reset();
+
+    // query target, one of the three above
+    GLenum target() const { return target_; }
+
+    // objects of the last frame, drawn with a query, drawn under conditional rendering, and
+    // culled, that is only their box was drawn
+    unsigned long drawn() const { return drawn_; }
+    unsigned long conditional() const { return conditional_; }
+    unsigned long culled() const { return culled_; }
+
+    // print the query target and the counts per frame, one stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    struct object {
+	GLuint query = 0;
+	// a query is in flight, and what the last finished one said
+	bool pending = false, visible = true;
+    };
+
+    GLenum target_;
+    GLuint program_ = 0;
+    GLuint empty_vao_ = 0;
+    GLint matrix_loc_ = -1, lo_loc_ = -1, hi_loc_ = -1;
+
+    std::vector<object> objects_;
+    std::vector<unsigned> hidden_;
+
+    unsigned long drawn_ = 0, conditional_ = 0, culled_ = 0;
+    unsigned long frames_ = 0;
+    double drawn_total_ = 0.0, conditional_total_ = 0.0, culled_total_ = 0.0;
+};
+
+#endif	// OCCLUSION_CULLER_H
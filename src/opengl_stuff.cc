@@ -7,6 +7,8 @@
 #include "opengl_stuff.h"
 
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 
 GLenum
 check_glerror(const char *file, unsigned int line)
@@ -24,7 +26,7 @@ check_glerror(const char *file, unsigned int line)
 	    case GL_STACK_UNDERFLOW:    error = "stack_underflow"; break;
 	    case GL_OUT_OF_MEMORY:      error = "out_of_memory"; break;
 	    case GL_INVALID_FRAMEBUFFER_OPERATION:  
-                                        error = "invalid_framebuffer_operation"; break;
+					error = "invalid_framebuffer_operation"; break;
 	    case GL_CONTEXT_LOST:       error = "context_lost"; break;
 	    default: break;
 	}
@@ -33,3 +35,83 @@ check_glerror(const char *file, unsigned int line)
     return errorCode;
     // clang-format on
 }
+
+GLuint
+compile_shader(GLenum type, const char *src, const char *name)
+{
+    GLuint shader = glCreateShader(type);
+    if (!shader) {
+	throw std::runtime_error(std::string("creation of shader object failed : ") + name);
+    }
+
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+
+    GLint result = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
+    if (result == GL_FALSE) {
+	// get compile log
+	GLsizei log_sz = 0;
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_sz);
+	std::vector<char> info_log(log_sz + 1, '\0');
+	glGetShaderInfoLog(shader, log_sz, nullptr, info_log.data());
+	glDeleteShader(shader);
+
+	throw std::runtime_error(std::string(name) + " compilation failed :\n" +
+				 info_log.data());
+    }
+    return shader;
+}
+
+GLuint
+link_program(const GLuint *shaders, int count, const char *name, bool retrievable,
+	     const char *const *feedback, int feedback_count)
+{
+    GLuint program = glCreateProgram();
+    if (!program) {
+	throw std::runtime_error(std::string("creation of program object failed : ") + name);
+    }
+
+    if (retrievable) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    if (feedback_count)
+	glTransformFeedbackVaryings(program, feedback_count, feedback, GL_INTERLEAVED_ATTRIBS);
+
+    for (int i = 0; i < count; i++) glAttachShader(program, shaders[i]);
+    glLinkProgram(program);
+    for (int i = 0; i < count; i++) glDetachShader(program, shaders[i]);
+
+    GLint result = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (result == GL_FALSE) {
+	// get link log, from the program object, not from a shader object
+	GLsizei log_sz = 0;
+	glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_sz);
+	std::vector<char> info_log(log_sz + 1, '\0');
+	glGetProgramInfoLog(program, log_sz, nullptr, info_log.data());
+	glDeleteProgram(program);
+
+	throw std::runtime_error(std::string(name) + " linking failed :\n" + info_log.data());
+    }
+    return program;
+}
+
+GLuint
+build_program(const char *vertex_src, const char *fragment_src, const char *name)
+{
+    GLuint shaders[2] = {0, 0};
+
+    try {
+	shaders[0] = compile_shader(GL_VERTEX_SHADER, vertex_src, name);
+	shaders[1] = compile_shader(GL_FRAGMENT_SHADER, fragment_src, name);
+	GLuint program = link_program(shaders, 2, name);
+	glDeleteShader(shaders[0]);
+	glDeleteShader(shaders[1]);
+	return program;
+    }
+    catch (...) {
+	// glDeleteShader ignores 0
+	glDeleteShader(shaders[0]);
+	glDeleteShader(shaders[1]);
+	throw;
+    }
+}
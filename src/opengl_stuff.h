@@ -7,10 +7,25 @@
 #ifndef OPENGL_STUFF_H
 #define OPENGL_STUFF_H
 
-#include <GL/gl.h>
+#include <GL/glew.h>
 
 #include <string>
 
-extern GLenum check_glerror(const char *file, int line);
+extern GLenum check_glerror(const char *file, unsigned int line);
+
+// compile a shader object of the given type, throws with the compiler log on failure
+extern GLuint compile_shader(GLenum type, const char *src, const char *name = "shader");
+
+// link the shader objects into a program, throws with the linker log on failure, the shader
+// objects are detached but not deleted. A retrievable program can be saved with
+// glGetProgramBinary, which needs 4.1 or ARB_get_program_binary. The outputs named in
+// feedback are captured by transform feedback, interleaved into one buffer.
+extern GLuint link_program(const GLuint *shaders, int count, const char *name = "program",
+			   bool retrievable = false, const char *const *feedback = nullptr,
+			   int feedback_count = 0);
+
+// compile and link a vertex and fragment shader pair, deleting the shader objects
+extern GLuint build_program(const char *vertex_src, const char *fragment_src,
+			    const char *name = "program");
 
 #endif	// OPENGL_STUFF_H
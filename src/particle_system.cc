@@ -0,0 +1,375 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	particle_system.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Particles updated by a compute shader or transform feedback, drawn instanced
+
+#include "particle_system.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "gpu_memory.h"
+#include "opengl_stuff.h"
+
+// half the side of the quad of a particle
+static const float particle_radius_px = 2.0f;
+
+// The simulation of one particle, shared by both paths. A particle whose time is up, and every
+// particle in the first frame, gets a new one from a hash of its index and the frame, the
+// first ones with only part of their time left, so that they do not all go at once.
+static const char *simulate_src =
+    "uniform float dt, time;\n"
+    "uniform uint frame;\n"
+    "float hash(uint x)\n"
+    "{\n"
+    "   x ^= x >> 16;\n"
+    "   x *= 0x7feb352du;\n"
+    "   x ^= x >> 15;\n"
+    "   x *= 0x846ca68bu;\n"
+    "   x ^= x >> 16;\n"
+    "   return float(x >> 8) * (1.0 / 16777216.0);\n"
+    "}\n"
+    "void simulate(inout vec4 position, inout vec4 velocity, uint id)\n"
+    "{\n"
+    "   position.w -= dt;\n"
+    "   if (frame == 0u || position.w <= 0.0) {\n"
+    "      uint h = id * 747796405u + frame * 2891336453u;\n"
+    "      float a = 1.5708 + (hash(h) - 0.5) * 0.8;\n"
+    "      float speed = 1.2 + 0.8 * hash(h + 1u);\n"
+    "      float life = 1.0 + 2.0 * hash(h + 2u);\n"
+    "      if (frame == 0u) life *= hash(h + 3u);\n"
+    "      position = vec4(0.0, -0.8, 0.0, life);\n"
+    "      velocity = vec4(cos(a) * speed, sin(a) * speed, 0.0, 0.0);\n"
+    "   }\n"
+    "   velocity.x += sin(position.y * 7.0 + time * 2.0) * 0.4 * dt;\n"
+    "   velocity.y -= 1.5 * dt;\n"
+    "   velocity.xy *= 1.0 - 0.2 * dt;\n"
+    "   position.xy += velocity.xy * dt;\n"
+    "   if (position.y < -1.0) {\n"
+    "      position.y = -1.0;\n"
+    "      velocity.y = abs(velocity.y) * 0.5;\n"
+    "   }\n"
+    "}\n";
+
+// in place, a particle per invocation
+static const char *compute_src =
+    "layout(local_size_x = 256) in;\n"
+    "struct particle {\n"
+    "   vec4 position, velocity;\n"
+    "};\n"
+    "layout(std430) buffer particles {\n"
+    "   particle p[];\n"
+    "};\n"
+    "uniform uint count;\n"
+    "void main()\n"
+    "{\n"
+    "   uint id = gl_GlobalInvocationID.x;\n"
+    "   if (id >= count) return;\n"
+    "   vec4 position = p[id].position, velocity = p[id].velocity;\n"
+    "   simulate(position, velocity, id);\n"
+    "   p[id].position = position;\n"
+    "   p[id].velocity = velocity;\n"
+    "}\n";
+
+// from one buffer into the other, a particle per point
+static const char *feedback_head_src =
+    "#version 330 core\n"
+    "layout(location = 0) in vec4 position;\n"
+    "layout(location = 1) in vec4 velocity;\n"
+    "out vec4 next_position, next_velocity;\n";
+
+static const char *feedback_main_src =
+    "void main()\n"
+    "{\n"
+    "   next_position = position;\n"
+    "   next_velocity = velocity;\n"
+    "   simulate(next_position, next_velocity, uint(gl_VertexID));\n"
+    "}\n";
+
+// the particle of the instance, from the instanced attributes at locations 0 and 1
+static const char *draw_attributes_src =
+    "#version 330 core\n"
+    "layout(location = 0) in vec4 position;\n"
+    "layout(location = 1) in vec4 velocity;\n";
+
+// or, without attribute divisors, fetched from the buffer as a texture, two texels a particle
+static const char *draw_fetch_src =
+    "#version 330 core\n"
+    "#define FETCH\n"
+    "uniform samplerBuffer particles;\n"
+    "vec4 position, velocity;\n";
+
+// a quad per instance, a 4 vertex strip from the bits of the vertex id, hotter the faster it
+// goes and fading out in its last second
+static const char *draw_main_src =
+    "uniform vec2 scale;\n"
+    "out vec2 corner;\n"
+    "out vec3 colour;\n"
+    "void main()\n"
+    "{\n"
+    "#ifdef FETCH\n"
+    "   position = texelFetch(particles, gl_InstanceID * 2);\n"
+    "   velocity = texelFetch(particles, gl_InstanceID * 2 + 1);\n"
+    "#endif\n"
+    "   corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;\n"
+    "   float heat = clamp(length(velocity.xy) * 0.6, 0.0, 1.0);\n"
+    "   colour = mix(vec3(0.8, 0.2, 0.05), vec3(1.0, 0.9, 0.5), heat);\n"
+    "   colour *= clamp(position.w, 0.0, 1.0);\n"
+    "   gl_Position = vec4(position.xy + corner * scale, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *draw_fragment_src =
+    "#version 330 core\n"
+    "in vec2 corner;\n"
+    "in vec3 colour;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = vec4(colour * max(1.0 - dot(corner, corner), 0.0), 1.0);\n"
+    "}\n";
+
+// the position and velocity of the bound buffer at locations 0 and 1, a particle per vertex
+// or, with a divisor of 1, per instance, which needs 3.3 or ARB_instanced_arrays
+static void
+particle_attributes(GLuint divisor)
+{
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+			  (void *)(4 * sizeof(float)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    if (!divisor) return;
+    glVertexAttribDivisor(0, divisor);
+    glVertexAttribDivisor(1, divisor);
+}
+
+// compile and link the update program of either path
+static GLuint
+update_program(bool compute)
+{
+    GLenum type = compute ? GL_COMPUTE_SHADER : GL_VERTEX_SHADER;
+    std::string src;
+    if (compute && GLEW_VERSION_4_3) {
+	src = std::string("#version 430 core\n") + simulate_src + compute_src;
+    }
+    else if (compute) {
+	src = std::string("#version 330 core\n"
+			  "#extension GL_ARB_compute_shader : require\n"
+			  "#extension GL_ARB_shader_storage_buffer_object : require\n") +
+	      simulate_src + compute_src;
+    }
+    else {
+	src = std::string(feedback_head_src) + simulate_src + feedback_main_src;
+    }
+
+    const char *outputs[2] = {"next_position", "next_velocity"};
+    GLuint shader = compile_shader(type, src.c_str(), "particle update");
+    try {
+	GLuint program = link_program(&shader, 1, "particle update", false,
+				      compute ? nullptr : outputs, compute ? 0 : 2);
+	glDeleteShader(shader);
+	return program;
+    }
+    catch (...) {
+	glDeleteShader(shader);
+	throw;
+    }
+}
+
+particle_system::particle_system(std::size_t count, bool compute)
+    : count_(count), bytes_(count * 8 * sizeof(float)),
+      compute_(compute && (GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader &&
+						GLEW_ARB_shader_storage_buffer_object))),
+      instanced_(GLEW_VERSION_3_3 || GLEW_ARB_instanced_arrays),
+      timed_(GLEW_VERSION_3_3 || GLEW_ARB_timer_query)
+{
+    if (count_ > max_particles)
+	throw std::runtime_error("too many particles, at most " +
+				 std::to_string(max_particles));
+    if (!instanced_) {
+	GLint texels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &texels);
+	if (count_ * 2 > std::size_t(texels))
+	    throw std::runtime_error("too many particles for a buffer texture, at most " +
+				     std::to_string(texels / 2));
+    }
+
+    update_program_ = update_program(compute_);
+    dt_loc_ = glGetUniformLocation(update_program_, "dt");
+    time_loc_ = glGetUniformLocation(update_program_, "time");
+    frame_loc_ = glGetUniformLocation(update_program_, "frame");
+    count_loc_ = glGetUniformLocation(update_program_, "count");
+
+    std::string draw_src =
+	std::string(instanced_ ? draw_attributes_src : draw_fetch_src) + draw_main_src;
+    draw_program_ = build_program(draw_src.c_str(), draw_fragment_src, "particles");
+    scale_loc_ = glGetUniformLocation(draw_program_, "scale");
+
+    // the compute shader updates in place, transform feedback needs a buffer to write into,
+    // neither needs the particles to start with
+    int n = compute_ ? 1 : 2;
+    glGenBuffers(n, buffers_);
+    glGenVertexArrays(n, update_vaos_);
+    glGenVertexArrays(n, draw_vaos_);
+    if (!instanced_) glGenTextures(n, textures_);
+    for (int i = 0; i < n; i++) {
+	glBindBuffer(GL_ARRAY_BUFFER, buffers_[i]);
+	tracked_buffer_data(GL_ARRAY_BUFFER, buffers_[i], GLsizeiptr(bytes_), nullptr,
+			    GL_DYNAMIC_COPY, gpu_category::vertices, "particles");
+	glBindVertexArray(update_vaos_[i]);
+	particle_attributes(0);
+	// the draw of the fetching shader has no attributes, only the vertex array to bind
+	if (instanced_) {
+	    glBindVertexArray(draw_vaos_[i]);
+	    particle_attributes(1);
+	}
+	else {
+	    glBindTexture(GL_TEXTURE_BUFFER, textures_[i]);
+	    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffers_[i]);
+	}
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (timed_) glGenQueries(timing_depth * 4, &queries_[0][0]);
+}
+
+particle_system::~particle_system()
+{
+    if (timed_) glDeleteQueries(timing_depth * 4, &queries_[0][0]);
+    glDeleteVertexArrays(2, update_vaos_);
+    glDeleteVertexArrays(2, draw_vaos_);
+    glDeleteTextures(2, textures_);
+    tracked_delete_buffers(2, buffers_);
+    glDeleteProgram(update_program_);
+    glDeleteProgram(draw_program_);
+}
+
+void
+particle_system::update(float dt)
+{
+    collect_timings();
+    dt = std::min(std::max(dt, 0.0f), 0.05f);
+    time_ += dt;
+
+    // timestamps around the update and, in draw(), around the draw, if a frame of them is free
+    if (timed_ && in_flight_ == timing_depth) {
+	skipped_timings_++;
+    }
+    else if (timed_) {
+	open_ = (head_ + in_flight_) % timing_depth;
+	glQueryCounter(queries_[open_][0], GL_TIMESTAMP);
+    }
+
+    glUseProgram(update_program_);
+    glUniform1f(dt_loc_, dt);
+    glUniform1f(time_loc_, time_);
+    glUniform1ui(frame_loc_, GLuint(updates_));
+
+    if (compute_) {
+	glUniform1ui(count_loc_, GLuint(count_));
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers_[0]);
+	glDispatchCompute(GLuint((count_ + 255) / 256), 1, 1);
+	// the writes have to land before the draw reads them as vertex attributes
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    }
+    else {
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(update_vaos_[current_]);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers_[1 - current_]);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, GLsizei(count_));
+	glEndTransformFeedback();
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glDisable(GL_RASTERIZER_DISCARD);
+	current_ = 1 - current_;
+    }
+
+    if (open_ >= 0) glQueryCounter(queries_[open_][1], GL_TIMESTAMP);
+    updates_++;
+}
+
+void
+particle_system::draw(int width, int height)
+{
+    // before the first update there are no particles yet
+    if (!updates_) return;
+
+    if (open_ >= 0) glQueryCounter(queries_[open_][2], GL_TIMESTAMP);
+
+    glUseProgram(draw_program_);
+    glUniform2f(scale_loc_, 2.0f * particle_radius_px / std::max(width, 1),
+		2.0f * particle_radius_px / std::max(height, 1));
+    glBindVertexArray(draw_vaos_[current_]);
+    if (!instanced_) {
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_BUFFER, textures_[current_]);
+    }
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(count_));
+    glDisable(GL_BLEND);
+
+    if (open_ >= 0) {
+	glQueryCounter(queries_[open_][3], GL_TIMESTAMP);
+	in_flight_++;
+	open_ = -1;
+    }
+    draws_++;
+}
+
+void
+particle_system::end_frame()
+{
+    // the update was timed but the draw was skipped, its timestamps are written over by the
+    // next update
+    if (open_ < 0) return;
+    open_ = -1;
+    skipped_timings_++;
+}
+
+void
+particle_system::collect_timings()
+{
+    // frames finish in order, and the timestamp after the draw is the last of a frame
+    while (in_flight_) {
+	const GLuint *q = queries_[head_];
+	GLuint available = GL_FALSE;
+	glGetQueryObjectuiv(q[3], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) break;
+
+	GLuint64 t[4] = {};
+	for (int i = 0; i < 4; i++) glGetQueryObjectui64v(q[i], GL_QUERY_RESULT, &t[i]);
+	update_gpu_ms_ += double(t[1] - t[0]) * 1e-6;
+	draw_gpu_ms_ += double(t[3] - t[2]) * 1e-6;
+	gpu_samples_++;
+
+	head_ = (head_ + 1) % timing_depth;
+	in_flight_--;
+    }
+}
+
+void
+particle_system::report(std::ostream &out) const
+{
+    out << "particles: " << count_ << std::endl;
+    out << "particles_update: " << (compute_ ? "compute" : "feedback") << std::endl;
+    out << "particles_bytes: " << bytes_ << std::endl;
+    out << "particles_updates: " << updates_ << std::endl;
+    out << "particles_draws: " << draws_ << std::endl;
+    out << "particles_skipped_timings: " << skipped_timings_ << std::endl;
+    if (!gpu_samples_) return;
+    double update_ms = update_gpu_ms_ / gpu_samples_, draw_ms = draw_gpu_ms_ / gpu_samples_;
+    out << "particles_update_gpu_ms_mean: " << update_ms << std::endl;
+    out << "particles_draw_gpu_ms_mean: " << draw_ms << std::endl;
+    if (update_ms > 0.0)
+	out << "particles_updated_mparticles_per_s: " << count_ / update_ms * 1e-3
+	    << std::endl;
+    if (draw_ms > 0.0)
+	out << "particles_drawn_mparticles_per_s: " << count_ / draw_ms * 1e-3 << std::endl;
+}
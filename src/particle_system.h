@@ -0,0 +1,95 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// particle_system.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Particles simulated and drawn on the gpu, in a compute shader where there is one, through
+// transform feedback otherwise
+
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <iosfwd>
+
+// A fountain of particles, each a position with the seconds it has left and a velocity, two
+// vec4s, 32 bytes. They are shot up from under the centre of the window, fall back, bounce off
+// its bottom edge and are shot up again when their time is up, the same simulation in both
+// paths. With 4.3 (or ARB_compute_shader and ARB_shader_storage_buffer_object) a compute
+// shader updates them in place in a shader storage buffer. The 3.2 context final asks for may
+// have neither, then a vertex shader reads them from one buffer and transform feedback writes
+// them into the other, with rasterization off, and the buffers swap.
+//
+// Either way the buffer is then bound as a vertex buffer with a divisor of 1, and every
+// particle drawn as an instance of a 4 vertex strip, with additive blending. Divisors need 3.3
+// (or ARB_instanced_arrays), without them the buffer is a buffer texture instead and the
+// vertex shader fetches the particle of gl_InstanceID from it. Nothing is read
+// back, the particles never leave the gpu, not even at the start, the first update makes them
+// up from a hash of their index. The update and the draw are timed with timestamp queries,
+// read back frames later, a frame whose draw is skipped is dropped at end_frame().
+
+class particle_system {
+   public:
+    // a compute dispatch is at most 65535 groups of 256
+    static constexpr std::size_t max_particles = std::size_t(65535) * 256;
+
+    // needs the context to be current, compute : use the compute shader if there is one,
+    // throws if count is over max_particles
+    explicit particle_system(std::size_t count, bool compute = true);
+    ~particle_system();
+
+    particle_system(const particle_system &) = delete;
+    particle_system &operator=(const particle_system &) = delete;
+
+    // move the particles on by dt seconds, at most 0.05, the program and vertex array
+    // bindings are changed
+    void update(float dt);
+
+    // draw them over the bound framebuffer of width by height pixels, with the depth test off,
+    // the program and vertex array bindings are changed, and the buffer texture of unit 0
+    // without divisors, the blending is turned off again
+    void draw(int width, int height);
+
+    // at the end of every frame, drawn or not, drops the timing of an update without a draw
+    void end_frame();
+
+    std::size_t count() const { return count_; }
+    bool uses_compute() const { return compute_; }
+    std::size_t bytes() const { return bytes_; }
+
+    // print the count, the path, and the gpu time and rate of the updates and the draws, one
+    // stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    static constexpr int timing_depth = 8;
+
+    // the timestamps of a frame that are done
+    void collect_timings();
+
+    std::size_t count_, bytes_;
+    bool compute_;
+    GLuint update_program_ = 0, draw_program_ = 0;
+    // both buffers with transform feedback, the one of them with the compute shader, current_
+    // has the particles
+    GLuint buffers_[2] = {};
+    GLuint update_vaos_[2] = {}, draw_vaos_[2] = {};
+    // attribute divisors, else the buffer textures of the buffers for the draw to fetch from
+    bool instanced_;
+    GLuint textures_[2] = {};
+    int current_ = 0;
+    GLint dt_loc_ = -1, time_loc_ = -1, frame_loc_ = -1, count_loc_ = -1, scale_loc_ = -1;
+
+    // a frame of timestamps in flight, before and after the update, and before and after the
+    // draw, open_ is the frame the update has written, -1 for none
+    bool timed_;
+    GLuint queries_[timing_depth][4] = {};
+    int head_ = 0, in_flight_ = 0, open_ = -1;
+
+    float time_ = 0.0f;
+    unsigned long updates_ = 0, draws_ = 0, gpu_samples_ = 0, skipped_timings_ = 0;
+    double update_gpu_ms_ = 0.0, draw_gpu_ms_ = 0.0;
+};
+
+#endif	// PARTICLE_SYSTEM_H
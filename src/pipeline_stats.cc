@@ -0,0 +1,100 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	pipeline_stats.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Per frame pipeline statistics
+
+#include "pipeline_stats.h"
+
+#include <algorithm>
+
+// query targets, in the order of the query objects of a set
+static const GLenum query_targets[] = {
+    GL_PRIMITIVES_GENERATED,
+    GL_VERTEX_SHADER_INVOCATIONS_ARB,
+    GL_CLIPPING_OUTPUT_PRIMITIVES_ARB,
+    GL_FRAGMENT_SHADER_INVOCATIONS_ARB,
+};
+
+pipeline_stats::pipeline_stats(int depth)
+    : extended_(GLEW_ARB_pipeline_statistics_query),
+      wide_results_(GLEW_VERSION_3_3 || GLEW_ARB_timer_query),
+      depth_(std::min(std::max(depth, 1), max_depth))
+{
+    for (int i = 0; i < depth_; i++) glGenQueries(extended_ ? num_queries : 1, queries_[i]);
+}
+
+pipeline_stats::~pipeline_stats()
+{
+    for (int i = 0; i < depth_; i++) glDeleteQueries(extended_ ? num_queries : 1, queries_[i]);
+}
+
+void
+pipeline_stats::begin()
+{
+    draw_calls_ = 0;
+
+    // all sets in flight, this frame goes uncounted on the gpu side
+    if (count_ == depth_) return;
+
+    int slot = (head_ + count_) % depth_;
+    for (int q = 0; q < (extended_ ? num_queries : 1); q++)
+	glBeginQuery(query_targets[q], queries_[slot][q]);
+    open_ = true;
+}
+
+void
+pipeline_stats::end()
+{
+    if (open_) {
+	int slot = (head_ + count_) % depth_;
+	for (int q = 0; q < (extended_ ? num_queries : 1); q++) glEndQuery(query_targets[q]);
+	draws_[slot] = draw_calls_;
+	count_++;
+	open_ = false;
+    }
+}
+
+void
+pipeline_stats::collect()
+{
+    // sets finish in order, take every finished one, the last one wins
+    while (count_) {
+	int n = extended_ ? num_queries : 1;
+	bool ready = true;
+	for (int q = 0; q < n && ready; q++) {
+	    GLuint available = GL_FALSE;
+	    glGetQueryObjectuiv(queries_[head_][q], GL_QUERY_RESULT_AVAILABLE, &available);
+	    ready = available;
+	}
+	if (!ready) break;
+
+	GLuint64 results[num_queries] = {};
+	for (int q = 0; q < n; q++) {
+	    if (wide_results_) {
+		glGetQueryObjectui64v(queries_[head_][q], GL_QUERY_RESULT, &results[q]);
+	    }
+	    else {
+		GLuint result = 0;
+		glGetQueryObjectuiv(queries_[head_][q], GL_QUERY_RESULT, &result);
+		results[q] = result;
+	    }
+	}
+
+	latest_.draw_calls = draws_[head_];
+	latest_.primitives_generated = results[0];
+	latest_.vertex_invocations = results[1];
+	latest_.clipping_output = results[2];
+	latest_.fragment_invocations = results[3];
+
+	head_ = (head_ + 1) % depth_;
+	count_--;
+    }
+}
+
+const frame_counters &
+pipeline_stats::latest()
+{
+    collect();
+    return latest_;
+}
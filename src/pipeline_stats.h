@@ -0,0 +1,68 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// pipeline_stats.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Per frame pipeline statistics : primitives generated and, with ARB_pipeline_statistics_query,
+// vertex and fragment shader invocations and clipped primitives, plus cpu side draw calls
+
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+
+#include <GL/glew.h>
+
+#include <cstdint>
+
+// The counters of one frame.
+struct frame_counters {
+    unsigned long draw_calls = 0;
+    std::uint64_t primitives_generated = 0;
+    std::uint64_t vertex_invocations = 0;
+    std::uint64_t clipping_output = 0;
+    std::uint64_t fragment_invocations = 0;
+};
+
+// Like gpu_timer, the query results are read frames later from a ring of query sets, so that
+// reading them never stalls. GL_PRIMITIVES_GENERATED is core since 3.0, the invocation counts
+// need the extension and stay 0 without it. The 64 bit results need 3.3 or ARB_timer_query,
+// without them they are read as 32 bits.
+
+class pipeline_stats {
+   public:
+    explicit pipeline_stats(int depth = 4);
+    ~pipeline_stats();
+
+    pipeline_stats(const pipeline_stats &) = delete;
+    pipeline_stats &operator=(const pipeline_stats &) = delete;
+
+    // whether the invocation counts are available
+    bool extended() const { return extended_; }
+
+    // bracket the commands to count, count_draw() after every draw call in between
+    void begin();
+    void count_draw() { draw_calls_++; }
+    void end();
+
+    // take the results of the frames that are done, without waiting, once a frame so that
+    // the ring never fills up
+    void collect();
+
+    // the counters of the latest frame whose results are in, collects first
+    const frame_counters &latest();
+
+   private:
+    static constexpr int max_depth = 8;
+    static constexpr int num_queries = 4;
+
+    bool extended_, wide_results_;
+    int depth_;
+    GLuint queries_[max_depth][num_queries] = {};
+    unsigned long draws_[max_depth] = {};
+
+    int head_ = 0, count_ = 0;
+    bool open_ = false;
+    unsigned long draw_calls_ = 0;
+
+    frame_counters latest_;
+};
+
+#endif	// PIPELINE_STATS_H
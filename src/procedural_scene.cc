@@ -0,0 +1,413 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	procedural_scene.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Procedural scenes generated in parallel into mapped buffers
+
+#include "procedural_scene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gpu_memory.h"
+
+struct scene_vertex {
+    float x, y, z;
+    std::uint8_t r, g, b, a;
+};
+static_assert(sizeof(scene_vertex) == 16, "scene vertices are 16 bytes");
+
+// the pinwheel of final.cc, xyz and rgb per vertex, four triangles
+static const float pinwheel[] = {
+    0.0f,  0.0f,  0.0f, 0.5f,  0.0f,  0.0f,	 // left, dark orange
+    1.0f,  0.0f,  0.0f, 0.5f,  0.0f,  0.0f,	 // right, dark orange
+    0.0f,  1.0f,  0.0f, 1.0f,  0.0f,  0.0f,	 // top, orange
+    0.0f,  0.0f,  0.0f, 0.25f, 0.0f,  0.4f,	 // left, dark purple
+    0.0f,  -1.0f, 0.0f, 0.25f, 0.0f,  0.4f,	 // bottom, dark purple
+    1.0f,  0.0f,  0.0f, 0.5f,  0.0f,  0.8f,	 // right, purple
+    0.0f,  0.0f,  0.0f, 0.25f, 0.45f, 0.25f,	 // right, dark gray
+    -1.0f, 0.0f,  0.0f, 0.25f, 0.45f, 0.25f,	 // left, dark gray
+    0.0f,  -1.0f, 0.0f, 0.4f,  0.9f,  0.4f,	 // bottom, gray
+    0.0f,  0.0f,  0.0f, 0.0f,  0.25f, 0.4f,	 // left, dark purple
+    0.0f,  1.0f,  0.0f, 0.0f,  0.25f, 0.4f,	 // bottom, dark purple
+    -1.0f, 0.0f,  0.0f, 0.0f,  0.5f,  0.8f,	 // right, purple
+};
+
+// sphere tessellation, rings from pole to pole and twice as many segments around
+static const std::uint64_t sphere_rings = 64;
+
+// splitmix64, a good enough hash of the seed and the position to start a generator from
+static std::uint64_t
+mix(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// a generator per item, so that the items come out the same on any thread
+struct item_random {
+    std::uint64_t state;
+
+    item_random(std::uint32_t seed, std::uint64_t item) : state(mix(seed ^ mix(item))) {}
+
+    // uniform in [0, 1)
+    float
+    next()
+    {
+	state += 0x9e3779b97f4a7c15ull;
+	return float(mix(state) >> 40) * (1.0f / 16777216.0f);
+    }
+};
+
+static std::uint8_t
+unorm8(float v)
+{
+    return std::uint8_t(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// smooth value noise on a lattice, octaves of it, in [0, 1)
+static float
+lattice(std::uint32_t seed, int x, int y)
+{
+    std::uint64_t h = mix(seed ^ mix(std::uint64_t(std::uint32_t(x)) << 32 | std::uint32_t(y)));
+    return float(h >> 40) * (1.0f / 16777216.0f);
+}
+
+static float
+value_noise(std::uint32_t seed, float x, float y)
+{
+    int ix = int(std::floor(x)), iy = int(std::floor(y));
+    float fx = x - ix, fy = y - iy;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+    float a = lattice(seed, ix, iy), b = lattice(seed, ix + 1, iy);
+    float c = lattice(seed, ix, iy + 1), d = lattice(seed, ix + 1, iy + 1);
+    return (a + (b - a) * fx) + ((c + (d - c) * fx) - (a + (b - a) * fx)) * fy;
+}
+
+static float
+terrain_height(std::uint32_t seed, float x, float y)
+{
+    float h = 0.0f, amplitude = 0.5f, frequency = 4.0f;
+    for (int octave = 0; octave < 6; octave++) {
+	h += amplitude * value_noise(seed + octave, x * frequency, y * frequency);
+	amplitude *= 0.5f;
+	frequency *= 2.0f;
+    }
+    return h / 0.984375f;
+}
+
+// split [0, n) into a contiguous range per thread, the calling thread takes the first
+static void
+parallel_for(std::uint64_t n, int threads,
+	     const std::function<void(std::uint64_t, std::uint64_t)> &job)
+{
+    std::uint64_t chunk = (n + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads && chunk * t < n; t++)
+	workers.emplace_back(job, chunk * t, std::min(chunk * (t + 1), n));
+    job(0, std::min(chunk, n));
+    for (std::thread &w : workers) w.join();
+}
+
+// what a scene is made of, the items are filled independently of each other
+struct scene_layout {
+    // square grid of items, the pinwheels and spheres
+    std::uint64_t columns = 1;
+    // terrain quads along a side, sphere rings
+    std::uint64_t side = 0;
+    std::uint64_t vertex_items = 0, vertices_per_item = 0;
+    std::uint64_t index_items = 0, indices_per_item = 0;
+    std::uint64_t triangles = 0;
+};
+
+static scene_layout
+layout_of(const scene_params &p)
+{
+    scene_layout l;
+    std::uint64_t t = std::max<std::uint64_t>(p.triangles, 1);
+    switch (p.kind) {
+	case scene_kind::soup:
+	    l.vertex_items = t;
+	    l.vertices_per_item = 3;
+	    l.triangles = t;
+	    break;
+	case scene_kind::pinwheels:
+	    l.vertex_items = (t + 3) / 4;
+	    l.vertices_per_item = 12;
+	    l.triangles = l.vertex_items * 4;
+	    break;
+	case scene_kind::spheres: {
+	    // one sphere, as finely tessellated as the triangles allow, or many of the finest
+	    l.side = std::uint64_t(std::ceil(std::sqrt(t / 4.0)));
+	    l.side = std::min(std::max<std::uint64_t>(l.side, 2), sphere_rings);
+	    std::uint64_t per_sphere = 4 * l.side * l.side;
+	    l.vertex_items = l.index_items = (t + per_sphere - 1) / per_sphere;
+	    l.vertices_per_item = (l.side + 1) * (2 * l.side + 1);
+	    l.indices_per_item = per_sphere * 3;
+	    l.triangles = l.index_items * per_sphere;
+	    break;
+	}
+	case scene_kind::terrain:
+	    // vertex rows and quad rows
+	    l.side = std::max<std::uint64_t>(std::uint64_t(std::ceil(std::sqrt(t / 2.0))), 1);
+	    l.vertex_items = l.side + 1;
+	    l.vertices_per_item = l.side + 1;
+	    l.index_items = l.side;
+	    l.indices_per_item = l.side * 6;
+	    l.triangles = l.side * l.side * 2;
+	    break;
+    }
+    l.columns = std::uint64_t(std::ceil(std::sqrt(double(l.vertex_items))));
+    return l;
+}
+
+static void
+fill_vertices(const scene_params &p, const scene_layout &l, std::uint64_t item,
+	      scene_vertex *out)
+{
+    item_random random(p.seed, item);
+    float cell = 2.0f / l.columns;
+    float cx = -1.0f + cell * (item % l.columns + 0.5f);
+    float cy = 1.0f - cell * (item / l.columns + 0.5f);
+
+    switch (p.kind) {
+	case scene_kind::soup: {
+	    // small enough that the soup covers the window about four times over
+	    float size = std::min(8.0f / std::sqrt(float(l.triangles)), 0.5f);
+	    float x = random.next() * 2.0f - 1.0f, y = random.next() * 2.0f - 1.0f;
+	    float z = random.next() * 1.8f - 0.9f;
+	    std::uint8_t r = unorm8(random.next()), g = unorm8(random.next());
+	    std::uint8_t b = unorm8(random.next());
+	    for (int v = 0; v < 3; v++) {
+		out[v] = {x + (random.next() - 0.5f) * size, y + (random.next() - 0.5f) * size,
+			  z, r, g, b, 255};
+	    }
+	    break;
+	}
+	case scene_kind::pinwheels: {
+	    // each turned by a random angle
+	    float angle = random.next() * 6.2831853f, scale = 0.45f * cell;
+	    float c = std::cos(angle) * scale, s = std::sin(angle) * scale;
+	    for (int v = 0; v < 12; v++) {
+		const float *q = &pinwheel[v * 6];
+		out[v] = {cx + c * q[0] - s * q[1], cy + s * q[0] + c * q[1], q[2],
+			  unorm8(q[3]), unorm8(q[4]), unorm8(q[5]), 255};
+	    }
+	    break;
+	}
+	case scene_kind::spheres: {
+	    // lit from the top left, the nearer hemisphere towards us, that is towards -z
+	    float radius = 0.45f * cell, hue = random.next();
+	    std::uint64_t rings = l.side, segments = 2 * l.side;
+	    for (std::uint64_t i = 0; i <= rings; i++) {
+		float theta = 3.14159265f * i / rings;
+		for (std::uint64_t j = 0; j <= segments; j++) {
+		    float phi = 6.2831853f * j / segments;
+		    float nx = std::sin(theta) * std::cos(phi), ny = std::cos(theta);
+		    float nz = std::sin(theta) * std::sin(phi);
+		    float light = std::max(0.2f, -0.5f * nx + 0.5f * ny - 0.7f * nz);
+		    out[i * (segments + 1) + j] = {
+			cx + radius * nx,
+			cy + radius * ny,
+			radius * nz,
+			unorm8(light * (0.5f + 0.5f * hue)),
+			unorm8(light * 0.6f),
+			unorm8(light * (1.0f - 0.5f * hue)),
+			255};
+		}
+	    }
+	    break;
+	}
+	case scene_kind::terrain: {
+	    // a row of the heightmap, higher is nearer, coloured by height
+	    float y = 0.95f - 1.9f * item / l.side;
+	    for (std::uint64_t j = 0; j <= l.side; j++) {
+		float x = -0.95f + 1.9f * j / l.side;
+		float h = terrain_height(p.seed, 0.5f * x + 0.5f, 0.5f * y + 0.5f);
+		float r = 0.2f, g = 0.3f, b = 0.8f;
+		if (h > 0.8f)
+		    r = g = b = 0.95f;
+		else if (h > 0.6f)
+		    r = 0.45f, g = 0.35f, b = 0.25f;
+		else if (h > 0.4f)
+		    r = 0.2f, g = 0.6f * h + 0.2f, b = 0.15f;
+		out[j] = {x, y, 0.5f - h, unorm8(r), unorm8(g), unorm8(b), 255};
+	    }
+	    break;
+	}
+    }
+}
+
+static void
+fill_indices(const scene_params &p, const scene_layout &l, std::uint64_t item, GLuint *out)
+{
+    switch (p.kind) {
+	case scene_kind::spheres: {
+	    std::uint64_t rings = l.side, segments = 2 * l.side;
+	    GLuint base = GLuint(item * l.vertices_per_item);
+	    for (std::uint64_t i = 0; i < rings; i++) {
+		for (std::uint64_t j = 0; j < segments; j++) {
+		    GLuint a = base + GLuint(i * (segments + 1) + j), b = a + 1;
+		    GLuint c = a + GLuint(segments + 1), d = c + 1;
+		    *out++ = a, *out++ = c, *out++ = b;
+		    *out++ = b, *out++ = c, *out++ = d;
+		}
+	    }
+	    break;
+	}
+	case scene_kind::terrain: {
+	    GLuint row = GLuint(item * (l.side + 1));
+	    for (std::uint64_t j = 0; j < l.side; j++) {
+		GLuint a = row + GLuint(j), b = a + 1;
+		GLuint c = a + GLuint(l.side + 1), d = c + 1;
+		*out++ = a, *out++ = c, *out++ = b;
+		*out++ = b, *out++ = c, *out++ = d;
+	    }
+	    break;
+	}
+	default:
+	    break;
+    }
+}
+
+const char *
+scene_kind_name(scene_kind kind)
+{
+    switch (kind) {
+	case scene_kind::soup:
+	    return "soup";
+	case scene_kind::pinwheels:
+	    return "pinwheels";
+	case scene_kind::spheres:
+	    return "spheres";
+	case scene_kind::terrain:
+	    return "terrain";
+    }
+    return "unknown";
+}
+
+scene_kind
+parse_scene_kind(const std::string &name)
+{
+    for (int i = 0; i < num_scene_kinds; i++) {
+	if (name == scene_kind_name(scene_kind(i))) return scene_kind(i);
+    }
+    throw std::runtime_error("unknown scene kind " + name +
+			     ", use soup, pinwheels, spheres or terrain");
+}
+
+procedural_scene::procedural_scene(const scene_params &params) : params_(params)
+{
+    if (params_.triangles > max_triangles)
+	throw std::runtime_error("procedural scene of " + std::to_string(params_.triangles) +
+				 " triangles, at most " + std::to_string(max_triangles));
+
+    threads_ = params_.threads > 0 ? params_.threads
+				   : std::max(1, int(std::thread::hardware_concurrency()));
+    scene_layout l = layout_of(params_);
+    vertices_ = l.vertex_items * l.vertices_per_item;
+    indices_ = l.index_items * l.indices_per_item;
+    triangles_ = l.triangles;
+    bytes_ = vertices_ * sizeof(scene_vertex) + indices_ * sizeof(GLuint);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // the destructor does not run for a constructor that throws
+    auto fail = [this](const char *what) {
+	glBindVertexArray(0);
+	glDeleteVertexArrays(1, &vao_);
+	tracked_delete_buffers(1, &vbo_);
+	if (ibo_) tracked_delete_buffers(1, &ibo_);
+	throw std::runtime_error(what);
+    };
+
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glBindVertexArray(vao_);
+
+    // sized first, then mapped and filled in place, no copy on our side
+    GLsizeiptr vertex_bytes = GLsizeiptr(vertices_ * sizeof(scene_vertex));
+    tracked_buffer_data(GL_ARRAY_BUFFER, vbo_, vertex_bytes, nullptr, GL_STATIC_DRAW,
+			gpu_category::vertices, "scene");
+    auto *vertices = static_cast<scene_vertex *>(glMapBufferRange(
+	GL_ARRAY_BUFFER, 0, vertex_bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!vertices) fail("cannot map the procedural scene vertex buffer");
+    parallel_for(l.vertex_items, threads_, [&](std::uint64_t first, std::uint64_t last) {
+	for (std::uint64_t i = first; i < last; i++)
+	    fill_vertices(params_, l, i, vertices + i * l.vertices_per_item);
+    });
+    if (!glUnmapBuffer(GL_ARRAY_BUFFER))
+	fail("procedural scene vertex buffer lost while mapped");
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(scene_vertex), (void *)0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(scene_vertex),
+			  (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    // the element buffer binding is part of the vao
+    if (indices_) {
+	glGenBuffers(1, &ibo_);
+	GLsizeiptr index_bytes = GLsizeiptr(indices_ * sizeof(GLuint));
+	tracked_buffer_data(GL_ELEMENT_ARRAY_BUFFER, ibo_, index_bytes, nullptr, GL_STATIC_DRAW,
+			    gpu_category::indices, "scene");
+	auto *indices = static_cast<GLuint *>(
+	    glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, index_bytes,
+			     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	if (!indices) fail("cannot map the procedural scene index buffer");
+	parallel_for(l.index_items, threads_, [&](std::uint64_t first, std::uint64_t last) {
+	    for (std::uint64_t i = first; i < last; i++)
+		fill_indices(params_, l, i, indices + i * l.indices_per_item);
+	});
+	if (!glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER))
+	    fail("procedural scene index buffer lost while mapped");
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    generate_ms_ =
+	std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	    .count();
+}
+
+procedural_scene::~procedural_scene()
+{
+    glDeleteVertexArrays(1, &vao_);
+    tracked_delete_buffers(1, &vbo_);
+    if (ibo_) tracked_delete_buffers(1, &ibo_);
+}
+
+void
+procedural_scene::draw() const
+{
+    glBindVertexArray(vao_);
+    if (indices_)
+	glDrawElements(GL_TRIANGLES, GLsizei(indices_), GL_UNSIGNED_INT, (void *)0);
+    else
+	glDrawArrays(GL_TRIANGLES, 0, GLsizei(vertices_));
+}
+
+void
+procedural_scene::report(std::ostream &out) const
+{
+    out << "scene_kind: " << scene_kind_name(params_.kind) << std::endl;
+    out << "scene_seed: " << params_.seed << std::endl;
+    out << "scene_threads: " << threads_ << std::endl;
+    out << "scene_triangles: " << triangles_ << std::endl;
+    out << "scene_vertices: " << vertices_ << std::endl;
+    out << "scene_indices: " << indices_ << std::endl;
+    out << "scene_bytes: " << bytes_ << std::endl;
+    out << "scene_generate_ms: " << generate_ms_ << std::endl;
+    if (generate_ms_ > 0.0)
+	out << "scene_mtriangles_per_s: " << triangles_ / generate_ms_ * 1e-3 << std::endl;
+}
@@ -0,0 +1,80 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// procedural_scene.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Procedural scenes of any size for load testing : triangle soups, pinwheel grids, spheres and
+// terrain, generated on all cores straight into mapped buffers
+
+#ifndef PROCEDURAL_SCENE_H
+#define PROCEDURAL_SCENE_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// soup : random triangles all over the view volume, pinwheels : a square grid of the pinwheel,
+// spheres : a square grid of tessellated spheres, terrain : a heightmap of value noise seen
+// from above
+enum class scene_kind { soup, pinwheels, spheres, terrain };
+constexpr int num_scene_kinds = 4;
+
+const char *scene_kind_name(scene_kind kind);
+scene_kind parse_scene_kind(const std::string &name);
+
+struct scene_params {
+    scene_kind kind = scene_kind::soup;
+    // wanted triangles, at most max_triangles, the scene gets at least this many, rounded up
+    // to whole pinwheels, spheres or terrain rows
+    std::uint64_t triangles = 1000000;
+    // the same seed gives the same scene whatever the number of threads
+    std::uint32_t seed = 1;
+    // 0 for one per core
+    int threads = 0;
+};
+
+// Vertices are xyz floats and rgba bytes, 16 bytes, at locations 0 and 1 like the pinwheel,
+// the colour normalized, so the scene shaders draw them as they are. Spheres and terrain are
+// indexed, the soup and the pinwheels are not. The buffers are sized first, mapped with
+// GL_MAP_INVALIDATE_BUFFER_BIT, and filled by the threads in disjoint ranges, each range
+// from its own generator seeded by the scene seed and its position, so nothing goes through
+// an intermediate copy on the cpu.
+
+class procedural_scene {
+   public:
+    static constexpr std::uint64_t max_triangles = 100000000;
+
+    // needs the context to be current, throws if there are too many triangles or a buffer
+    // cannot be mapped
+    explicit procedural_scene(const scene_params &params);
+    ~procedural_scene();
+
+    procedural_scene(const procedural_scene &) = delete;
+    procedural_scene &operator=(const procedural_scene &) = delete;
+
+    // draw all of it with the bound program, binds its vertex array
+    void draw() const;
+
+    const scene_params &params() const { return params_; }
+    GLuint vao() const { return vao_; }
+    std::uint64_t vertices() const { return vertices_; }
+    std::uint64_t indices() const { return indices_; }
+    std::uint64_t triangles() const { return triangles_; }
+    std::size_t bytes() const { return bytes_; }
+    double generate_ms() const { return generate_ms_; }
+
+    // print the kind, the counts, the memory and the generation rate, one stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    scene_params params_;
+    int threads_ = 1;
+    GLuint vao_ = 0, vbo_ = 0, ibo_ = 0;
+    std::uint64_t vertices_ = 0, indices_ = 0, triangles_ = 0;
+    std::size_t bytes_ = 0;
+    double generate_ms_ = 0.0;
+};
+
+#endif	// PROCEDURAL_SCENE_H
@@ -0,0 +1,212 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	render_target_pool.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Pool of offscreen render targets
+
+#include "render_target_pool.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+#include "gpu_memory.h"
+
+render_target_pool::render_target_pool(int bucket, unsigned long idle_frames)
+    : bucket_(std::max(bucket, 1)), idle_frames_(idle_frames)
+{
+}
+
+render_target_pool::~render_target_pool()
+{
+    // needs the context to be current
+    for (render_target *rt : targets_) {
+	destroy(*rt);
+	nodes_.destroy(rt);
+    }
+}
+
+render_target *
+render_target_pool::acquire(const render_target_desc &desc)
+{
+    int alloc_w = round_up(desc.width), alloc_h = round_up(desc.height);
+
+    // a free target with the same formats in the same bucket
+    for (render_target *rt : targets_) {
+	if (!rt->in_use && rt->alloc_width == alloc_w && rt->alloc_height == alloc_h &&
+	    rt->desc.color_format == desc.color_format &&
+	    rt->desc.depth_format == desc.depth_format && rt->desc.samples == desc.samples) {
+	    rt->in_use = true;
+	    rt->last_used_frame = frame_;
+	    rt->width = desc.width;
+	    rt->height = desc.height;
+	    rt->desc.name = desc.name;
+	    reuses_++;
+	    return rt;
+	}
+    }
+
+    // none, make one
+    render_target *rt = nodes_.create();
+    rt->desc = desc;
+    rt->width = desc.width;
+    rt->height = desc.height;
+    rt->alloc_width = alloc_w;
+    rt->alloc_height = alloc_h;
+    try {
+	create(*rt);
+    }
+    catch (...) {
+	// create() has deleted what it made, the node goes back to the pool
+	nodes_.destroy(rt);
+	throw;
+    }
+    rt->in_use = true;
+    rt->last_used_frame = frame_;
+
+    targets_.push_back(rt);
+    return rt;
+}
+
+void
+render_target_pool::end_frame()
+{
+    // Deleting is lazy, a target that was not used for a while is most probably of a size
+    // the window had during a resize, and will not be needed again.
+    std::size_t kept = 0;
+    for (render_target *rt : targets_) {
+	if (!rt->in_use && frame_ - rt->last_used_frame > idle_frames_) destroy(*rt);
+	rt->in_use = false;
+	if (rt->fbo)
+	    targets_[kept++] = rt;
+	else
+	    nodes_.destroy(rt);
+    }
+    targets_.resize(kept);
+    frame_++;
+}
+
+void
+render_target_pool::create(render_target &rt)
+{
+    const render_target_desc &d = rt.desc;
+    int w = rt.alloc_width, h = rt.alloc_height;
+    const char *tag = *d.name ? d.name : "target";
+
+    glGenFramebuffers(1, &rt.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, rt.fbo);
+
+    if (d.color_format && d.samples > 1) {
+	glGenRenderbuffers(1, &rt.color_rb);
+	tracked_renderbuffer_storage(rt.color_rb, d.samples, d.color_format, w, h,
+				     gpu_category::targets, tag);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+				  rt.color_rb);
+    }
+    else if (d.color_format) {
+	// no mipmaps, so the texture is complete with a single level
+	glGenTextures(1, &rt.color_tex);
+	glBindTexture(GL_TEXTURE_2D, rt.color_tex);
+	glTexImage2D(GL_TEXTURE_2D, 0, d.color_format, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+		     nullptr);
+	tracked_texture(rt.color_tex, std::size_t(w) * h * format_bytes(d.color_format),
+			gpu_category::targets, tag);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+			       rt.color_tex, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (d.depth_format) {
+	bool stencil =
+	    d.depth_format == GL_DEPTH24_STENCIL8 || d.depth_format == GL_DEPTH32F_STENCIL8;
+	glGenRenderbuffers(1, &rt.depth_rb);
+	tracked_renderbuffer_storage(rt.depth_rb, d.samples > 1 ? d.samples : 0,
+				     d.depth_format, w, h, gpu_category::targets, tag);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+				  stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+				  GL_RENDERBUFFER, rt.depth_rb);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+	destroy(rt);
+	throw std::runtime_error("render target framebuffer incomplete.");
+    }
+
+    std::size_t pixel = format_bytes(d.color_format) + format_bytes(d.depth_format);
+    rt.bytes = std::size_t(w) * h * std::max(d.samples, 1) * pixel;
+
+    allocations_++;
+    bytes_ += rt.bytes;
+    peak_bytes_ = std::max(peak_bytes_, bytes_);
+}
+
+void
+render_target_pool::destroy(render_target &rt)
+{
+    if (rt.color_tex) tracked_delete_textures(1, &rt.color_tex);
+    if (rt.color_rb) tracked_delete_renderbuffers(1, &rt.color_rb);
+    if (rt.depth_rb) tracked_delete_renderbuffers(1, &rt.depth_rb);
+    if (rt.fbo) glDeleteFramebuffers(1, &rt.fbo);
+    rt.fbo = rt.color_tex = rt.color_rb = rt.depth_rb = 0;
+
+    if (rt.bytes) {
+	frees_++;
+	bytes_ -= rt.bytes;
+	rt.bytes = 0;
+    }
+}
+
+std::size_t
+render_target_pool::format_bytes(GLenum format)
+{
+    // drivers pad 24 bit formats to 32 bits
+    switch (format) {
+	case 0:
+	    return 0;
+	case GL_R8:
+	    return 1;
+	case GL_RG8:
+	case GL_DEPTH_COMPONENT16:
+	case GL_R16F:
+	    return 2;
+	case GL_RGB8:
+	case GL_RGBA8:
+	case GL_SRGB8_ALPHA8:
+	case GL_RGB10_A2:
+	case GL_R11F_G11F_B10F:
+	case GL_DEPTH_COMPONENT24:
+	case GL_DEPTH_COMPONENT32F:
+	case GL_DEPTH24_STENCIL8:
+	case GL_R32F:
+	    return 4;
+	case GL_RGBA16F:
+	case GL_DEPTH32F_STENCIL8:
+	    return 8;
+	case GL_RGBA32F:
+	    return 16;
+	default:
+	    return 4;
+    }
+}
+
+void
+render_target_pool::report(std::ostream &os) const
+{
+    os << "rt_allocations: " << allocations_ << std::endl;
+    os << "rt_reuses: " << reuses_ << std::endl;
+    os << "rt_frees: " << frees_ << std::endl;
+    os << "rt_bytes: " << bytes_ << std::endl;
+    os << "rt_peak_bytes: " << peak_bytes_ << std::endl;
+    for (const auto &rt : targets_) {
+	os << "rt_target: " << rt->desc.name << " " << rt->alloc_width << "x"
+	   << rt->alloc_height << " samples " << rt->desc.samples << " bytes " << rt->bytes
+	   << std::endl;
+    }
+}
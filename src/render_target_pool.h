@@ -0,0 +1,104 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// render_target_pool.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Pool of offscreen render targets (framebuffer objects with their attachments)
+
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+#include "object_pool.h"
+
+// What a render target has to look like. Single sampled colour is a texture, so that later
+// passes can sample it, multisampled colour is a renderbuffer that gets resolved with a blit.
+// Depth is always a renderbuffer. A format of 0 means no such attachment.
+
+struct render_target_desc {
+    int width = 0, height = 0;
+    GLenum color_format = GL_RGBA8;
+    GLenum depth_format = 0;
+    int samples = 1;
+    // only for the report
+    const char *name = "";
+};
+
+struct render_target {
+    GLuint fbo = 0;
+    GLuint color_tex = 0;  // single sampled colour
+    GLuint color_rb = 0;   // multisampled colour
+    GLuint depth_rb = 0;
+
+    // requested size, and the (bucket) size the attachments really have
+    int width = 0, height = 0;
+    int alloc_width = 0, alloc_height = 0;
+
+    render_target_desc desc;
+    std::size_t bytes = 0;
+
+    bool in_use = false;
+    unsigned long last_used_frame = 0;
+};
+
+// Targets are handed out per frame with acquire() and all go back to the pool at end_frame().
+// Sizes are rounded up to buckets, so that a window being resized by a few pixels per event
+// keeps getting the same attachments, only the viewport changes. Targets nobody asked for in a
+// while are deleted lazily at end_frame(). The targets themselves are nodes of an object
+// pool, a target deleted during a resize gives its node to the next one made.
+
+class render_target_pool {
+   public:
+    // bucket : granularity of the allocated sizes in pixels, idle_frames : frames a target
+    // may stay unused before it is deleted
+    explicit render_target_pool(int bucket = 128, unsigned long idle_frames = 120);
+    ~render_target_pool();
+
+    render_target_pool(const render_target_pool &) = delete;
+    render_target_pool &operator=(const render_target_pool &) = delete;
+
+    // a target matching desc, valid until end_frame(), throws if the fbo is incomplete
+    render_target *acquire(const render_target_desc &desc);
+
+    // return all targets to the pool and delete the idle ones
+    void end_frame();
+
+    // statistics
+    unsigned long allocations() const { return allocations_; }
+    unsigned long reuses() const { return reuses_; }
+    unsigned long frees() const { return frees_; }
+    std::size_t bytes() const { return bytes_; }
+    std::size_t peak_bytes() const { return peak_bytes_; }
+
+    // print the statistics and one line per live target
+    void report(std::ostream &os) const;
+
+    // estimated bytes per pixel per sample of an internal format
+    static std::size_t format_bytes(GLenum format);
+
+   private:
+    void create(render_target &rt);
+    void destroy(render_target &rt);
+    int
+    round_up(int size) const
+    {
+	return (std::max(size, 1) + bucket_ - 1) / bucket_ * bucket_;
+    }
+
+    int bucket_;
+    unsigned long idle_frames_;
+    unsigned long frame_ = 0;
+
+    object_pool<render_target> nodes_;
+    std::vector<render_target *> targets_;
+
+    unsigned long allocations_ = 0, reuses_ = 0, frees_ = 0;
+    std::size_t bytes_ = 0, peak_bytes_ = 0;
+};
+
+#endif	// RENDER_TARGET_POOL_H
@@ -0,0 +1,294 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	shader_reload.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Shader programs built from glsl files, rebuilt when the files change on disk
+
+#include "shader_reload.h"
+
+#include "opengl_stuff.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+std::string
+stage_source(const shader_source &stage, const std::string &defines, bool from_file)
+{
+    std::string text;
+    if (stage.path.empty() || (stage.text && !from_file)) {
+	text = stage.text ? stage.text : "";
+    }
+    else {
+	std::ifstream in(stage.path);
+	if (!in) throw std::runtime_error("cannot read shader file : " + stage.path);
+
+	std::ostringstream contents;
+	contents << in.rdbuf();
+	text = contents.str();
+    }
+    if (defines.empty()) return text;
+
+    // #version has to come first, the defines go right after it
+    std::string::size_type pos = 0;
+    if (text.compare(0, 8, "#version") == 0) {
+	pos = text.find('\n');
+	pos = pos == std::string::npos ? text.size() : pos + 1;
+    }
+    return text.substr(0, pos) + defines + text.substr(pos);
+}
+
+// file name without the directory
+static std::string
+base_name(const std::string &path)
+{
+    std::string::size_type slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// info log of a shader or program object
+static std::string
+info_log(GLuint object, bool is_program)
+{
+    GLint log_sz = 0;
+    if (is_program)
+	glGetProgramiv(object, GL_INFO_LOG_LENGTH, &log_sz);
+    else
+	glGetShaderiv(object, GL_INFO_LOG_LENGTH, &log_sz);
+
+    std::vector<char> log(log_sz + 1, '\0');
+    if (is_program)
+	glGetProgramInfoLog(object, log_sz, nullptr, log.data());
+    else
+	glGetShaderInfoLog(object, log_sz, nullptr, log.data());
+    return log.data();
+}
+
+hot_program::hot_program(const char *name, std::vector<shader_source> stages,
+			 std::string defines, GLuint program)
+    : name_(name),
+      stages_(std::move(stages)),
+      defines_(std::move(defines)),
+      parallel_(GLEW_ARB_parallel_shader_compile),
+      program_(program)
+{
+    // let the driver pick the number of compiler threads
+    if (parallel_) glMaxShaderCompilerThreadsARB(0xffffffffu);
+
+    if (program_) return;
+
+    // the first build is like any other program, there is nothing to fall back on
+    std::vector<GLuint> shaders;
+    try {
+	for (const shader_source &stage : stages_) {
+	    std::string text = stage_source(stage, defines_);
+	    shaders.push_back(compile_shader(stage.type, text.c_str(), name));
+	}
+	program_ = link_program(shaders.data(), int(shaders.size()), name);
+    }
+    catch (...) {
+	for (GLuint shader : shaders) glDeleteShader(shader);
+	throw;
+    }
+    for (GLuint shader : shaders) glDeleteShader(shader);
+}
+
+hot_program::~hot_program()
+{
+    discard_pending();
+    glDeleteProgram(program_);
+}
+
+bool
+hot_program::uses(const std::string &file) const
+{
+    return std::any_of(stages_.begin(), stages_.end(), [&file](const shader_source &stage) {
+	return !stage.path.empty() && base_name(stage.path) == file;
+    });
+}
+
+void
+hot_program::reload()
+{
+    discard_pending();
+
+    // read all the stages before creating anything, a file may be half written
+    std::vector<std::string> texts;
+    try {
+	for (const shader_source &stage : stages_)
+	    texts.push_back(stage_source(stage, defines_, true));
+    }
+    catch (const std::exception &e) {
+	std::cerr << name_ << " : " << e.what() << ", keeping the old program" << std::endl;
+	failures_++;
+	return;
+    }
+
+    // Issue the compiles and the link without asking for their status, asking would wait
+    // for them. The status is checked in update().
+    pending_ = glCreateProgram();
+    for (std::size_t i = 0; i < stages_.size(); i++) {
+	GLuint shader = glCreateShader(stages_[i].type);
+	const char *src = texts[i].c_str();
+	glShaderSource(shader, 1, &src, nullptr);
+	glCompileShader(shader);
+	glAttachShader(pending_, shader);
+	pending_shaders_.push_back(shader);
+    }
+    glLinkProgram(pending_);
+}
+
+bool
+hot_program::update()
+{
+    if (!pending_) return false;
+
+    // without parallel compilation the link status query below waits for the compiler
+    if (parallel_) {
+	GLint done = GL_FALSE;
+	glGetProgramiv(pending_, GL_COMPLETION_STATUS_ARB, &done);
+	if (!done) return false;
+    }
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(pending_, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) {
+	// the link log only says that some stage failed, the stage logs say why
+	std::cerr << name_ << " rebuild failed, keeping the old program :" << std::endl;
+	for (GLuint shader : pending_shaders_) {
+	    GLint compiled = GL_FALSE;
+	    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	    if (compiled == GL_FALSE) std::cerr << info_log(shader, false) << std::endl;
+	}
+	std::cerr << info_log(pending_, true) << std::endl;
+
+	discard_pending();
+	failures_++;
+	return false;
+    }
+
+    // swap, the old program is not in use, we are between frames
+    for (GLuint shader : pending_shaders_) {
+	glDetachShader(pending_, shader);
+	glDeleteShader(shader);
+    }
+    pending_shaders_.clear();
+
+    glDeleteProgram(program_);
+    program_ = pending_;
+    pending_ = 0;
+
+    generation_++;
+    reloads_++;
+    return true;
+}
+
+void
+hot_program::discard_pending()
+{
+    for (GLuint shader : pending_shaders_) glDeleteShader(shader);
+    pending_shaders_.clear();
+
+    // glDeleteProgram ignores 0
+    glDeleteProgram(pending_);
+    pending_ = 0;
+}
+
+#ifdef __linux__
+
+shader_watcher::shader_watcher(const std::string &dir, std::function<void()> on_change)
+    : on_change_(std::move(on_change))
+{
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (inotify_fd_ < 0 || stop_fd_ < 0 ||
+	inotify_add_watch(inotify_fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+	std::cerr << "cannot watch " << dir << ", shaders will not be reloaded" << std::endl;
+	return;
+    }
+
+    thread_ = std::thread(&shader_watcher::run, this);
+}
+
+shader_watcher::~shader_watcher()
+{
+    if (thread_.joinable()) {
+	uint64_t one = 1;
+	// writing to an eventfd only fails if the counter overflows
+	ssize_t written = write(stop_fd_, &one, sizeof(one));
+	(void)written;
+	thread_.join();
+    }
+    if (inotify_fd_ >= 0) close(inotify_fd_);
+    if (stop_fd_ >= 0) close(stop_fd_);
+}
+
+void
+shader_watcher::run()
+{
+    // aligned as inotify_event wants
+    alignas(inotify_event) char buffer[4096];
+
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+
+    while (true) {
+	if (poll(fds, 2, -1) < 0) continue;
+	if (fds[1].revents) break;
+
+	// an editor save is a burst of events, collect the whole burst before waking anyone
+	bool changed = false;
+	ssize_t len;
+	while ((len = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+	    std::lock_guard<std::mutex> lock(mutex_);
+	    for (char *p = buffer; p < buffer + len;) {
+		const inotify_event *event = reinterpret_cast<const inotify_event *>(p);
+		if (event->len) {
+		    std::string name = event->name;
+		    if (std::find(changes_.begin(), changes_.end(), name) == changes_.end())
+			changes_.push_back(name);
+		    changed = true;
+		}
+		p += sizeof(inotify_event) + event->len;
+	    }
+	}
+
+	if (changed && on_change_) on_change_();
+    }
+}
+
+#else
+
+shader_watcher::shader_watcher(const std::string &dir, std::function<void()> on_change)
+    : on_change_(std::move(on_change))
+{
+    std::cerr << "no inotify, shaders in " << dir << " will not be reloaded" << std::endl;
+}
+
+shader_watcher::~shader_watcher() {}
+
+void
+shader_watcher::run()
+{
+}
+
+#endif	// __linux__
+
+std::vector<std::string>
+shader_watcher::take_changes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> changes;
+    changes.swap(changes_);
+    return changes;
+}
@@ -0,0 +1,127 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// shader_reload.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Shader programs built from glsl files, rebuilt when the files change on disk
+
+#ifndef SHADER_RELOAD_H
+#define SHADER_RELOAD_H
+
+#include <GL/glew.h>
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One stage of a hot program. The first build uses the built in text, if there is any, e.g. a
+// minified copy of the file embedded at build time, and reads the file otherwise. Rebuilds
+// always read the file, a stage without a path never changes.
+struct shader_source {
+    GLenum type;
+    std::string path;
+    const char *text = nullptr;
+};
+
+// text of the stage with the #define lines inserted after its #version line, from the file if
+// from_file is set or there is no built in text, throws if the file cannot be read
+extern std::string stage_source(const shader_source &stage, const std::string &defines,
+				bool from_file = false);
+
+// A program whose stages come from files. The first build throws like build_program(), a
+// rebuild never does: it is started with reload() and finished with update(), which swaps the
+// new program in only if it compiled and linked, a broken edit leaves the old program running
+// and prints the compiler log. Drivers with ARB_parallel_shader_compile compile in the
+// background and update() just polls, others compile when update() is called.
+//
+// Uniform locations belong to the program, so callers look them up again whenever
+// generation() changes. A program built elsewhere, e.g. loaded from a binary, can be handed
+// over to the constructor, rebuilds then start from the files as usual.
+
+class hot_program {
+   public:
+    // defines : #define lines inserted into every stage, program : a linked program to adopt,
+    // 0 to build it from the stages
+    hot_program(const char *name, std::vector<shader_source> stages, std::string defines = "",
+		GLuint program = 0);
+    ~hot_program();
+
+    hot_program(const hot_program &) = delete;
+    hot_program &operator=(const hot_program &) = delete;
+
+    // the program to draw with, always a linked one
+    GLuint id() const { return program_; }
+
+    // bumped every time a rebuilt program is swapped in
+    unsigned long generation() const { return generation_; }
+
+    // true if one of the stages is read from a file with this name, without the directory
+    bool uses(const std::string &file) const;
+
+    // start rebuilding from the files, a rebuild already in progress is abandoned
+    void reload();
+
+    // finish the rebuild if it is done, true if a new program was swapped in
+    bool update();
+
+    // a rebuild is in progress, update() has to be called until it is not
+    bool rebuilding() const { return pending_ != 0; }
+
+    unsigned long reloads() const { return reloads_; }
+    unsigned long failures() const { return failures_; }
+
+   private:
+    // abandon the rebuild in progress
+    void discard_pending();
+
+    std::string name_;
+    std::vector<shader_source> stages_;
+    std::string defines_;
+    bool parallel_;
+
+    GLuint program_ = 0;
+    unsigned long generation_ = 0;
+
+    // rebuild in progress
+    GLuint pending_ = 0;
+    std::vector<GLuint> pending_shaders_;
+
+    unsigned long reloads_ = 0, failures_ = 0;
+};
+
+// Watches a directory with inotify on a thread of its own. Editors either rewrite a file in
+// place or write a new one and rename it over the old, so both closing a file opened for
+// writing and moving a file into the directory count as changes. The watcher only collects
+// the names, on_change tells the owner to come and take them, from the watcher thread.
+//
+// On systems without inotify the watcher is inactive and never reports anything.
+
+class shader_watcher {
+   public:
+    shader_watcher(const std::string &dir, std::function<void()> on_change);
+    ~shader_watcher();
+
+    shader_watcher(const shader_watcher &) = delete;
+    shader_watcher &operator=(const shader_watcher &) = delete;
+
+    // false if the directory could not be watched
+    bool active() const { return thread_.joinable(); }
+
+    // names of the files changed since the last call, without the directory
+    std::vector<std::string> take_changes();
+
+   private:
+    void run();
+
+    std::function<void()> on_change_;
+    int inotify_fd_ = -1;
+    // written to by the destructor to stop the thread
+    int stop_fd_ = -1;
+    std::thread thread_;
+
+    std::mutex mutex_;
+    std::vector<std::string> changes_;
+};
+
+#endif	// SHADER_RELOAD_H
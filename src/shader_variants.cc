@@ -0,0 +1,240 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	shader_variants.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Shader permutations selected by a bitmask of feature flags, compiled on first use
+
+#include "shader_variants.h"
+
+#include "opengl_stuff.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+// 64 bit FNV-1a, good enough to tell sources apart, it is not a checksum of the binary
+static unsigned long long
+fnv1a(const std::string &text, unsigned long long hash = 14695981039346656037ull)
+{
+    for (unsigned char c : text) {
+	hash ^= c;
+	hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+shader_variants::shader_variants(const char *name, std::vector<shader_source> stages,
+				 std::vector<const char *> features,
+				 std::vector<const char *> uniforms,
+				 const std::string &cache_dir)
+    : name_(name),
+      stages_(std::move(stages)),
+      features_(std::move(features)),
+      uniforms_(std::move(uniforms))
+{
+    // a driver may support binaries but offer no format to save them in
+    GLint formats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+    if (!cache_dir.empty() && formats > 0) {
+	std::error_code error;
+	std::filesystem::create_directories(cache_dir, error);
+	if (!error) cache_dir_ = cache_dir;
+    }
+
+    driver_ = std::string(reinterpret_cast<const char *>(glGetString(GL_VENDOR))) + "\n" +
+	      reinterpret_cast<const char *>(glGetString(GL_RENDERER)) + "\n" +
+	      reinterpret_cast<const char *>(glGetString(GL_VERSION)) + "\n";
+}
+
+std::string
+shader_variants::defines(unsigned mask) const
+{
+    std::string lines;
+    for (std::size_t i = 0; i < features_.size(); i++) {
+	if (mask & (1u << i)) lines += std::string("#define ") + features_[i] + " 1\n";
+    }
+    return lines;
+}
+
+const shader_variants::variant &
+shader_variants::get(unsigned mask)
+{
+    auto it = variants_.find(mask);
+    if (it != variants_.end()) return it->second;
+    auto failure = failures_.find(mask);
+    if (failure != failures_.end()) throw std::runtime_error(failure->second);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // the key covers everything that goes into the binary
+    std::string lines = defines(mask);
+    std::vector<std::string> texts;
+    unsigned long long key = fnv1a(driver_);
+    for (const shader_source &stage : stages_) {
+	texts.push_back(stage_source(stage, lines, edited_));
+	key = fnv1a(texts.back(), key);
+    }
+
+    std::string variant_name = name_ + "[" + std::to_string(mask) + "]";
+
+    GLuint program = cache_dir_.empty() ? 0 : load_binary(mask, key);
+    if (program) {
+	disk_hits_++;
+    }
+    else {
+	if (!cache_dir_.empty()) disk_misses_++;
+	std::vector<GLuint> shaders;
+	try {
+	    for (std::size_t i = 0; i < stages_.size(); i++) {
+		shaders.push_back(compile_shader(stages_[i].type, texts[i].c_str(),
+						 variant_name.c_str()));
+	    }
+	    program = link_program(shaders.data(), int(shaders.size()), variant_name.c_str(),
+				   !cache_dir_.empty());
+	}
+	catch (const std::exception &e) {
+	    for (GLuint shader : shaders) glDeleteShader(shader);
+	    failures_[mask] = e.what();
+	    throw;
+	}
+	for (GLuint shader : shaders) glDeleteShader(shader);
+	compiles_++;
+
+	if (!cache_dir_.empty()) save_binary(mask, key, program);
+    }
+
+    variant &v = variants_[mask];
+    v.program = std::make_unique<hot_program>(variant_name.c_str(), stages_, lines, program);
+    for (const char *uniform : uniforms_)
+	v.uniforms.push_back(glGetUniformLocation(program, uniform));
+
+    compile_ms_ += std::chrono::duration<double, std::milli>(
+		       std::chrono::steady_clock::now() - start)
+		       .count();
+    return v;
+}
+
+bool
+shader_variants::uses(const std::string &file) const
+{
+    // all variants share the stages, so the first one, if any, can answer
+    return !variants_.empty() && variants_.begin()->second.program->uses(file);
+}
+
+void
+shader_variants::reload()
+{
+    edited_ = true;
+    failures_.clear();
+    for (auto &entry : variants_) entry.second.program->reload();
+}
+
+bool
+shader_variants::update()
+{
+    bool swapped = false;
+    for (auto &entry : variants_) {
+	variant &v = entry.second;
+	if (!v.program->update()) continue;
+
+	// the new program has locations of its own
+	for (std::size_t i = 0; i < uniforms_.size(); i++)
+	    v.uniforms[i] = glGetUniformLocation(v.program->id(), uniforms_[i]);
+	swapped = true;
+    }
+    return swapped;
+}
+
+bool
+shader_variants::rebuilding() const
+{
+    for (const auto &entry : variants_) {
+	if (entry.second.program->rebuilding()) return true;
+    }
+    return false;
+}
+
+unsigned long
+shader_variants::reloads() const
+{
+    unsigned long n = 0;
+    for (const auto &entry : variants_) n += entry.second.program->reloads();
+    return n;
+}
+
+unsigned long
+shader_variants::failures() const
+{
+    unsigned long n = 0;
+    for (const auto &entry : variants_) n += entry.second.program->failures();
+    return n;
+}
+
+void
+shader_variants::report(std::ostream &out) const
+{
+    unsigned long lookups = disk_hits_ + disk_misses_;
+    out << name_ << "_variants: " << variants_.size() << std::endl;
+    out << name_ << "_variant_compile_ms: " << compile_ms_ << std::endl;
+    out << name_ << "_variant_compiles: " << compiles_ << std::endl;
+    out << name_ << "_variant_cache_hits: " << disk_hits_ << std::endl;
+    out << name_ << "_variant_cache_misses: " << disk_misses_ << std::endl;
+    if (lookups)
+	out << name_ << "_variant_cache_hit_rate: " << double(disk_hits_) / lookups
+	    << std::endl;
+}
+
+std::string
+shader_variants::binary_path(unsigned mask, unsigned long long key) const
+{
+    char file[64];
+    std::snprintf(file, sizeof(file), "-%08x-%016llx.bin", mask, key);
+    return cache_dir_ + "/" + name_ + file;
+}
+
+GLuint
+shader_variants::load_binary(unsigned mask, unsigned long long key)
+{
+    std::ifstream in(binary_path(mask, key), std::ios::binary);
+    if (!in) return 0;
+
+    // the binary format enum, then the binary
+    GLenum format = 0;
+    in.read(reinterpret_cast<char *>(&format), sizeof(format));
+    std::vector<char> binary((std::istreambuf_iterator<char>(in)),
+			     std::istreambuf_iterator<char>());
+    if (!in.eof() || binary.empty()) return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), GLsizei(binary.size()));
+
+    // a driver update makes old binaries unusable, they then fail to link
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) {
+	glDeleteProgram(program);
+	return 0;
+    }
+    return program;
+}
+
+void
+shader_variants::save_binary(unsigned mask, unsigned long long key, GLuint program)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    // a failed write only costs a compile next time
+    std::ofstream out(binary_path(mask, key), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&format), sizeof(format));
+    out.write(binary.data(), binary.size());
+}
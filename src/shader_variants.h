@@ -0,0 +1,99 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// shader_variants.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Shader permutations selected by a bitmask of feature flags, compiled on first use
+
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include "shader_reload.h"
+
+#include <GL/glew.h>
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One set of glsl files, many programs. Bit i of a mask stands for features[i], and the
+// variant for a mask is the files compiled with "#define <feature> 1" for every bit that is
+// set, so the glsl picks its code paths with #if defined(...). Variants are compiled the first
+// time they are asked for and kept in a hash map keyed by the mask, and, where the driver can
+// hand out program binaries (4.1 or ARB_get_program_binary), saved in a disk cache keyed by
+// the mask and a hash of the sources and the driver, so the next run only loads them.
+//
+// Every variant is a hot_program, when the files change all variants built so far are
+// rebuilt, each keeping its old program if the new one does not compile. A mask whose variant
+// did not compile is remembered with its error until the files change, so a broken
+// permutation costs one compile per edit, not one per frame.
+
+class shader_variants {
+   public:
+    struct variant {
+	std::unique_ptr<hot_program> program;
+	// locations of the uniforms, in the order they were given to the constructor
+	std::vector<GLint> uniforms;
+    };
+
+    // features : names of the flag bits, uniforms : uniforms to look up in every variant,
+    // cache_dir : directory of the program binaries, empty for no disk cache
+    shader_variants(const char *name, std::vector<shader_source> stages,
+		    std::vector<const char *> features, std::vector<const char *> uniforms,
+		    const std::string &cache_dir = "");
+
+    shader_variants(const shader_variants &) = delete;
+    shader_variants &operator=(const shader_variants &) = delete;
+
+    // the variant for the mask, compiled now if it is the first time, throws if it does not
+    // compile, and again with the same error, without compiling, until the files change
+    const variant &get(unsigned mask);
+
+    // whether the variant for the mask failed to compile since the files last changed
+    bool failed(unsigned mask) const { return failures_.count(mask) != 0; }
+
+    // the #define lines of a mask
+    std::string defines(unsigned mask) const;
+
+    // hot reload of all the variants built so far, see hot_program
+    bool uses(const std::string &file) const;
+    void reload();
+    bool update();
+    bool rebuilding() const;
+    unsigned long reloads() const;
+    unsigned long failures() const;
+
+    // variant count, build time, compiles, and hits and misses of the disk cache, one stat per
+    // line. Only the first get() of a mask counts, the later ones are lookups in the map.
+    void report(std::ostream &out) const;
+
+   private:
+    // program for the mask from the disk cache, 0 if it is not there or the driver rejects it
+    GLuint load_binary(unsigned mask, unsigned long long key);
+    void save_binary(unsigned mask, unsigned long long key, GLuint program);
+    std::string binary_path(unsigned mask, unsigned long long key) const;
+
+    std::string name_;
+    std::vector<shader_source> stages_;
+    std::vector<const char *> features_;
+    std::vector<const char *> uniforms_;
+
+    // empty if there is no disk cache
+    std::string cache_dir_;
+    // driver identification, binaries only load into the driver that saved them
+    std::string driver_;
+
+    std::unordered_map<unsigned, variant> variants_;
+    // the errors of the masks that did not compile, cleared by reload()
+    std::unordered_map<unsigned, std::string> failures_;
+
+    // the files were changed, new variants have to read them rather than use built in text
+    bool edited_ = false;
+
+    // variants compiled from source, and variants looked up on disk, found or not
+    unsigned long compiles_ = 0, disk_hits_ = 0, disk_misses_ = 0;
+    double compile_ms_ = 0.0;
+};
+
+#endif	// SHADER_VARIANTS_H
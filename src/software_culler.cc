@@ -0,0 +1,413 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	software_culler.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Occlusion culling on the cpu, against a small depth buffer of a few large occluders
+
+#include "software_culler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// AVX2 is compiled in for x86 with gcc or clang whatever -march says, and used if the cpu
+// has it
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SOFTWARE_CULLER_AVX2 1
+#include <immintrin.h>
+#endif
+
+// boxes this close behind the occluders still count as visible, for rounding
+static const float depth_bias = 1e-4f;
+
+// at most this many bands, and threads
+static const int max_bands = 8;
+
+/*
+ * to_window() : a point to window coordinates, false if it is not in front of the near plane
+ *
+ * m : column major matrix to clip space
+ * width, height : of the depth buffer
+ * p : the point
+ * out : x and y in pixels, and depth
+ */
+
+static bool
+to_window(const float m[16], int width, int height, const float p[3], float out[3])
+{
+    float clip[4];
+    for (int r = 0; r < 4; r++)
+	clip[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+    if (clip[3] <= 1e-6f || clip[2] < -clip[3]) return false;
+
+    out[0] = (clip[0] / clip[3] * 0.5f + 0.5f) * width;
+    out[1] = (clip[1] / clip[3] * 0.5f + 0.5f) * height;
+    out[2] = clip[2] / clip[3] * 0.5f + 0.5f;
+    return true;
+}
+
+/*
+ * project_box() : the window rectangle and nearest depth of a box, false if it is not all in
+ * front of the near plane
+ *
+ * m, width, height : as for to_window()
+ * box : the box
+ * rect : left, bottom, right and top, in pixels
+ * nearest : depth of the nearest corner
+ */
+
+static bool
+project_box(const float m[16], int width, int height, const aabb &box, float rect[4],
+	    float &nearest)
+{
+    rect[0] = rect[1] = 1e30f;
+    rect[2] = rect[3] = -1e30f;
+    nearest = 1e30f;
+    for (int c = 0; c < 8; c++) {
+	float p[3] = {c & 1 ? box.hi[0] : box.lo[0], c & 2 ? box.hi[1] : box.lo[1],
+		      c & 4 ? box.hi[2] : box.lo[2]};
+	float w[3];
+	if (!to_window(m, width, height, p, w)) return false;
+	rect[0] = std::min(rect[0], w[0]);
+	rect[1] = std::min(rect[1], w[1]);
+	rect[2] = std::max(rect[2], w[0]);
+	rect[3] = std::max(rect[3], w[1]);
+	nearest = std::min(nearest, w[2]);
+    }
+    return true;
+}
+
+// A triangle clipped to a band, its edge functions a x + b y + c, positive inside, and its
+// depth as a plane, over the pixels [xmin, xmax) x [ymin, ymax).
+struct raster_setup {
+    float a[3], b[3], c[3];
+    float za, zb, zc;
+    int xmin, xmax, ymin, ymax;
+};
+
+static void
+raster_scalar(const raster_setup &s, float *depth, int width)
+{
+    for (int y = s.ymin; y < s.ymax; y++) {
+	float py = y + 0.5f;
+	float r0 = s.b[0] * py + s.c[0], r1 = s.b[1] * py + s.c[1], r2 = s.b[2] * py + s.c[2];
+	float rz = s.zb * py + s.zc;
+	float *row = depth + std::size_t(y) * width;
+	for (int x = s.xmin; x < s.xmax; x++) {
+	    float px = x + 0.5f;
+	    if (s.a[0] * px + r0 < 0.0f || s.a[1] * px + r1 < 0.0f || s.a[2] * px + r2 < 0.0f)
+		continue;
+	    row[x] = std::min(row[x], s.za * px + rz);
+	}
+    }
+}
+
+#ifdef SOFTWARE_CULLER_AVX2
+// eight pixels at a time from a multiple of 8, the width is one too, so a block never runs
+// past the row
+__attribute__((target("avx2"))) static void
+raster_avx2(const raster_setup &s, float *depth, int width)
+{
+    const __m256 lane = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 a0 = _mm256_set1_ps(s.a[0]), a1 = _mm256_set1_ps(s.a[1]),
+		 a2 = _mm256_set1_ps(s.a[2]), za = _mm256_set1_ps(s.za);
+
+    for (int y = s.ymin; y < s.ymax; y++) {
+	float py = y + 0.5f;
+	__m256 r0 = _mm256_set1_ps(s.b[0] * py + s.c[0]);
+	__m256 r1 = _mm256_set1_ps(s.b[1] * py + s.c[1]);
+	__m256 r2 = _mm256_set1_ps(s.b[2] * py + s.c[2]);
+	__m256 rz = _mm256_set1_ps(s.zb * py + s.zc);
+	float *row = depth + std::size_t(y) * width;
+	for (int x = s.xmin & ~7; x < s.xmax; x += 8) {
+	    __m256 px = _mm256_add_ps(_mm256_set1_ps(float(x)), lane);
+	    __m256 e0 = _mm256_add_ps(_mm256_mul_ps(a0, px), r0);
+	    __m256 e1 = _mm256_add_ps(_mm256_mul_ps(a1, px), r1);
+	    __m256 e2 = _mm256_add_ps(_mm256_mul_ps(a2, px), r2);
+	    __m256 inside = _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ),
+					  _mm256_and_ps(_mm256_cmp_ps(e1, zero, _CMP_GE_OQ),
+							_mm256_cmp_ps(e2, zero, _CMP_GE_OQ)));
+	    if (!_mm256_movemask_ps(inside)) continue;
+
+	    __m256 z = _mm256_add_ps(_mm256_mul_ps(za, px), rz);
+	    __m256 d = _mm256_loadu_ps(row + x);
+	    _mm256_storeu_ps(row + x, _mm256_blendv_ps(d, _mm256_min_ps(d, z), inside));
+	}
+    }
+}
+#endif
+
+software_culler::software_culler(int width, int height, int threads)
+    : width_((std::max(width, 8) + 7) & ~7), height_(std::max(height, 1))
+{
+#ifdef SOFTWARE_CULLER_AVX2
+    has_avx2_ = __builtin_cpu_supports("avx2");
+#else
+    has_avx2_ = false;
+#endif
+    simd_ = has_avx2_;
+
+    if (threads <= 0) threads = int(std::max(std::thread::hardware_concurrency(), 1u));
+    bands_ = std::min({threads, max_bands, height_});
+
+    for (int w = width_, h = height_;; w = (w + 1) / 2, h = (h + 1) / 2) {
+	levels_.emplace_back(std::size_t(w) * h, 1.0f);
+	level_width_.push_back(w);
+	level_height_.push_back(h);
+	if (w == 1 && h == 1) break;
+    }
+
+    for (int band = 1; band < bands_; band++)
+	workers_.emplace_back(&software_culler::worker_main, this, band);
+}
+
+software_culler::~software_culler()
+{
+    {
+	std::lock_guard<std::mutex> lock(mutex_);
+	quit_ = true;
+    }
+    start_cv_.notify_all();
+    for (std::thread &t : workers_) t.join();
+}
+
+void
+software_culler::begin(const float matrix[16])
+{
+    std::copy(matrix, matrix + 16, matrix_);
+    triangles_.clear();
+}
+
+float
+software_culler::screen_area(const aabb &box) const
+{
+    float rect[4], nearest;
+    if (!project_box(matrix_, width_, height_, box, rect, nearest)) return 0.0f;
+    float w = std::min(rect[2], float(width_)) - std::max(rect[0], 0.0f);
+    float h = std::min(rect[3], float(height_)) - std::max(rect[1], 0.0f);
+    return w > 0.0f && h > 0.0f ? w * h : 0.0f;
+}
+
+void
+software_culler::add_occluder(const float *positions, std::size_t triangles)
+{
+    for (std::size_t t = 0; t < triangles; t++) {
+	float v[9];
+	bool in_front = true;
+	const float *p = positions + 9 * t;
+	for (int k = 0; k < 3 && in_front; k++)
+	    in_front = to_window(matrix_, width_, height_, p + 3 * k, v + 3 * k);
+	if (in_front) triangles_.insert(triangles_.end(), v, v + 9);
+    }
+}
+
+void
+software_culler::rasterize()
+{
+    auto start = std::chrono::steady_clock::now();
+    run_workers([this](int band) { rasterize_band(band); });
+    build_pyramid();
+    rasterize_ms_ =
+	std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	    .count();
+
+    frames_++;
+    occluders_total_ += occluder_triangles();
+    rasterize_ms_total_ += rasterize_ms_;
+}
+
+void
+software_culler::rasterize_band(int band)
+{
+    int y0 = height_ * band / bands_, y1 = height_ * (band + 1) / bands_;
+    float *depth = levels_[0].data();
+    std::fill(depth + std::size_t(y0) * width_, depth + std::size_t(y1) * width_, 1.0f);
+
+    for (std::size_t t = 0; t < triangles_.size(); t += 9) {
+	const float *v = &triangles_[t];
+	float x[3] = {v[0], v[3], v[6]}, y[3] = {v[1], v[4], v[7]}, z[3] = {v[2], v[5], v[8]};
+
+	raster_setup s;
+	s.ymin = std::max(int(std::floor(std::min({y[0], y[1], y[2]}))), y0);
+	s.ymax = std::min(int(std::ceil(std::max({y[0], y[1], y[2]}))), y1);
+	s.xmin = std::max(int(std::floor(std::min({x[0], x[1], x[2]}))), 0);
+	s.xmax = std::min(int(std::ceil(std::max({x[0], x[1], x[2]}))), width_);
+	if (s.ymin >= s.ymax || s.xmin >= s.xmax) continue;
+
+	// counter clockwise, the occluders are two sided
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+	if (area == 0.0f) continue;
+	if (area < 0.0f) {
+	    std::swap(x[1], x[2]);
+	    std::swap(y[1], y[2]);
+	    std::swap(z[1], z[2]);
+	    area = -area;
+	}
+
+	// edge k is opposite vertex k, and is its barycentric weight times the area
+	s.za = s.zb = s.zc = 0.0f;
+	for (int k = 0; k < 3; k++) {
+	    int i = (k + 1) % 3, j = (k + 2) % 3;
+	    s.a[k] = y[i] - y[j];
+	    s.b[k] = x[j] - x[i];
+	    s.c[k] = -(s.a[k] * x[i] + s.b[k] * y[i]);
+	    s.za += s.a[k] * z[k] / area;
+	    s.zb += s.b[k] * z[k] / area;
+	    s.zc += s.c[k] * z[k] / area;
+	}
+
+	// Conservative, a pixel is only written if the triangle covers all of it, and with
+	// the farthest depth of the triangle over it. Each edge is pulled in by half a pixel
+	// along both axes and the depth plane is pushed back by as much, so the tests at the
+	// pixel centres below hold for the whole pixel.
+	for (int k = 0; k < 3; k++) s.c[k] -= 0.5f * (std::fabs(s.a[k]) + std::fabs(s.b[k]));
+	s.zc += 0.5f * (std::fabs(s.za) + std::fabs(s.zb));
+
+#ifdef SOFTWARE_CULLER_AVX2
+	if (simd_) {
+	    raster_avx2(s, depth, width_);
+	    continue;
+	}
+#endif
+	raster_scalar(s, depth, width_);
+    }
+}
+
+void
+software_culler::build_pyramid()
+{
+    // the farthest depth of each 2x2 block, an odd row or column stands alone
+    for (std::size_t l = 1; l < levels_.size(); l++) {
+	const std::vector<float> &fine = levels_[l - 1];
+	int fw = level_width_[l - 1], fh = level_height_[l - 1];
+	std::vector<float> &coarse = levels_[l];
+	for (int y = 0; y < level_height_[l]; y++) {
+	    const float *a = &fine[std::size_t(2 * y) * fw];
+	    const float *b = &fine[std::size_t(std::min(2 * y + 1, fh - 1)) * fw];
+	    float *out = &coarse[std::size_t(y) * level_width_[l]];
+	    for (int x = 0; x < level_width_[l]; x++) {
+		int xa = 2 * x, xb = std::min(2 * x + 1, fw - 1);
+		out[x] = std::max({a[xa], a[xb], b[xa], b[xb]});
+	    }
+	}
+    }
+}
+
+bool
+software_culler::visible(const aabb &box) const
+{
+    float rect[4], nearest;
+    if (!project_box(matrix_, width_, height_, box, rect, nearest)) return true;
+
+    // the pixels the rectangle touches, none if it is outside the window
+    int x0 = std::max(int(std::floor(rect[0])), 0);
+    int y0 = std::max(int(std::floor(rect[1])), 0);
+    int x1 = std::min(int(std::floor(rect[2])), width_ - 1);
+    int y1 = std::min(int(std::floor(rect[3])), height_ - 1);
+    if (x0 > x1 || y0 > y1) return false;
+
+    // the level where the rectangle is at most two texels across
+    std::size_t l = 0;
+    while (l + 1 < levels_.size() && ((x1 >> l) - (x0 >> l) > 1 || (y1 >> l) - (y0 >> l) > 1))
+	l++;
+
+    return region_visible(l, x0, y0, x1, y1, nearest);
+}
+
+bool
+software_culler::region_visible(std::size_t l, int x0, int y0, int x1, int y1,
+				float nearest) const
+{
+    for (int y = y0 >> l; y <= y1 >> l; y++) {
+	const float *row = &levels_[l][std::size_t(y) * level_width_[l]];
+	for (int x = x0 >> l; x <= x1 >> l; x++) {
+	    // hidden wherever the texel is
+	    if (nearest > row[x] + depth_bias) continue;
+	    if (l == 0) return true;
+
+	    // the texel may hang over the rectangle, its part of it a level finer
+	    int tx0 = std::max(x0, x << l), tx1 = std::min(x1, ((x + 1) << l) - 1);
+	    int ty0 = std::max(y0, y << l), ty1 = std::min(y1, ((y + 1) << l) - 1);
+	    if (region_visible(l - 1, tx0, ty0, tx1, ty1, nearest)) return true;
+	}
+    }
+    return false;
+}
+
+void
+software_culler::cull(std::vector<unsigned> &objects, const std::vector<aabb> &boxes)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t before = objects.size();
+    objects.erase(std::remove_if(objects.begin(), objects.end(),
+				 [&](unsigned i) { return !visible(boxes[i]); }),
+		  objects.end());
+    test_ms_total_ +=
+	std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	    .count();
+    tests_ += before;
+    hidden_ += before - objects.size();
+}
+
+void
+software_culler::run_workers(const std::function<void(int)> &job)
+{
+    if (workers_.empty()) {
+	job(0);
+	return;
+    }
+
+    {
+	std::lock_guard<std::mutex> lock(mutex_);
+	job_ = &job;
+	running_ = int(workers_.size());
+	generation_++;
+    }
+    start_cv_.notify_all();
+
+    // the first band is ours
+    job(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return running_ == 0; });
+    job_ = nullptr;
+}
+
+void
+software_culler::worker_main(int band)
+{
+    unsigned long seen = 0;
+    for (;;) {
+	const std::function<void(int)> *job;
+	{
+	    std::unique_lock<std::mutex> lock(mutex_);
+	    start_cv_.wait(lock, [&] { return quit_ || generation_ != seen; });
+	    if (quit_) return;
+	    seen = generation_;
+	    job = job_;
+	}
+
+	(*job)(band);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (--running_ == 0) done_cv_.notify_one();
+    }
+}
+
+void
+software_culler::report(std::ostream &out) const
+{
+    out << "soft_occlusion_size: " << width_ << "x" << height_ << std::endl;
+    out << "soft_occlusion_bands: " << bands_ << std::endl;
+    out << "soft_occlusion_simd: " << (simd_ ? "avx2" : "scalar") << std::endl;
+    out << "soft_occlusion_frames: " << frames_ << std::endl;
+    if (!frames_) return;
+    out << "soft_occlusion_occluder_triangles_per_frame: " << occluders_total_ / frames_
+	<< std::endl;
+    out << "soft_occlusion_rasterize_ms_mean: " << rasterize_ms_total_ / frames_ << std::endl;
+    out << "soft_occlusion_tests_per_frame: " << double(tests_) / frames_ << std::endl;
+    out << "soft_occlusion_hidden_per_frame: " << double(hidden_) / frames_ << std::endl;
+    if (test_ms_total_ > 0.0)
+	out << "soft_occlusion_tests_per_ms: " << tests_ / test_ms_total_ << std::endl;
+}
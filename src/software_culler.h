@@ -0,0 +1,114 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// software_culler.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Occlusion culling on the cpu, against a small depth buffer of a few large occluders
+
+#ifndef SOFTWARE_CULLER_H
+#define SOFTWARE_CULLER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "bvh.h"
+
+// The occluders are rasterized conservatively into a low resolution depth buffer, a pixel
+// keeps the nearest of the farthest depths of the occluders that cover all of it, in bands of
+// rows, one band per thread, eight pixels at a time with AVX2 where the cpu has it, else one
+// by one. A pyramid of the farthest depth of each 2x2 block is built over it, and an occludee
+// box is hidden if its nearest depth is behind the farthest depth of every pixel its screen
+// rectangle touches. The test starts on the level where the rectangle is at most two texels
+// across and goes down to finer levels only under the texels that do not hide it. No opengl
+// is involved, the results are known in the same frame, without the latency of occlusion
+// queries, and it runs without a gpu.
+//
+// Depth is window depth, 0 near and 1 far, the matrix takes object space to clip space like
+// a vertex shader does. Occluder triangles crossing the near plane are dropped, boxes crossing
+// it are visible, and pixels an occluder covers only in part are left to the others, all of
+// which only ever cost culling, never correctness.
+
+class software_culler {
+   public:
+    // width and height of the depth buffer, width is rounded up to a multiple of 8, threads
+    // 0 for one per core, at most 8
+    explicit software_culler(int width = 256, int height = 128, int threads = 0);
+    ~software_culler();
+
+    software_culler(const software_culler &) = delete;
+    software_culler &operator=(const software_culler &) = delete;
+
+    // start a frame, dropping the occluders of the last one, matrix is column major
+    void begin(const float matrix[16]);
+
+    // area of the screen rectangle of a box, in depth buffer pixels, 0 if it is behind us or
+    // crosses the near plane, for picking occluders
+    float screen_area(const aabb &box) const;
+
+    // occluder triangles, xyz per vertex, three vertices a triangle
+    void add_occluder(const float *positions, std::size_t triangles);
+
+    // rasterize the occluders and build the depth pyramid
+    void rasterize();
+
+    // false if the box is certainly hidden behind the occluders
+    bool visible(const aabb &box) const;
+
+    // keep only the objects that may be visible, boxes indexed by object
+    void cull(std::vector<unsigned> &objects, const std::vector<aabb> &boxes);
+
+    // rasterize with AVX2, if the cpu has it, or one pixel at a time
+    void set_simd(bool simd) { simd_ = simd && has_avx2_; }
+    bool simd() const { return simd_; }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int bands() const { return bands_; }
+
+    // of the last frame
+    std::size_t occluder_triangles() const { return triangles_.size() / 9; }
+    double rasterize_ms() const { return rasterize_ms_; }
+
+    // print the configuration and the costs per frame, one stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    void rasterize_band(int band);
+    void build_pyramid();
+
+    // whether a rectangle of depth buffer pixels, inclusive, shows something at nearest,
+    // from level l down
+    bool region_visible(std::size_t l, int x0, int y0, int x1, int y1, float nearest) const;
+    void run_workers(const std::function<void(int)> &job);
+    void worker_main(int band);
+
+    int width_, height_, bands_;
+    bool has_avx2_, simd_;
+    float matrix_[16] = {};
+
+    // occluder triangles in window coordinates, x, y in pixels and depth, per vertex
+    std::vector<float> triangles_;
+
+    // the depth buffer is level 0, every level half the size of the one before
+    std::vector<std::vector<float>> levels_;
+    std::vector<int> level_width_, level_height_;
+
+    // helper threads, one per band but the first, which is the caller's
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_, done_cv_;
+    const std::function<void(int)> *job_ = nullptr;
+    unsigned long generation_ = 0;
+    int running_ = 0;
+    bool quit_ = false;
+
+    unsigned long frames_ = 0, tests_ = 0, hidden_ = 0;
+    double occluders_total_ = 0.0, rasterize_ms_ = 0.0, rasterize_ms_total_ = 0.0;
+    double test_ms_total_ = 0.0;
+};
+
+#endif	// SOFTWARE_CULLER_H
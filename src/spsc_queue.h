@@ -0,0 +1,73 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// spsc_queue.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Lock free single producer, single consumer ring buffer
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// One thread pushes, one other thread pops, neither ever blocks. The capacity is a power of two
+// so that the indices wrap with a mask. Head and tail live on separate cache lines, otherwise
+// the two threads would keep stealing the line from each other.
+
+template <typename T, std::size_t N>
+class spsc_queue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+   public:
+    // producer side, returns false if the queue is full
+    bool
+    push(const T &item)
+    {
+	std::size_t tail = tail_.load(std::memory_order_relaxed);
+	if (tail - head_cache_ == N) {
+	    // looks full, refresh our view of the consumer
+	    head_cache_ = head_.load(std::memory_order_acquire);
+	    if (tail - head_cache_ == N) return false;
+	}
+	items_[tail & (N - 1)] = item;
+	tail_.store(tail + 1, std::memory_order_release);
+	return true;
+    }
+
+    // consumer side, returns false if the queue is empty
+    bool
+    pop(T &item)
+    {
+	std::size_t head = head_.load(std::memory_order_relaxed);
+	if (head == tail_cache_) {
+	    // looks empty, refresh our view of the producer
+	    tail_cache_ = tail_.load(std::memory_order_acquire);
+	    if (head == tail_cache_) return false;
+	}
+	item = items_[head & (N - 1)];
+	head_.store(head + 1, std::memory_order_release);
+	return true;
+    }
+
+    // either side, only a hint as the other side keeps going
+    bool
+    empty() const
+    {
+	return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+   private:
+    static constexpr std::size_t cache_line = 64;
+
+    // consumer owned, with the consumer's copy of the tail
+    alignas(cache_line) std::atomic<std::size_t> head_{0};
+    std::size_t tail_cache_ = 0;
+
+    // producer owned, with the producer's copy of the head
+    alignas(cache_line) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_ = 0;
+
+    alignas(cache_line) T items_[N];
+};
+
+#endif	// SPSC_QUEUE_H
@@ -0,0 +1,258 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	texture.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	2d textures with mip levels, uploaded at once or streamed through pixel buffer objects
+
+#include "texture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "gpu_memory.h"
+
+bool
+texture::format_supported(GLenum internal_format)
+{
+    switch (internal_format) {
+	case GL_RGBA8:
+	case GL_SRGB8_ALPHA8:
+	    return true;
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+	    return GLEW_EXT_texture_compression_s3tc;
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+	    return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+	    // desktop drivers often decompress these on upload, they save no gpu memory then
+	    return GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+	default:
+	    return false;
+    }
+}
+
+texture::texture(const texture_data &data, const char *tag)
+    : tag_(tag),
+      internal_format_(data.internal_format),
+      compressed_(data.compressed),
+      immutable_(GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+{
+    if (data.levels.empty()) throw std::runtime_error("texture without image data");
+    if (!format_supported(internal_format_))
+	throw std::runtime_error("texture format " + std::to_string(internal_format_) +
+				 " is not supported by this context");
+
+    width_ = data.levels[0].width;
+    height_ = data.levels[0].height;
+
+    // compressed levels cannot be generated, we only have the ones in the file
+    levels_ = compressed_ ? int(data.levels.size()) : mip_count(width_, height_);
+
+    for (int i = 0; i < levels_; i++)
+	bytes_ += level_bytes(internal_format_, std::max(width_ >> i, 1),
+			      std::max(height_ >> i, 1));
+
+    allocate();
+}
+
+void
+texture::allocate()
+{
+    glGenTextures(1, &id_);
+    glBindTexture(GL_TEXTURE_2D, id_);
+
+    if (immutable_) {
+	glTexStorage2D(GL_TEXTURE_2D, levels_, internal_format_, width_, height_);
+    }
+    else {
+	for (int i = 0; i < levels_; i++) {
+	    int w = std::max(width_ >> i, 1), h = std::max(height_ >> i, 1);
+	    if (compressed_)
+		glCompressedTexImage2D(GL_TEXTURE_2D, i, internal_format_, w, h, 0,
+				       GLsizei(level_bytes(internal_format_, w, h)), nullptr);
+	    else
+		glTexImage2D(GL_TEXTURE_2D, i, internal_format_, w, h, 0, GL_RGBA,
+			     GL_UNSIGNED_BYTE, nullptr);
+	}
+    }
+
+    // trilinear filtering, and the level range a mutable texture needs to be complete
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels_ - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    record();
+}
+
+void
+texture::record()
+{
+    // the tracker calls back into us to evict, the texture is neither copied nor moved
+    std::function<void()> evict;
+    if (streamable_) {
+	evict = [this]() {
+	    tracked_delete_textures(1, &id_);
+	    id_ = 0;
+	};
+    }
+    tracked_texture(id_, bytes_, gpu_category::textures, tag_.c_str(), std::move(evict));
+}
+
+texture::~texture()
+{
+    if (id_) tracked_delete_textures(1, &id_);
+}
+
+void
+texture::set_streamable(bool streamable)
+{
+    streamable_ = streamable;
+    if (id_) record();
+}
+
+void
+texture::restore(const texture_data &data)
+{
+    if (id_) return;
+    allocate();
+    upload(data);
+}
+
+void
+texture::mark_used() const
+{
+    gpu_memory::get().used(gpu_object::texture, id_);
+}
+
+void
+texture::upload(const texture_data &data)
+{
+    glBindTexture(GL_TEXTURE_2D, id_);
+
+    int given = std::min(int(data.levels.size()), levels_);
+    for (int i = 0; i < given; i++)
+	upload_level(i, data.levels[i].data.data(), data.levels[i].data.size());
+
+    // the gpu filters the rest of the chain down from the base level, much faster than we can
+    if (given < levels_ && !compressed_) glGenerateMipmap(GL_TEXTURE_2D);
+
+    set_base_level(0);
+}
+
+void
+texture::upload_level(int level, const void *pixels, std::size_t size)
+{
+    int w = std::max(width_ >> level, 1), h = std::max(height_ >> level, 1);
+
+    if (compressed_)
+	glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h, internal_format_,
+				  GLsizei(size), pixels);
+    else
+	glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+void
+texture::set_base_level(int level)
+{
+    glBindTexture(GL_TEXTURE_2D, id_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+}
+
+texture_streamer::texture_streamer(std::size_t bytes_per_frame, int pbo_count)
+    : budget_(bytes_per_frame), pbo_count_(std::min(std::max(pbo_count, 1), max_pbos))
+{
+    glGenBuffers(pbo_count_, pbos_);
+}
+
+texture_streamer::~texture_streamer()
+{
+    tracked_delete_buffers(pbo_count_, pbos_);
+}
+
+void
+texture_streamer::stream(texture &tex, std::shared_ptr<const texture_data> data)
+{
+    int levels = std::min(int(data->levels.size()), tex.levels());
+
+    // nothing to sample until the coarsest level is there
+    tex.set_base_level(levels - 1);
+
+    for (int i = levels - 1; i >= 0; i--) queue_.push_back({&tex, data, i});
+}
+
+bool
+texture_streamer::update()
+{
+    if (queue_.empty()) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    frames_++;
+
+    std::size_t spent = 0;
+    while (!queue_.empty()) {
+	const pending_level &next = queue_.front();
+	const texture_level &level = next.data->levels[next.level];
+	std::size_t size = level.data.size();
+	if (spent && spent + size > budget_) break;
+
+	// orphan the buffer, the driver hands us fresh memory if the gpu still reads the old
+	GLuint pbo = pbos_[next_pbo_];
+	next_pbo_ = (next_pbo_ + 1) % pbo_count_;
+	tracked_buffer_data(GL_PIXEL_UNPACK_BUFFER, pbo, GLsizeiptr(size), nullptr,
+			    GL_STREAM_DRAW, gpu_category::staging, "texture_stream");
+
+	void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(size),
+				     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	const void *pixels = nullptr;
+	if (dst) {
+	    std::memcpy(dst, level.data.data(), size);
+	    // unmapping fails if the buffer got lost, on a mode switch, upload directly then
+	    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) dst = nullptr;
+	}
+	if (!dst) {
+	    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	    pixels = level.data.data();
+	}
+
+	glBindTexture(GL_TEXTURE_2D, next.tex->id());
+	next.tex->upload_level(next.level, pixels, size);
+	next.tex->set_base_level(next.level);
+
+	spent += size;
+	bytes_uploaded_ += size;
+	levels_uploaded_++;
+	queue_.pop_front();
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    submit_ms_ +=
+	std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	    .count();
+    return true;
+}
+
+void
+texture_streamer::report(std::ostream &out) const
+{
+    out << "texture_stream_frames: " << frames_ << std::endl;
+    out << "texture_stream_levels: " << levels_uploaded_ << std::endl;
+    out << "texture_stream_bytes: " << bytes_uploaded_ << std::endl;
+    out << "texture_stream_submit_ms: " << submit_ms_ << std::endl;
+    if (submit_ms_ > 0.0)
+	out << "texture_stream_submit_mb_per_s: "
+	    << bytes_uploaded_ / 1048576.0 / (submit_ms_ * 1e-3) << std::endl;
+}
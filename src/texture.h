@@ -0,0 +1,136 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// texture.h v0.0 (Simple OpenGL Code Snippets)
+//
+// 2d textures with mip levels, uploaded at once or streamed through pixel buffer objects
+
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include "texture_data.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// A mipmapped 2d texture. The storage for all levels is allocated up front, immutable with
+// glTexStorage2D where the context has it (4.2 or ARB_texture_storage), level by level with
+// glTexImage2D otherwise, and the levels are filled in later, all at once with upload(), or a
+// few each frame by a texture_streamer. Its storage is recorded with the gpu memory tracker
+// under its tag, and a streamable texture gives it back when the tracker is over budget, it
+// is not resident then until it is restored.
+
+class texture {
+   public:
+    // storage for the image in data, with a full mip chain if it is uncompressed, and as many
+    // levels as data has otherwise; throws if the context cannot sample the format
+    explicit texture(const texture_data &data, const char *tag = "texture");
+    ~texture();
+
+    texture(const texture &) = delete;
+    texture &operator=(const texture &) = delete;
+
+    GLuint id() const { return id_; }
+    GLenum internal_format() const { return internal_format_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int levels() const { return levels_; }
+    bool immutable() const { return immutable_; }
+
+    // bytes of all levels, what the texture costs in gpu memory, give or take the padding
+    std::size_t bytes() const { return bytes_; }
+
+    // upload all levels of data, the missing ones of an uncompressed image are generated on
+    // the gpu with glGenerateMipmap
+    void upload(const texture_data &data);
+
+    // upload one level, pixels is an offset into the bound GL_PIXEL_UNPACK_BUFFER if there is
+    // one; the texture has to be bound to GL_TEXTURE_2D
+    void upload_level(int level, const void *pixels, std::size_t size);
+
+    // sample only from this level and coarser ones, the finer ones are not there yet
+    void set_base_level(int level);
+
+    // let the tracker evict the storage when it is over budget, the owner has to keep the
+    // image to restore it from
+    void set_streamable(bool streamable);
+    bool resident() const { return id_ != 0; }
+
+    // storage again after an eviction, with all levels of data, a new id
+    void restore(const texture_data &data);
+
+    // drawn with this frame, so not evicted before the next
+    void mark_used() const;
+
+    // true if the context can sample textures of this format
+    static bool format_supported(GLenum internal_format);
+
+   private:
+    void allocate();
+    void record();
+
+    std::string tag_;
+    bool streamable_ = false;
+    GLuint id_ = 0;
+    GLenum internal_format_;
+    bool compressed_;
+    int width_, height_, levels_;
+    bool immutable_;
+    std::size_t bytes_ = 0;
+};
+
+// Streams mip levels into textures, coarsest first, so that a blurry texture shows up at once
+// and sharpens over the next frames. Each level goes through a pixel buffer object: we copy it
+// into a freshly orphaned buffer, so the driver never waits for the gpu to finish with the
+// previous contents, and the glTexSubImage2D from the buffer returns without waiting for the
+// copy to the texture. A frame uploads levels until its byte budget is spent, but at least
+// one, so that a level bigger than the budget does not stall the stream.
+
+class texture_streamer {
+   public:
+    // bytes_per_frame : upload budget of a frame, pbo_count : buffers used in turn
+    explicit texture_streamer(std::size_t bytes_per_frame, int pbo_count = 3);
+    ~texture_streamer();
+
+    texture_streamer(const texture_streamer &) = delete;
+    texture_streamer &operator=(const texture_streamer &) = delete;
+
+    // queue all levels of data for tex, which has to have storage for them and live until the
+    // stream is done, as does data
+    void stream(texture &tex, std::shared_ptr<const texture_data> data);
+
+    // upload the next levels, once a frame, true if a level became visible
+    bool update();
+
+    // levels still waiting to be uploaded
+    bool busy() const { return !queue_.empty(); }
+
+    // bytes uploaded and the cpu time spent submitting them, one stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    struct pending_level {
+	texture *tex;
+	std::shared_ptr<const texture_data> data;
+	int level;
+    };
+
+    static constexpr int max_pbos = 8;
+
+    std::size_t budget_;
+    int pbo_count_;
+    GLuint pbos_[max_pbos] = {};
+    int next_pbo_ = 0;
+
+    std::deque<pending_level> queue_;
+
+    unsigned long frames_ = 0, levels_uploaded_ = 0;
+    std::size_t bytes_uploaded_ = 0;
+    double submit_ms_ = 0.0;
+};
+
+#endif	// TEXTURE_H
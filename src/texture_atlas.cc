@@ -0,0 +1,211 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	texture_atlas.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Many small textures packed into the layers of one 2d array texture
+
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "gpu_memory.h"
+
+skyline_packer::skyline_packer(int width, int height)
+    : width_(width), height_(height), skyline_{{0, 0, width}}
+{
+}
+
+int
+skyline_packer::fit(std::size_t i, int width, int height) const
+{
+    if (skyline_[i].x + width > width_) return -1;
+
+    // the rectangle rests on the highest segment under it
+    int y = 0;
+    for (int left = width; left > 0; left -= skyline_[i++].width) {
+	y = std::max(y, skyline_[i].y);
+	if (y + height > height_) return -1;
+    }
+    return y;
+}
+
+bool
+skyline_packer::insert(int width, int height, int &x, int &y)
+{
+    std::size_t best = skyline_.size();
+    int best_y = INT_MAX;
+    for (std::size_t i = 0; i < skyline_.size(); i++) {
+	int at = fit(i, width, height);
+	if (at >= 0 && at < best_y) {
+	    best = i;
+	    best_y = at;
+	}
+    }
+    if (best == skyline_.size()) return false;
+
+    x = skyline_[best].x;
+    y = best_y;
+    skyline_.insert(skyline_.begin() + best, segment{x, y + height, width});
+
+    // the segments the rectangle now covers get cut back or dropped
+    for (std::size_t i = best + 1; i < skyline_.size();) {
+	int covered = x + width - skyline_[i].x;
+	if (covered <= 0) break;
+	if (covered < skyline_[i].width) {
+	    skyline_[i].x += covered;
+	    skyline_[i].width -= covered;
+	    break;
+	}
+	skyline_.erase(skyline_.begin() + i);
+    }
+
+    // and neighbours at the same height become one segment
+    for (std::size_t i = 0; i + 1 < skyline_.size();) {
+	if (skyline_[i].y == skyline_[i + 1].y) {
+	    skyline_[i].width += skyline_[i + 1].width;
+	    skyline_.erase(skyline_.begin() + i + 1);
+	}
+	else
+	    i++;
+    }
+
+    used_ += std::size_t(width) * height;
+    return true;
+}
+
+texture_atlas::texture_atlas(const std::vector<const texture_data *> &images, int page_size,
+			     int padding)
+    : page_size_(page_size), regions_(images.size())
+{
+    if (images.empty()) throw std::runtime_error("texture atlas without images");
+
+    GLenum internal_format = images[0]->internal_format;
+    for (const texture_data *image : images) {
+	if (image->compressed || image->levels.empty())
+	    throw std::runtime_error("only uncompressed images can be packed into an atlas");
+	if (image->internal_format != internal_format)
+	    throw std::runtime_error("images of an atlas have to have the same format");
+    }
+
+    // level i has padding >> i texels of padding left, and images start and end on multiples
+    // of 2^(levels - 1) texels, so that no texel of a coarser level mixes two images
+    padding = std::max(padding, 0);
+    for (int p = padding; p > 1; p /= 2) levels_++;
+    levels_ = std::min(levels_, mip_count(page_size, page_size));
+    int align = 1 << (levels_ - 1);
+
+    // tallest first keeps the skyline flat
+    std::vector<std::size_t> order(images.size());
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+	return images[a]->levels[0].height > images[b]->levels[0].height;
+    });
+
+    struct placement {
+	int x, y, width, height;
+    };
+    std::vector<placement> placed(images.size());
+    std::vector<skyline_packer> packers;
+
+    for (std::size_t i : order) {
+	const texture_level &level = images[i]->levels[0];
+	int w = (level.width + 2 * padding + align - 1) / align * align;
+	int h = (level.height + 2 * padding + align - 1) / align * align;
+	if (w > page_size || h > page_size)
+	    throw std::runtime_error("image " + std::to_string(i) + " does not fit on a " +
+				     std::to_string(page_size) + " texel atlas page");
+
+	// the earlier pages may still have room for a small image
+	int x = 0, y = 0;
+	std::size_t page = 0;
+	while (page < packers.size() && !packers[page].insert(w, h, x, y)) page++;
+	if (page == packers.size()) {
+	    packers.emplace_back(page_size, page_size);
+	    packers.back().insert(w, h, x, y);
+	}
+
+	placed[i] = {x, y, w, h};
+	regions_[i] = {int(page), float(x + padding) / page_size,
+		       float(y + padding) / page_size,
+		       float(x + padding + level.width) / page_size,
+		       float(y + padding + level.height) / page_size};
+	image_area_ += std::size_t(level.width) * level.height;
+    }
+    pages_ = int(packers.size());
+
+    // copy the images onto their pages, the padding repeats the nearest edge texel
+    std::size_t page_bytes = level_bytes(internal_format, page_size, page_size);
+    std::vector<unsigned char> pixels(page_bytes * pages_, 0);
+    for (std::size_t i = 0; i < images.size(); i++) {
+	const texture_level &level = images[i]->levels[0];
+	const placement &p = placed[i];
+	unsigned char *page = &pixels[page_bytes * regions_[i].layer];
+	for (int y = 0; y < p.height; y++) {
+	    int from_y = std::min(std::max(y - padding, 0), level.height - 1);
+	    for (int x = 0; x < p.width; x++) {
+		int from_x = std::min(std::max(x - padding, 0), level.width - 1);
+		std::copy_n(&level.data[(std::size_t(from_y) * level.width + from_x) * 4], 4,
+			    &page[(std::size_t(p.y + y) * page_size + p.x + x) * 4]);
+	    }
+	}
+    }
+
+    glGenTextures(1, &id_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, id_);
+
+    if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage) {
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels_, internal_format, page_size, page_size,
+		       pages_);
+    }
+    else {
+	for (int i = 0; i < levels_; i++) {
+	    int size = std::max(page_size >> i, 1);
+	    glTexImage3D(GL_TEXTURE_2D_ARRAY, i, internal_format, size, size, pages_, 0,
+			 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+    }
+
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, page_size, page_size, pages_, GL_RGBA,
+		    GL_UNSIGNED_BYTE, pixels.data());
+    if (levels_ > 1) glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    for (int i = 0; i < levels_; i++) {
+	int size = std::max(page_size >> i, 1);
+	bytes_ += level_bytes(internal_format, size, size) * pages_;
+    }
+    tracked_texture(id_, bytes_, gpu_category::textures, "atlas");
+
+    // an image cannot repeat inside an atlas, the geometry has to stay within 0 to 1
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels_ - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+texture_atlas::~texture_atlas()
+{
+    tracked_delete_textures(1, &id_);
+}
+
+double
+texture_atlas::efficiency() const
+{
+    return double(image_area_) / (double(page_size_) * page_size_ * pages_);
+}
+
+void
+texture_atlas::report(std::ostream &out) const
+{
+    out << "atlas_images: " << regions_.size() << std::endl;
+    out << "atlas_pages: " << pages_ << std::endl;
+    out << "atlas_page_size: " << page_size_ << std::endl;
+    out << "atlas_levels: " << levels_ << std::endl;
+    out << "atlas_efficiency: " << efficiency() << std::endl;
+    out << "atlas_bytes: " << bytes_ << std::endl;
+}
@@ -0,0 +1,97 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// texture_atlas.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Many small textures packed into the layers of one 2d array texture
+
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include "texture_data.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// Skyline bottom-left packing: the packer remembers the top edge of what it has placed so far
+// as a list of horizontal segments, and puts each new rectangle where its bottom edge ends up
+// lowest, the leftmost such place on a tie. It wastes a little more than maxrects, but is much
+// faster and needs memory only for the skyline.
+
+class skyline_packer {
+   public:
+    skyline_packer(int width, int height);
+
+    // place a width x height rectangle, false if it does not fit anymore
+    bool insert(int width, int height, int &x, int &y);
+
+    // area of the rectangles placed so far
+    std::size_t used_area() const { return used_; }
+
+   private:
+    struct segment {
+	int x, y, width;
+    };
+
+    // y where a rectangle of this width would rest if its left edge was at segment i, -1 if
+    // it runs off the right edge or sticks out at the top
+    int fit(std::size_t i, int width, int height) const;
+
+    int width_, height_;
+    std::vector<segment> skyline_;
+    std::size_t used_ = 0;
+};
+
+// where an image ended up, in texture coordinates of its layer
+struct atlas_region {
+    int layer;
+    float u0, v0, u1, v1;
+
+    // texture coordinates of the image, 0 to 1 across it, to those of the atlas
+    float u(float s) const { return u0 + s * (u1 - u0); }
+    float v(float t) const { return v0 + t * (v1 - v0); }
+};
+
+// The images are packed, tallest first, into pages of page_size x page_size texels, a new page
+// once one is full, and the pages become the layers of a GL_TEXTURE_2D_ARRAY, so that a single
+// binding covers all of them. Every image is surrounded by padding texels that repeat its edge,
+// and the mip chain stops where a level has less than one texel of padding left, so that
+// filtering never pulls in a neighbour. Only uncompressed images can be packed.
+
+class texture_atlas {
+   public:
+    // throws if an image is compressed or does not fit on a page
+    texture_atlas(const std::vector<const texture_data *> &images, int page_size = 1024,
+		  int padding = 4);
+    ~texture_atlas();
+
+    texture_atlas(const texture_atlas &) = delete;
+    texture_atlas &operator=(const texture_atlas &) = delete;
+
+    GLuint id() const { return id_; }
+    int pages() const { return pages_; }
+    int levels() const { return levels_; }
+    std::size_t images() const { return regions_.size(); }
+
+    // region of the i-th image, in the order they were given
+    const atlas_region &region(std::size_t i) const { return regions_[i]; }
+
+    // area of the images over the area of the pages, padding counts as waste
+    double efficiency() const;
+
+    // gpu memory of all layers and levels
+    std::size_t bytes() const { return bytes_; }
+
+    // pages, efficiency and memory, one stat per line
+    void report(std::ostream &out) const;
+
+   private:
+    GLuint id_ = 0;
+    int page_size_, pages_ = 0, levels_ = 1;
+    std::vector<atlas_region> regions_;
+    std::size_t image_area_ = 0, bytes_ = 0;
+};
+
+#endif	// TEXTURE_ATLAS_H
@@ -0,0 +1,306 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	texture_data.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Texture images in memory, loaded from PPM/PGM and KTX2 files or generated
+
+#include "texture_data.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+std::size_t
+texture_data::bytes() const
+{
+    std::size_t total = 0;
+    for (const texture_level &level : levels) total += level.data.size();
+    return total;
+}
+
+int
+mip_count(int width, int height)
+{
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2) levels++;
+    return levels;
+}
+
+bool
+is_compressed_format(GLenum internal_format)
+{
+    switch (internal_format) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+	    return true;
+	default:
+	    return false;
+    }
+}
+
+std::size_t
+level_bytes(GLenum internal_format, int width, int height)
+{
+    if (!is_compressed_format(internal_format)) return std::size_t(width) * height * 4;
+
+    // 4x4 blocks, half a byte per texel for the rgb formats, a byte for the rgba ones
+    std::size_t blocks = std::size_t((width + 3) / 4) * ((height + 3) / 4);
+    switch (internal_format) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+	    return blocks * 8;
+	default:
+	    return blocks * 16;
+    }
+}
+
+// whole file, throws if it cannot be read
+static std::vector<unsigned char>
+read_file(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot read texture file : " + path);
+    return std::vector<unsigned char>((std::istreambuf_iterator<char>(in)),
+				      std::istreambuf_iterator<char>());
+}
+
+texture_data
+load_ppm(const std::string &path)
+{
+    std::vector<unsigned char> file = read_file(path);
+    std::size_t pos = 0;
+
+    // the header is four whitespace separated tokens, with # comments between them
+    auto token = [&]() {
+	std::string text;
+	while (pos < file.size()) {
+	    unsigned char c = file[pos];
+	    if (c == '#') {
+		while (pos < file.size() && file[pos] != '\n') pos++;
+	    }
+	    else if (std::isspace(c)) {
+		pos++;
+		if (!text.empty()) break;
+	    }
+	    else {
+		text += char(c);
+		pos++;
+	    }
+	}
+	return text;
+    };
+
+    std::string magic = token();
+    if (magic != "P6" && magic != "P5")
+	throw std::runtime_error("not a binary PPM or PGM file : " + path);
+    int channels = magic == "P6" ? 3 : 1;
+
+    int width = std::atoi(token().c_str());
+    int height = std::atoi(token().c_str());
+    int max_value = std::atoi(token().c_str());
+    if (width <= 0 || height <= 0 || max_value != 255)
+	throw std::runtime_error("unsupported PPM header, only 8 bit channels : " + path);
+
+    // exactly one whitespace character follows the maximum value, token() has eaten it
+    std::size_t texels = std::size_t(width) * height;
+    if (file.size() - pos < texels * channels)
+	throw std::runtime_error("truncated PPM file : " + path);
+
+    texture_data data;
+    data.levels.resize(1);
+    texture_level &level = data.levels[0];
+    level.width = width;
+    level.height = height;
+    level.data.resize(texels * 4);
+
+    const unsigned char *src = file.data() + pos;
+    for (std::size_t i = 0; i < texels; i++, src += channels) {
+	level.data[4 * i + 0] = src[0];
+	level.data[4 * i + 1] = src[channels == 3 ? 1 : 0];
+	level.data[4 * i + 2] = src[channels == 3 ? 2 : 0];
+	level.data[4 * i + 3] = 255;
+    }
+    return data;
+}
+
+// KTX2 file layout, all little endian
+static const unsigned char ktx2_identifier[12] = {0xab, 'K', 'T', 'X', ' ', '2',
+						  '0',	0xbb, '\r', '\n', 0x1a, '\n'};
+static constexpr std::size_t ktx2_header_size = 80;
+static constexpr std::size_t ktx2_level_entry_size = 24;
+
+// the opengl format of a vulkan format, 0 for the ones we do not load
+static GLenum
+gl_format_of_vk_format(uint32_t vk_format)
+{
+    switch (vk_format) {
+	case 37: return GL_RGBA8;				// R8G8B8A8_UNORM
+	case 43: return GL_SRGB8_ALPHA8;			// R8G8B8A8_SRGB
+	case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;	// BC1_RGB_UNORM
+	case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;	// BC1_RGB_SRGB
+	case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;	// BC1_RGBA_UNORM
+	case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;  // BC1_RGBA_SRGB
+	case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;	// BC3_UNORM
+	case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;  // BC3_SRGB
+	case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM;		// BC7_UNORM
+	case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;	// BC7_SRGB
+	case 147: return GL_COMPRESSED_RGB8_ETC2;		// ETC2_R8G8B8_UNORM
+	case 148: return GL_COMPRESSED_SRGB8_ETC2;		// ETC2_R8G8B8_SRGB
+	case 151: return GL_COMPRESSED_RGBA8_ETC2_EAC;		// ETC2_R8G8B8A8_UNORM
+	case 152: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;	// ETC2_R8G8B8A8_SRGB
+	default: return 0;
+    }
+}
+
+texture_data
+load_ktx2(const std::string &path)
+{
+    std::vector<unsigned char> file = read_file(path);
+
+    if (file.size() < ktx2_header_size ||
+	std::memcmp(file.data(), ktx2_identifier, sizeof(ktx2_identifier)) != 0)
+	throw std::runtime_error("not a KTX2 file : " + path);
+
+    auto u32 = [&file](std::size_t offset) {
+	uint32_t value;
+	std::memcpy(&value, file.data() + offset, sizeof(value));
+	return value;
+    };
+    auto u64 = [&file](std::size_t offset) {
+	uint64_t value;
+	std::memcpy(&value, file.data() + offset, sizeof(value));
+	return value;
+    };
+
+    uint32_t vk_format = u32(12);
+    uint32_t width = u32(20), height = u32(24), depth = u32(28);
+    uint32_t layers = u32(32), faces = u32(36), level_count = u32(40);
+    uint32_t supercompression = u32(44);
+
+    GLenum internal_format = gl_format_of_vk_format(vk_format);
+    if (!internal_format)
+	throw std::runtime_error("unsupported KTX2 format " + std::to_string(vk_format) +
+				 " : " + path);
+    if (depth > 1 || layers > 1 || faces != 1 || width == 0 || height == 0 ||
+	width > 65536 || height > 65536)
+	throw std::runtime_error("only single 2d KTX2 textures are supported : " + path);
+    if (supercompression != 0)
+	throw std::runtime_error("supercompressed KTX2 files are not supported : " + path);
+
+    // a level count of 0 asks the loader to generate the mip levels
+    level_count = std::max(level_count, 1u);
+    if (level_count > uint32_t(mip_count(int(width), int(height))))
+	throw std::runtime_error("more KTX2 levels than the size allows : " + path);
+    if (file.size() < ktx2_header_size + level_count * ktx2_level_entry_size)
+	throw std::runtime_error("truncated KTX2 level index : " + path);
+
+    texture_data data;
+    data.internal_format = internal_format;
+    data.compressed = is_compressed_format(internal_format);
+    data.levels.resize(level_count);
+
+    for (uint32_t i = 0; i < level_count; i++) {
+	std::size_t entry = ktx2_header_size + i * ktx2_level_entry_size;
+	uint64_t offset = u64(entry), length = u64(entry + 8);
+
+	texture_level &level = data.levels[i];
+	level.width = std::max(int(width >> i), 1);
+	level.height = std::max(int(height >> i), 1);
+
+	if (length != level_bytes(internal_format, level.width, level.height) ||
+	    offset > file.size() || length > file.size() - offset)
+	    throw std::runtime_error("bad KTX2 level " + std::to_string(i) + " : " + path);
+
+	level.data.assign(file.begin() + offset, file.begin() + offset + length);
+    }
+    return data;
+}
+
+texture_data
+load_texture_file(const std::string &path)
+{
+    auto ends_with = [&path](const char *suffix) {
+	std::size_t n = std::strlen(suffix);
+	return path.size() >= n && path.compare(path.size() - n, n, suffix) == 0;
+    };
+
+    if (ends_with(".ktx2")) return load_ktx2(path);
+    if (ends_with(".ppm") || ends_with(".pgm")) return load_ppm(path);
+    throw std::runtime_error("unknown texture file type, expected .ktx2, .ppm or .pgm : " +
+			     path);
+}
+
+texture_data
+checker_texture(int size, int squares)
+{
+    texture_data data;
+    data.levels.resize(1);
+    texture_level &level = data.levels[0];
+    level.width = level.height = size;
+    level.data.resize(std::size_t(size) * size * 4);
+
+    int square = std::max(size / std::max(squares, 1), 1);
+    for (int y = 0; y < size; y++) {
+	for (int x = 0; x < size; x++) {
+	    unsigned char value = ((x / square + y / square) & 1) ? 255 : 96;
+	    unsigned char *texel = &level.data[(std::size_t(y) * size + x) * 4];
+	    texel[0] = texel[1] = texel[2] = value;
+	    texel[3] = 255;
+	}
+    }
+    return data;
+}
+
+void
+build_mip_chain(texture_data &data)
+{
+    if (data.compressed || data.levels.empty()) return;
+
+    int count = mip_count(data.levels[0].width, data.levels[0].height);
+    data.levels.reserve(count);
+
+    while (int(data.levels.size()) < count) {
+	const texture_level &src = data.levels.back();
+	texture_level dst;
+	dst.width = std::max(src.width / 2, 1);
+	dst.height = std::max(src.height / 2, 1);
+	dst.data.resize(std::size_t(dst.width) * dst.height * 4);
+
+	// average the 2x2 texels under each new texel, clamped at odd edges
+	for (int y = 0; y < dst.height; y++) {
+	    int y0 = std::min(2 * y, src.height - 1);
+	    int y1 = std::min(2 * y + 1, src.height - 1);
+	    for (int x = 0; x < dst.width; x++) {
+		int x0 = std::min(2 * x, src.width - 1);
+		int x1 = std::min(2 * x + 1, src.width - 1);
+		for (int c = 0; c < 4; c++) {
+		    unsigned sum = src.data[(std::size_t(y0) * src.width + x0) * 4 + c] +
+				   src.data[(std::size_t(y0) * src.width + x1) * 4 + c] +
+				   src.data[(std::size_t(y1) * src.width + x0) * 4 + c] +
+				   src.data[(std::size_t(y1) * src.width + x1) * 4 + c];
+		    dst.data[(std::size_t(y) * dst.width + x) * 4 + c] = (sum + 2) / 4;
+		}
+	    }
+	}
+	data.levels.push_back(std::move(dst));
+    }
+}
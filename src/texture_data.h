@@ -0,0 +1,62 @@
+// Sarvottamananda (shreesh)
+// 2026-10-18
+// texture_data.h v0.0 (Simple OpenGL Code Snippets)
+//
+// Texture images in memory, loaded from PPM/PGM and KTX2 files or generated
+
+#ifndef TEXTURE_DATA_H
+#define TEXTURE_DATA_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// One mip level, tightly packed rows. The rows are top row first, as the files have them, and
+// not flipped for opengl, which has the bottom row first, so texture coordinates have t going
+// down the image.
+struct texture_level {
+    int width = 0, height = 0;
+    std::vector<unsigned char> data;
+};
+
+// An image and as many of its mip levels as we have, finest first. Uncompressed images are
+// always 8 bit RGBA, GL_RGBA8 or GL_SRGB8_ALPHA8, compressed ones come in blocks of 4x4 texels
+// in whatever format the file was saved in.
+struct texture_data {
+    GLenum internal_format = GL_RGBA8;
+    bool compressed = false;
+    std::vector<texture_level> levels;
+
+    // bytes of all levels
+    std::size_t bytes() const;
+};
+
+// binary PPM (P6) or PGM (P5) with 8 bit channels, throws if the file cannot be read
+extern texture_data load_ppm(const std::string &path);
+
+// KTX2 with an uncompressed RGBA8 or a BC1/BC3/BC7/ETC2 format and no supercompression, one
+// face and one layer, throws otherwise
+extern texture_data load_ktx2(const std::string &path);
+
+// by the file extension, .ktx2 or .ppm/.pgm
+extern texture_data load_texture_file(const std::string &path);
+
+// a size x size checkerboard with squares x squares squares, for when there is no file
+extern texture_data checker_texture(int size, int squares);
+
+// fill in the missing mip levels of an uncompressed image with a 2x2 box filter, on the cpu,
+// for when the levels have to exist before they are uploaded, e.g. when streaming
+extern void build_mip_chain(texture_data &data);
+
+// number of levels of a full mip chain
+extern int mip_count(int width, int height);
+
+// bytes of one level in the internal format
+extern std::size_t level_bytes(GLenum internal_format, int width, int height);
+
+// true for the block compressed formats that load_ktx2() produces
+extern bool is_compressed_format(GLenum internal_format);
+
+#endif	// TEXTURE_DATA_H
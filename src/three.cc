@@ -248,7 +248,7 @@ main(int argc, char *argv[])
 
 	    // get link log
 	    char *info_log = new char[log_sz + 1];
-	    glGetShaderInfoLog(shader_program, log_sz, &log_sz, info_log);
+	    glGetProgramInfoLog(shader_program, log_sz, &log_sz, info_log);
 	    std::cerr << "shader compiler :\n" << info_log << std::endl;
 
 	    // throw error
@@ -0,0 +1,70 @@
+#!/bin/sh
+#
+# Sarvottamananda (shreesh)
+# 2026-10-18
+# compare_builds.sh v0.0 (Simple OpenGL Code Snippets)
+#
+# Build the snippets in every optimization configuration, run the headless benchmark of final
+# with each of them, and print a markdown table comparing the frame cpu times.
+#
+# usage: tools/compare_builds.sh [frames] [arch]
+#
+# FINAL_ARGS are the options of final for the scene, the same for the pgo training run and the
+# measured runs, by default the grid with its culling, atlas and particles.
+#
+# Needs a display for the hidden window, run it under xvfb-run on headless machines.
+
+set -e
+
+frames=${1:-2000}
+arch=${2:-native}
+default_args="--objects 2500 --layers 8 --atlas --occlusion --soft-occlusion --particles 100000"
+args=${FINAL_ARGS:-$default_args}
+src=$(cd "$(dirname "$0")/.." && pwd)
+out=${BUILD_ROOT:-$src/_compare_builds}
+
+configure_and_build() {
+    dir=$out/$1
+    shift
+    cmake -S "$src" -B "$dir" "$@" > /dev/null
+    cmake --build "$dir" --target final -j"$(nproc)" > /dev/null
+}
+
+benchmark() {
+    "$out/$1/final" --benchmark "$frames" $args |
+	awk -v name="$1" '
+	    /^frame_cpu_ms_mean:/ { mean = $2 }
+	    /^frame_cpu_ms_min:/  { min = $2 }
+	    /^frame_cpu_ms_max:/  { max = $2 }
+	    /^frame_interval_ms_mean:/ { interval = $2 }
+	    END { printf "| %s | %.4f | %.4f | %.4f | %.4f |\n", name, mean, min, max, interval }'
+}
+
+# plain configurations
+configure_and_build debug -DCMAKE_BUILD_TYPE=Debug -DENABLE_IPO=OFF
+configure_and_build release -DCMAKE_BUILD_TYPE=Release -DENABLE_IPO=OFF
+configure_and_build release-ipo -DCMAKE_BUILD_TYPE=Release -DENABLE_IPO=ON
+configure_and_build release-ipo-march -DCMAKE_BUILD_TYPE=Release -DENABLE_IPO=ON \
+    -DTARGET_ARCH="$arch"
+configure_and_build release-ipo-unity -DCMAKE_BUILD_TYPE=Release -DENABLE_IPO=ON \
+    -DENABLE_UNITY_BUILD=ON
+
+# two phase pgo, the training run is the same benchmark we measure with
+configure_and_build release-ipo-pgo -DCMAKE_BUILD_TYPE=Release -DENABLE_IPO=ON \
+    -DPGO_MODE=GENERATE -DPGO_TRAIN_FRAMES="$frames" \
+    -DPGO_TRAIN_ARGS="$(echo $args | tr ' ' ';')"
+cmake --build "$out/release-ipo-pgo" --target pgo-train > /dev/null
+if ls "$out"/release-ipo-pgo/pgo-profile/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -o "$out/release-ipo-pgo/pgo-profile/merged.profdata" \
+	"$out"/release-ipo-pgo/pgo-profile/*.profraw
+fi
+configure_and_build release-ipo-pgo -DPGO_MODE=USE
+
+echo "frame cpu time over $frames frames of final $args, $(uname -m)," \
+    "$(${CXX:-c++} --version | head -n 1)"
+echo
+echo "| configuration | mean (ms) | min (ms) | max (ms) | interval mean (ms) |"
+echo "|---|---|---|---|---|"
+for config in debug release release-ipo release-ipo-march release-ipo-unity release-ipo-pgo; do
+    benchmark $config
+done
@@ -0,0 +1,230 @@
+//	Sarvottamananda (shreesh)
+//	2026-10-18
+//	embed_shaders.cc v0.0 (Simple OpenGL Code Snippets)
+//
+//	Build step : minify glsl files and write them into a header as a constexpr string table
+//
+//	usage: embed_shaders <output.h> <shader files...>
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// characters of identifiers and numbers, two of them next to each other need a space between
+static bool
+is_word(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// characters of operators, two of them may form a different operator if joined, e.g. - -
+static bool
+is_operator(char c)
+{
+    return std::string("+-*/%<>=!&|^.").find(c) != std::string::npos;
+}
+
+/*
+ * strip_comments() : remove // and / * * / comments, a block comment becomes a space, or the
+ * newlines it spanned, so that preprocessor lines stay on lines of their own
+ *
+ * src : glsl source
+ */
+
+static std::string
+strip_comments(const std::string &src)
+{
+    std::string out;
+    std::size_t i = 0;
+
+    while (i < src.size()) {
+	if (src.compare(i, 2, "//") == 0) {
+	    while (i < src.size() && src[i] != '\n') i++;
+	}
+	else if (src.compare(i, 2, "/*") == 0) {
+	    std::size_t end = src.find("*/", i + 2);
+	    end = end == std::string::npos ? src.size() : end + 2;
+	    bool newline = false;
+	    for (; i < end; i++) newline = newline || src[i] == '\n';
+	    out += newline ? '\n' : ' ';
+	}
+	else {
+	    out += src[i++];
+	}
+    }
+    return out;
+}
+
+/*
+ * squeeze() : collapse the whitespace of a line, dropping it entirely where no token can be
+ * joined by doing so
+ *
+ * line : one line of glsl, without comments
+ */
+
+static std::string
+squeeze(const std::string &line)
+{
+    std::string out;
+    bool space = false;
+
+    for (char c : line) {
+	if (std::isspace(static_cast<unsigned char>(c))) {
+	    space = !out.empty();
+	    continue;
+	}
+	if (space) {
+	    char prev = out.back();
+	    if ((is_word(prev) && is_word(c)) || (is_operator(prev) && is_operator(c)))
+		out += ' ';
+	    space = false;
+	}
+	out += c;
+    }
+    return out;
+}
+
+/*
+ * minify() : the smallest text that compiles the same, preprocessor directives keep lines of
+ * their own, with their continuation lines joined on, everything else is joined
+ *
+ * src : glsl source
+ */
+
+static std::string
+minify(const std::string &src)
+{
+    std::istringstream lines(strip_comments(src));
+    std::string line, out;
+    bool in_code = false, in_directive = false;
+
+    while (std::getline(lines, line)) {
+	std::string text = squeeze(line);
+	if (text.empty()) {
+	    // an empty line ends a continued directive
+	    if (in_directive) out += '\n';
+	    in_directive = false;
+	    continue;
+	}
+
+	if (in_directive || text[0] == '#') {
+	    // a directive ends at its newline, and has to start on a line of its own
+	    if (in_code) out += '\n';
+	    // a backslash continues the directive on the next line, which is joined on
+	    in_directive = text.back() == '\\';
+	    if (in_directive) {
+		text.pop_back();
+		out += squeeze(text) + ' ';
+	    }
+	    else {
+		out += text + '\n';
+	    }
+	    in_code = false;
+	}
+	else {
+	    // words on consecutive lines still need a space between them
+	    if (in_code && is_word(out.back()) && is_word(text[0])) out += ' ';
+	    out += text;
+	    in_code = true;
+	}
+    }
+    if (in_code) out += '\n';
+    return out;
+}
+
+// the text as a c++ string literal
+static std::string
+quote(const std::string &text)
+{
+    std::string out = "\"";
+    for (std::size_t i = 0; i < text.size(); i++) {
+	char c = text[i];
+	switch (c) {
+	    // one line of glsl per line of c++
+	    case '\n': out += i + 1 < text.size() ? "\\n\"\n\t\"" : "\\n"; break;
+	    case '"': out += "\\\""; break;
+	    case '\\': out += "\\\\"; break;
+	    default: out += c; break;
+	}
+    }
+    return out + "\"";
+}
+
+// file name without the directory
+static std::string
+base_name(const std::string &path)
+{
+    std::string::size_type slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+int
+main(int argc, char *argv[])
+{
+    if (argc < 2) {
+	std::cerr << "usage: embed_shaders <output.h> <shader files...>" << std::endl;
+	return 1;
+    }
+
+    std::ostringstream table;
+    std::size_t original = 0, minified = 0;
+
+    for (int i = 2; i < argc; i++) {
+	std::ifstream in(argv[i]);
+	if (!in) {
+	    std::cerr << "embed_shaders: cannot read " << argv[i] << std::endl;
+	    return 1;
+	}
+	std::ostringstream src;
+	src << in.rdbuf();
+
+	std::string text = minify(src.str());
+	original += src.str().size();
+	minified += text.size();
+
+	table << "    {\"" << base_name(argv[i]) << "\",\n\t" << quote(text) << "},\n";
+    }
+
+    std::ostringstream header;
+    header << "// generated by embed_shaders, do not edit\n"
+	      "//\n"
+	      "// minified glsl sources, "
+	   << original << " bytes minified to " << minified
+	   << "\n"
+	      "\n"
+	      "#ifndef EMBEDDED_SHADERS_H\n"
+	      "#define EMBEDDED_SHADERS_H\n"
+	      "\n"
+	      "struct embedded_shader {\n"
+	      "    const char *name;\n"
+	      "    const char *source;\n"
+	      "};\n"
+	      "\n"
+	      "constexpr embedded_shader embedded_shaders[] = {\n"
+	   << table.str()
+	   << "    {nullptr, nullptr}};\n"
+	      "\n"
+	      "// source of the shader file with this name, nullptr if it was not embedded\n"
+	      "constexpr const char *\n"
+	      "find_embedded_shader(const char *name)\n"
+	      "{\n"
+	      "    for (const embedded_shader *s = embedded_shaders; s->name; s++) {\n"
+	      "\tconst char *a = s->name, *b = name;\n"
+	      "\twhile (*a && *a == *b) a++, b++;\n"
+	      "\tif (*a == *b) return s->source;\n"
+	      "    }\n"
+	      "    return nullptr;\n"
+	      "}\n"
+	      "\n"
+	      "#endif\t// EMBEDDED_SHADERS_H\n";
+
+    std::ofstream out(argv[1]);
+    out << header.str();
+    if (!out) {
+	std::cerr << "embed_shaders: cannot write " << argv[1] << std::endl;
+	return 1;
+    }
+    return 0;
+}